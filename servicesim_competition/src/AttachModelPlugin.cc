@@ -23,6 +23,7 @@
 #include <gazebo/physics/Link.hh>
 #include <gazebo/physics/Model.hh>
 #include <gazebo/physics/World.hh>
+#include "LoadProfiler.hh"
 #include "AttachModelPlugin.hh"
 
 
@@ -58,6 +59,8 @@ AttachModelPlugin::AttachModelPlugin()
 /////////////////////////////////////////////////
 void AttachModelPlugin::Load(gazebo::physics::ModelPtr _model, sdf::ElementPtr _sdf)
 {
+  LoadTimer timer("AttachModelPlugin::Load", "plugin", _model->GetName());
+
   this->dataPtr->model = _model;
   this->dataPtr->world = _model->GetWorld();
 
@@ -18,8 +18,6 @@
 #include <ros/ros.h>
 #include <sdf/sdf.hh>
 #include <gazebo/common/Console.hh>
-#include <gazebo/physics/PhysicsIface.hh>
-#include <gazebo/physics/World.hh>
 
 #include "CP_DropOff.hh"
 
@@ -27,7 +25,7 @@ using namespace servicesim;
 
 /////////////////////////////////////////////////
 CP_DropOff::CP_DropOff(const sdf::ElementPtr &_sdf)
-    : Checkpoint(_sdf)
+    : ContainCheckpoint(_sdf)
 {
   this->canPause = true;
 
@@ -66,12 +64,6 @@ CP_DropOff::CP_DropOff(const sdf::ElementPtr &_sdf)
   else
     this->guestName = _sdf->Get<std::string>("guest_name");
 
-  // From ContainCheckpoint
-  if (!_sdf->HasElement("namespace"))
-    gzwarn << "Missing <namespace> for contain plugin" << std::endl;
-  else
-    this->ns = _sdf->Get<std::string>("namespace");
-
   // ROS transport
   if (!ros::isInitialized())
   {
@@ -87,14 +79,6 @@ CP_DropOff::CP_DropOff(const sdf::ElementPtr &_sdf)
       "/servicesim/dropoff_guest", &CP_DropOff::OnDropOffRosRequest, this);
 }
 
-/////////////////////////////////////////////////
-void CP_DropOff::EnableCallback(const ignition::msgs::Boolean &/*_rep*/,
-    const bool _result)
-{
-  if (_result)
-    this->enabled = !this->enabled;
-}
-
 /////////////////////////////////////////////////
 void CP_DropOff::OnDrift(const ignition::msgs::UInt32 &_msg)
 {
@@ -133,37 +117,22 @@ void CP_DropOff::OnDrift(const ignition::msgs::UInt32 &_msg)
 /////////////////////////////////////////////////
 bool CP_DropOff::Check()
 {
-  // Enable contain checkpoint once
-  if (!this->enabled && !this->Done())
+  // Subscribe once
+  if (!this->subscribed && !this->Done())
   {
-    // Setup contain subscriber
-    this->ignNode.Subscribe(this->ns + "/contain",
-        &CP_DropOff::OnContain, this);
-
     // Setup drift subscriber
     this->ignNode.Subscribe("/servicesim/" + this->guestName + "/drift",
         &CP_DropOff::OnDrift, this);
-
-    // Enable contain plugin
-    ignition::msgs::Boolean req;
-    req.set_data(true);
-    this->ignNode.Request(this->ns + "/enable", req,
-        &CP_DropOff::EnableCallback, this);
+    this->subscribed = true;
   }
 
   // Done, now clean up
-  if (this->enabled && this->Done() &&
-      !this->ignNode.SubscribedTopics().empty())
+  if (this->subscribed && this->Done())
   {
     // Unsubscribe
     for (auto const &sub : this->ignNode.SubscribedTopics())
       this->ignNode.Unsubscribe(sub);
-
-    // Disable contain plugin
-    ignition::msgs::Boolean req;
-    req.set_data(false);
-    this->ignNode.Request(this->ns + "/enable", req,
-        &CP_DropOff::EnableCallback, this);
+    this->subscribed = false;
   }
 
   return this->Done();
@@ -218,8 +187,8 @@ bool CP_DropOff::OnDropOffRosRequest(
 }
 
 //////////////////////////////////////////////////
-void CP_DropOff::OnContain(const ignition::msgs::Boolean &_msg)
+void CP_DropOff::OnContain(const bool _contain)
 {
-  this->containGuest = _msg.data();
+  this->containGuest = _contain;
 }
 
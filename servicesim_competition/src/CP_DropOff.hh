@@ -29,7 +29,7 @@ namespace servicesim
   class CP_DropOffPrivate;
 
   /// \brief Checkpoint: Drop-off guest
-  class CP_DropOff : public Checkpoint
+  class CP_DropOff : public ContainCheckpoint
   {
     /// \brief Constructor
     /// \param[in] _sdf SDF element for this checkpoint.
@@ -45,23 +45,15 @@ namespace servicesim
         servicesim_competition::DropOffGuest::Request &_req,
         servicesim_competition::DropOffGuest::Response &_res);
 
-    /// \brief Callback when messages are received from the ContainPlugin.
-    /// \param[in] _msg True if contains.
-    private: void OnContain(const ignition::msgs::Boolean &_msg);
+    /// \brief Keeps track of whether the guest is in the drop-off room.
+    /// The checkpoint is only complete once the guest is dropped off.
+    /// \param[in] _contain True if the guest is inside the room.
+    public: void OnContain(const bool _contain) override;
 
     /// \brief Callback when drift messages are received from FollowActorPlugin.
     /// \param[in] _msg Message with a code for the drift reason
     private: void OnDrift(const ignition::msgs::UInt32 &_msg);
 
-    /// \brief Callabck for enable service
-    /// \param[in] _rep Response
-    /// \param[in] _result Result
-    private: void EnableCallback(const ignition::msgs::Boolean &_rep,
-        const bool _result);
-
-    /// \brief Namespace for transport
-    private: std::string ns;
-
     /// \brief Ignition transport node for communication.
     private: ignition::transport::Node ignNode;
 
@@ -77,8 +69,8 @@ namespace servicesim
     /// \brief Guest name
     private: std::string guestName;
 
-    /// \brief True if enabled
-    private: bool enabled{false};
+    /// \brief True while subscribed to the guest's drift messages
+    private: bool subscribed{false};
 
     /// \brief True if guest is currently in the drop-off area
     private: bool containGuest{false};
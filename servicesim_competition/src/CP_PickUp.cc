@@ -18,8 +18,6 @@
 #include <ros/ros.h>
 #include <sdf/sdf.hh>
 #include <gazebo/common/Console.hh>
-#include <gazebo/physics/PhysicsIface.hh>
-#include <gazebo/physics/World.hh>
 
 #include "CP_PickUp.hh"
 
@@ -15,14 +15,20 @@
  *
 */
 
+#include <mutex>
+
 #include <gazebo/common/Console.hh>
-#include <gazebo/physics/PhysicsIface.hh>
-#include <gazebo/physics/World.hh>
 
 #include "Checkpoint.hh"
 
 using namespace servicesim;
 
+/// \brief Clock shared by all checkpoints
+static Checkpoint::Clock g_clock;
+
+/// \brief Protects g_clock
+static std::mutex g_clockMutex;
+
 /////////////////////////////////////////////////
 Checkpoint::Checkpoint(const sdf::ElementPtr &_sdf)
 {
@@ -69,7 +75,7 @@ double Checkpoint::Score() const
     // If not finished yet
     if (end == gazebo::common::Time::Zero)
     {
-      end = gazebo::physics::get_world()->SimTime();
+      end = Checkpoint::Now();
     }
 
     elapsedSeconds += (end - start).Double();
@@ -78,6 +84,22 @@ double Checkpoint::Score() const
   return elapsedSeconds * this->weightTime + this->penalty;
 }
 
+/////////////////////////////////////////////////
+void Checkpoint::SetClock(const Clock &_clock)
+{
+  std::lock_guard<std::mutex> lock(g_clockMutex);
+  g_clock = _clock;
+}
+
+/////////////////////////////////////////////////
+gazebo::common::Time Checkpoint::Now()
+{
+  std::lock_guard<std::mutex> lock(g_clockMutex);
+  if (!g_clock)
+    return gazebo::common::Time::Zero;
+  return g_clock();
+}
+
 /////////////////////////////////////////////////
 void Checkpoint::Start()
 {
@@ -90,7 +112,7 @@ void Checkpoint::Start()
   }
 
   // Current time
-  auto time = gazebo::physics::get_world()->SimTime();
+  auto time = Checkpoint::Now();
   auto timeStr = time.FormattedString(gazebo::common::Time::HOURS,
                                       gazebo::common::Time::MILLISECONDS);
 
@@ -120,6 +142,35 @@ void Checkpoint::Start()
   this->intervals.push_back(interval);
 }
 
+/////////////////////////////////////////////////
+void Checkpoint::Skip()
+{
+  if (this->done)
+    return;
+
+  auto time = Checkpoint::Now();
+
+  if (this->intervals.empty() ||
+      this->intervals.back().second != gazebo::common::Time::Zero)
+  {
+    std::pair<gazebo::common::Time, gazebo::common::Time> interval(
+        time, time);
+    this->intervals.push_back(interval);
+  }
+  else
+  {
+    this->intervals.back().second = time;
+  }
+
+  this->done = true;
+  this->paused = false;
+
+  gzmsg << "[ServiceSim] Skipped Checkpoint \"" << this->name << "\" at "
+        << time.FormattedString(gazebo::common::Time::HOURS,
+                                gazebo::common::Time::MILLISECONDS)
+        << std::endl;
+}
+
 /////////////////////////////////////////////////
 void Checkpoint::Pause()
 {
@@ -138,7 +189,7 @@ void Checkpoint::Pause()
           << std::endl;
     return;
   }
-  interval.second = gazebo::physics::get_world()->SimTime();
+  interval.second = Checkpoint::Now();
 
   // Set paused
   this->paused = true;
@@ -189,7 +240,7 @@ void Checkpoint::SetDone(const bool _done)
   if (interval.second == gazebo::common::Time::Zero)
   {
     this->done = _done;
-    interval.second = gazebo::physics::get_world()->SimTime();
+    interval.second = Checkpoint::Now();
     gzmsg << "[ServiceSim] Checkpoint \"" << this->Name() << "\" complete"
           << std::endl;
   }
@@ -205,56 +256,37 @@ bool Checkpoint::Done() const
 ContainCheckpoint::ContainCheckpoint(const sdf::ElementPtr &_sdf)
     : Checkpoint(_sdf)
 {
-  if (!_sdf || !_sdf->HasElement("namespace"))
-    gzwarn << "Missing <namespace> for contain plugin" << std::endl;
+  if (!_sdf || !_sdf->HasElement("entity"))
+    gzerr << "Missing <entity> for contain checkpoint" << std::endl;
   else
-    this->ns = _sdf->Get<std::string>("namespace");
+    this->entity = _sdf->Get<std::string>("entity");
+
+  if (!_sdf || !_sdf->HasElement("room"))
+    gzerr << "Missing <room> for contain checkpoint" << std::endl;
+  else
+    this->room = _sdf->Get<std::string>("room");
 }
 
 /////////////////////////////////////////////////
-void ContainCheckpoint::EnableCallback(const ignition::msgs::Boolean &/*_rep*/,
-    const bool _result)
+bool ContainCheckpoint::Check()
 {
-  if (_result)
-    this->enabled = !this->enabled;
+  return this->Done();
 }
 
 /////////////////////////////////////////////////
-bool ContainCheckpoint::Check()
+void ContainCheckpoint::OnContain(const bool _contain)
 {
-  // First time checking
-  if (!this->enabled && !this->Done())
-  {
-    // Setup contain subscriber
-    this->ignNode.Subscribe(this->ns + "/contain",
-        &ContainCheckpoint::OnContain, this);
-
-    // Enable contain plugin
-    ignition::msgs::Boolean req;
-    req.set_data(true);
-    this->ignNode.Request(this->ns + "/enable", req,
-        &ContainCheckpoint::EnableCallback, this);
-  }
-
-  // Done, now clean up
-  if (this->enabled && this->Done() && !this->ignNode.SubscribedTopics().empty())
-  {
-    // Unsubscribe
-    for (auto const &sub : this->ignNode.SubscribedTopics())
-      this->ignNode.Unsubscribe(sub);
-
-    // Disable contain plugin
-    ignition::msgs::Boolean req;
-    req.set_data(false);
-    this->ignNode.Request(this->ns + "/enable", req,
-        &ContainCheckpoint::EnableCallback, this);
-  }
+  this->SetDone(_contain);
+}
 
-  return this->Done();
+/////////////////////////////////////////////////
+std::string ContainCheckpoint::Entity() const
+{
+  return this->entity;
 }
 
-//////////////////////////////////////////////////
-void ContainCheckpoint::OnContain(const ignition::msgs::Boolean &_msg)
+/////////////////////////////////////////////////
+std::string ContainCheckpoint::Room() const
 {
-  this->SetDone(_msg.data());
+  return this->room;
 }
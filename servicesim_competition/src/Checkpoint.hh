@@ -18,6 +18,8 @@
 #ifndef SERVICESIM_CHECKPOINT_HH_
 #define SERVICESIM_CHECKPOINT_HH_
 
+#include <functional>
+
 #include <sdf/sdf.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/msgs/boolean.pb.h>
@@ -28,6 +30,9 @@ namespace servicesim
 {
   class Checkpoint
   {
+    /// \brief Function returning the current sim time
+    public: using Clock = std::function<gazebo::common::Time()>;
+
     /// \brief Constructor
     /// \param[in] _sdf SDF element with configuration for this checkpoint.
     public: Checkpoint(const sdf::ElementPtr &_sdf);
@@ -53,6 +58,12 @@ namespace servicesim
     /// \brief Call this the first time the checkpoint is checked.
     public: void Start();
 
+    /// \brief Complete the checkpoint without going through it, such as when
+    /// seeking to a later checkpoint. A running interval is closed, and one of
+    /// zero length is added if there's none, so the checkpoint can be
+    /// restarted later like one which was completed.
+    public: void Skip();
+
     /// \brief Get the current score for this checkpoint.
     /// \return Score
     public: virtual double Score() const;
@@ -61,6 +72,15 @@ namespace servicesim
     /// \return Checkpoint's name
     public: std::string Name() const;
 
+    /// \brief Set the clock all checkpoints measure their intervals with,
+    /// such as the Gazebo world's sim time.
+    /// \param[in] _clock Clock function.
+    public: static void SetClock(const Clock &_clock);
+
+    /// \brief Current time, from the clock.
+    /// \return Sim time, zero if no clock has been set.
+    protected: static gazebo::common::Time Now();
+
     /// \brief Pause the checkpoint, ending the current interval. Only works if
     /// canPause is true.
     protected: void Pause();
@@ -99,7 +119,15 @@ namespace servicesim
     private: bool paused{false};
   };
 
-  /// \brief A checkpoint tied to a gazebo::ContainPlugin.
+  /// \brief A checkpoint which is complete once an entity is inside a room.
+  ///
+  /// The region test itself is run by the CompetitionPlugin against the
+  /// room's box, which calls OnContain whenever the entity enters or leaves
+  /// it.
+  ///
+  /// The checkpoint has the following SDF description:
+  /// <entity>   Name of the model which should be inside the room.
+  /// <room>     Name of the room, as given to the competition's <room_info>.
   class ContainCheckpoint : public Checkpoint
   {
     /// \brief Constructor
@@ -110,24 +138,24 @@ namespace servicesim
     /// \return True if completed.
     protected: bool Check() override;
 
-    /// \brief Callback when messages are received from the ContainPlugin.
-    /// \param[in] _msg True if contains.
-    private: void OnContain(const ignition::msgs::Boolean &_msg);
+    /// \brief Called when the entity enters or leaves the room, and once
+    /// every time the checkpoint becomes the current one.
+    /// \param[in] _contain True if the entity is inside the room.
+    public: virtual void OnContain(const bool _contain);
 
-    /// \brief Callabck for enable service
-    /// \param[in] _rep Response
-    /// \param[in] _result Result
-    private: void EnableCallback(const ignition::msgs::Boolean &_rep,
-        const bool _result);
+    /// \brief Get the name of the entity which should be inside the room.
+    /// \return Entity name.
+    public: std::string Entity() const;
 
-    /// \brief Ignition transport node for communication.
-    protected: ignition::transport::Node ignNode;
+    /// \brief Get the name of the room the entity should be in.
+    /// \return Room name.
+    public: std::string Room() const;
 
-    /// \brief Namespace for transport
-    protected: std::string ns;
+    /// \brief Name of the entity
+    protected: std::string entity;
 
-    /// \brief True if enabled
-    private: bool enabled{false};
+    /// \brief Name of the room
+    protected: std::string room;
   };
 }
 #endif
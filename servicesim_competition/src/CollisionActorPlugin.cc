@@ -15,12 +15,18 @@
  *
 */
 
+#include <map>
+#include <set>
+#include <string>
+
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 
 #include <gazebo/physics/Actor.hh>
 #include <gazebo/physics/BoxShape.hh>
 #include <gazebo/physics/Collision.hh>
 #include <gazebo/physics/Link.hh>
+#include "LoadProfiler.hh"
 #include "CollisionActorPlugin.hh"
 
 using namespace servicesim;
@@ -34,6 +40,8 @@ CollisionActorPlugin::CollisionActorPlugin()
 /////////////////////////////////////////////////
 void CollisionActorPlugin::Load(gazebo::physics::ModelPtr _model, sdf::ElementPtr _sdf)
 {
+  LoadTimer timer("CollisionActorPlugin::Load", "plugin", _model->GetName());
+
   // Get a pointer to the actor
   auto actor = boost::dynamic_pointer_cast<gazebo::physics::Actor>(_model);
 
@@ -41,20 +49,29 @@ void CollisionActorPlugin::Load(gazebo::physics::ModelPtr _model, sdf::ElementPt
   std::map<std::string, ignition::math::Vector3d> scaling;
   std::map<std::string, ignition::math::Pose3d> offsets;
 
-  // Read in the collision scaling factors, if present
-  if (_sdf->HasElement("scaling"))
+  // Collisions which are kept in proxy mode
+  std::set<std::string> proxies;
+
+  // Read in the collision scaling factors and proxies, if present
+  for (const std::string elemName : {"scaling", "proxy"})
   {
-    auto elem = _sdf->GetElement("scaling");
+    if (!_sdf->HasElement(elemName))
+      continue;
+
+    auto elem = _sdf->GetElement(elemName);
     while (elem)
     {
       if (!elem->HasAttribute("collision"))
       {
         gzwarn << "Skipping element without collision attribute" << std::endl;
-        elem = elem->GetNextElement("scaling");
+        elem = elem->GetNextElement(elemName);
         continue;
       }
       auto name = elem->Get<std::string>("collision");
 
+      if (elemName == "proxy")
+        proxies.insert(name);
+
       if (elem->HasAttribute("scale"))
       {
         auto scale = elem->Get<ignition::math::Vector3d>("scale");
@@ -66,16 +83,35 @@ void CollisionActorPlugin::Load(gazebo::physics::ModelPtr _model, sdf::ElementPt
         auto pose = elem->Get<ignition::math::Pose3d>("pose");
         offsets[name] = pose;
       }
-      elem = elem->GetNextElement("scaling");
+      elem = elem->GetNextElement(elemName);
     }
   }
 
+  LoadTimer linksTimer("CollisionActorPlugin links", "plugin",
+      _model->GetName());
   for (const auto &link : actor->GetLinks())
   {
+    // In proxy mode, skip links which don't hold any proxy
+    if (!proxies.empty())
+    {
+      bool hasProxy{false};
+      for (const auto &collision : link->GetCollisions())
+      {
+        if (proxies.find(collision->GetName()) != proxies.end())
+        {
+          hasProxy = true;
+          break;
+        }
+      }
+
+      if (!hasProxy)
+        continue;
+    }
+
     // Init the links, which in turn enables collisions
     link->Init();
 
-    if (scaling.empty())
+    if (scaling.empty() && offsets.empty())
       continue;
 
     // Process all the collisions in all the links
@@ -101,4 +137,3 @@ void CollisionActorPlugin::Load(gazebo::physics::ModelPtr _model, sdf::ElementPt
     }
   }
 }
-
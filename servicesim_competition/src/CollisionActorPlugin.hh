@@ -28,6 +28,14 @@ namespace servicesim
   /// Collisions only work on enabled objects. ODE has a auto-disable
   /// feature that "disables" an object when it comes to rest. An actor will
   /// pass through these objects.
+  ///
+  /// SDF params:
+  ///   * <scaling collision="name" scale="x y z" pose="x y z r p y"/>
+  ///     Scale and offset a bone's box collision. More than one can be given.
+  ///   * <proxy collision="name" scale="x y z" pose="x y z r p y"/>
+  ///     Same as <scaling>, but enables proxy mode: only links holding a
+  ///     proxy collision are initialized, so the actor is represented by a
+  ///     handful of primitives instead of one box per bone.
   class CollisionActorPlugin : public gazebo::ModelPlugin
   {
     /// \brief Constructor
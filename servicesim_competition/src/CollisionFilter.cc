@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <set>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/physics/Collision.hh>
+#include <gazebo/physics/Link.hh>
+#include <gazebo/physics/Model.hh>
+#include <gazebo/physics/World.hh>
+
+#include "CollisionFilter.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+CollisionFilter::CollisionFilter(const sdf::ElementPtr &_sdf)
+{
+  if (!_sdf)
+  {
+    gzerr << "Missing SDF element" << std::endl;
+    return;
+  }
+
+  this->robotName = _sdf->Get<std::string>("robot_name");
+  this->groundName = _sdf->Get<std::string>("ground_name");
+  this->humanName = _sdf->Get<std::string>("human_name");
+}
+
+/////////////////////////////////////////////////
+void CollisionFilter::Update(const gazebo::physics::WorldPtr &_world)
+{
+  // Only go through models when some have been inserted or removed
+  if (!this->models.Changed(_world))
+    return;
+
+  bool changed{false};
+  std::set<uint32_t> present;
+  for (unsigned int i = 0; i < _world->ModelCount(); ++i)
+  {
+    auto model = _world->ModelByIndex(i);
+    present.insert(model->GetId());
+
+    if (this->assigned.find(model->GetId()) != this->assigned.end())
+      continue;
+
+    this->assigned[model->GetId()] = this->Assign(model);
+    changed = true;
+  }
+
+  // Forget removed models
+  for (auto it = this->assigned.begin(); it != this->assigned.end();)
+  {
+    if (present.find(it->first) == present.end())
+    {
+      it = this->assigned.erase(it);
+      changed = true;
+    }
+    else
+      ++it;
+  }
+
+  if (changed)
+    this->Report();
+}
+
+/////////////////////////////////////////////////
+std::pair<unsigned int, unsigned int> CollisionFilter::Masks(
+    const unsigned int _category)
+{
+  // Static models and the ground never move, so they don't need to be
+  // checked against each other
+  const unsigned int fixed = GZ_FIXED_COLLIDE | kStatic | kGround;
+
+  unsigned int category;
+  unsigned int collide;
+
+  switch (_category)
+  {
+    case kRobot:
+      category = kRobot;
+      collide = GZ_ALL_COLLIDE;
+      break;
+    case kHuman:
+      category = kHuman;
+      collide = kRobot;
+      break;
+    case kGround:
+    case kStatic:
+      category = GZ_FIXED_COLLIDE | _category;
+      collide = GZ_ALL_COLLIDE & ~(fixed | kHuman);
+      break;
+    default:
+      category = kOther;
+      collide = GZ_ALL_COLLIDE & ~kHuman;
+      break;
+  }
+
+  return std::make_pair(category, collide);
+}
+
+/////////////////////////////////////////////////
+std::pair<unsigned int, unsigned int> CollisionFilter::Assign(
+    const gazebo::physics::ModelPtr &_model)
+{
+  auto name = _model->GetName();
+
+  unsigned int key;
+  if (!this->robotName.empty() && name.find(this->robotName) == 0)
+    key = kRobot;
+  else if (!this->humanName.empty() && name.find(this->humanName) == 0)
+    key = kHuman;
+  else if (name == this->groundName)
+    key = kGround;
+  else if (_model->IsStatic())
+    key = kStatic;
+  else
+    key = kOther;
+
+  auto masks = Masks(key);
+  auto category = masks.first;
+  auto collide = masks.second;
+
+  unsigned int count{0};
+
+  for (const auto &link : _model->GetLinks())
+  {
+    for (const auto &collision : link->GetCollisions())
+    {
+      // Respect bitmasks explicitly set in SDF
+      auto collisionElem = collision->GetSDF();
+      if (collisionElem && collisionElem->HasElement("surface"))
+      {
+        auto surfaceElem = collisionElem->GetElement("surface");
+        if (surfaceElem->HasElement("contact") &&
+            surfaceElem->GetElement("contact")->HasElement("collide_bitmask"))
+        {
+          continue;
+        }
+      }
+
+      collision->SetCategoryBits(category);
+      collision->SetCollideBits(collide);
+      count++;
+    }
+  }
+
+  return std::make_pair(key, count);
+}
+
+/////////////////////////////////////////////////
+void CollisionFilter::Report() const
+{
+  std::map<unsigned int, unsigned int> counts;
+  for (const auto &model : this->assigned)
+    counts[model.second.first] += model.second.second;
+
+  auto count = [&counts](const unsigned int _category) -> unsigned int
+  {
+    auto it = counts.find(_category);
+    return it == counts.end() ? 0u : it->second;
+  };
+
+  auto humans = count(kHuman);
+  auto statics = count(kStatic);
+  auto others = statics + count(kGround) + count(kOther);
+
+  // Estimated from counts rather than measured: pairs which could reach the
+  // narrow phase without filtering are humans against each other and against
+  // everything which isn't the robot, and static models against each other
+  // and against the ground. The broad phase already drops the distant ones.
+  unsigned int filtered = humans * others + statics * count(kGround);
+  if (humans > 0)
+    filtered += humans * (humans - 1) / 2;
+  if (statics > 0)
+    filtered += statics * (statics - 1) / 2;
+
+  gzmsg << "[ServiceSim] Collision filter: "
+        << count(kRobot) << " robot, "
+        << humans << " human, "
+        << count(kStatic) << " static, "
+        << count(kGround) << " ground and "
+        << count(kOther) << " other collisions. "
+        << "At most " << filtered << " collision pairs filtered out "
+        << "(estimate)."
+        << std::endl;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_COLLISIONFILTER_HH_
+#define SERVICESIM_COLLISIONFILTER_HH_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <sdf/sdf.hh>
+#include <gazebo/physics/PhysicsTypes.hh>
+
+#include "ModelTracker.hh"
+
+namespace servicesim
+{
+  /// \brief Assigns collision category and collide bitmasks to models in the
+  /// world according to their names, so the physics engine skips pairs which
+  /// don't matter for the competition.
+  ///
+  /// Categories:
+  ///   * Robot: models starting with <robot_name>, collide with everything.
+  ///   * Human: models starting with <human_name>, i.e. actors and their
+  ///            collision proxies, collide only with the robot.
+  ///   * Ground: the <ground_name> model, collides with everything but
+  ///             humans and static models.
+  ///   * Static: other static models, collide with everything but humans,
+  ///             the ground and other static models.
+  ///   * Other: remaining dynamic models, collide with everything but humans.
+  ///
+  /// Gazebo's own bit for fixed collisions is kept on static models.
+  /// Collisions which have a <collide_bitmask> set in SDF are left untouched.
+  /// Models which are removed and inserted again, such as streamed
+  /// furniture, are assigned again.
+  class CollisionFilter
+  {
+    /// \brief Category bit for the robot. Lower bits are used by Gazebo for
+    /// fixed and sensor collisions.
+    public: static const unsigned int kRobot = 0x0100;
+
+    /// \brief Category bit for humans, both actors and their proxies
+    public: static const unsigned int kHuman = 0x0200;
+
+    /// \brief Category bit for static models
+    public: static const unsigned int kStatic = 0x0400;
+
+    /// \brief Category bit for the ground
+    public: static const unsigned int kGround = 0x0800;
+
+    /// \brief Category bit for all other models
+    public: static const unsigned int kOther = 0x1000;
+
+    /// \brief Constructor
+    /// \param[in] _sdf SDF element with configuration, containing
+    /// <robot_name>, <ground_name> and <human_name>.
+    public: CollisionFilter(const sdf::ElementPtr &_sdf);
+
+    /// \brief Get the category and collide bitmasks given to collisions of a
+    /// category.
+    /// \param[in] _category One of the category bits above.
+    /// \return Category and collide bitmasks.
+    public: static std::pair<unsigned int, unsigned int> Masks(
+        const unsigned int _category);
+
+    /// \brief Assign bitmasks to models which were inserted since the last
+    /// call, and forget models which were removed. Models such as the robot
+    /// may be spawned after load, so this should be called periodically.
+    /// \param[in] _world Pointer to the world.
+    public: void Update(const gazebo::physics::WorldPtr &_world);
+
+    /// \brief Assign bitmasks to all collisions in a model.
+    /// \param[in] _model Model to process.
+    /// \return Category used for counting and number of collisions assigned.
+    private: std::pair<unsigned int, unsigned int> Assign(
+        const gazebo::physics::ModelPtr &_model);
+
+    /// \brief Print how many collision pairs are filtered out. This is an
+    /// upper bound computed from collision counts, not measured in ODE: pairs
+    /// which are far apart are already dropped by ODE's broad phase.
+    private: void Report() const;
+
+    /// \brief Robot name
+    private: std::string robotName;
+
+    /// \brief Ground name
+    private: std::string groundName;
+
+    /// \brief Prefix common to all human names
+    private: std::string humanName;
+
+    /// \brief IDs of models which have already been processed, mapped to
+    /// their category and number of collisions assigned.
+    private: std::map<uint32_t, std::pair<unsigned int, unsigned int>>
+        assigned;
+
+    /// \brief Tells when models were inserted or removed
+    private: ModelTracker models;
+  };
+}
+#endif
@@ -0,0 +1,569 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <utility>
+
+#include "CollisionFitter.hh"
+
+using namespace servicesim;
+
+/// \brief Step between the yaws tried for boxes, in radians
+static const double kYawStep = M_PI / 90.0;
+
+/// \brief Thinnest side given to boxes around flat meshes
+static const double kMinThickness = 0.001;
+
+/// \brief Axis-aligned bounds.
+struct Bounds
+{
+  /// \brief Minimum corner
+  double min[3]{std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+
+  /// \brief Maximum corner
+  double max[3]{std::numeric_limits<double>::lowest(),
+      std::numeric_limits<double>::lowest(),
+      std::numeric_limits<double>::lowest()};
+
+  /// \brief Grow to include a point.
+  /// \param[in] _p Point.
+  void Add(const double _p[3])
+  {
+    for (int a = 0; a < 3; ++a)
+    {
+      this->min[a] = std::min(this->min[a], _p[a]);
+      this->max[a] = std::max(this->max[a], _p[a]);
+    }
+  }
+
+  /// \brief Whether any point was added.
+  /// \return True if empty.
+  bool Empty() const
+  {
+    return this->min[0] > this->max[0];
+  }
+
+  /// \brief Volume, with sides no thinner than kMinThickness.
+  /// \return Volume.
+  double Volume() const
+  {
+    double volume{1.0};
+    for (int a = 0; a < 3; ++a)
+      volume *= std::max(this->max[a] - this->min[a], kMinThickness);
+    return volume;
+  }
+};
+
+/// \brief Point in a frame rotated by a yaw.
+/// \param[in] _v Point.
+/// \param[in] _cos Cosine of the frame's yaw.
+/// \param[in] _sin Sine of the frame's yaw.
+/// \param[out] _out Coordinates in the frame.
+static void ToFrame(const ignition::math::Vector3d &_v, const double _cos,
+    const double _sin, double _out[3])
+{
+  _out[0] = _v.X() * _cos + _v.Y() * _sin;
+  _out[1] = -_v.X() * _sin + _v.Y() * _cos;
+  _out[2] = _v.Z();
+}
+
+/// \brief Box shape from bounds in a frame rotated by a yaw.
+/// \param[in] _bounds Bounds in the frame.
+/// \param[in] _yaw Frame yaw.
+/// \return Box shape.
+static FittedShape BoxFromBounds(const Bounds &_bounds, const double _yaw)
+{
+  double c[3];
+  double s[3];
+  for (int a = 0; a < 3; ++a)
+  {
+    c[a] = (_bounds.min[a] + _bounds.max[a]) * 0.5;
+    s[a] = std::max(_bounds.max[a] - _bounds.min[a], kMinThickness);
+  }
+
+  FittedShape box;
+  box.type = FittedShape::BOX;
+  box.yaw = _yaw;
+  box.center = ignition::math::Vector3d(
+      c[0] * std::cos(_yaw) - c[1] * std::sin(_yaw),
+      c[0] * std::sin(_yaw) + c[1] * std::cos(_yaw), c[2]);
+  box.size = ignition::math::Vector3d(s[0], s[1], s[2]);
+  return box;
+}
+
+/// \brief Smallest circle enclosing points on the XY plane.
+/// \param[in] _points Points, Z is ignored.
+/// \param[out] _x Center X.
+/// \param[out] _y Center Y.
+/// \param[out] _r Radius.
+static void EnclosingCircle(
+    const std::vector<ignition::math::Vector3d> &_points, double &_x,
+    double &_y, double &_r)
+{
+  auto outside = [&](const ignition::math::Vector3d &_p)
+  {
+    return std::hypot(_p.X() - _x, _p.Y() - _y) > _r * (1.0 + 1e-12);
+  };
+
+  _x = _points[0].X();
+  _y = _points[0].Y();
+  _r = 0.0;
+  for (size_t i = 1; i < _points.size(); ++i)
+  {
+    if (!outside(_points[i]))
+      continue;
+
+    const auto &a = _points[i];
+    _x = a.X();
+    _y = a.Y();
+    _r = 0.0;
+    for (size_t j = 0; j < i; ++j)
+    {
+      if (!outside(_points[j]))
+        continue;
+
+      const auto &b = _points[j];
+      _x = (a.X() + b.X()) * 0.5;
+      _y = (a.Y() + b.Y()) * 0.5;
+      _r = std::hypot(a.X() - _x, a.Y() - _y);
+      for (size_t k = 0; k < j; ++k)
+      {
+        if (!outside(_points[k]))
+          continue;
+
+        // Circumcircle of a, b and c
+        const auto &c = _points[k];
+        auto bx = b.X() - a.X();
+        auto by = b.Y() - a.Y();
+        auto cx = c.X() - a.X();
+        auto cy = c.Y() - a.Y();
+        auto d = 2.0 * (bx * cy - by * cx);
+        if (std::abs(d) < 1e-12)
+          continue;
+
+        auto b2 = bx * bx + by * by;
+        auto c2 = cx * cx + cy * cy;
+        _x = a.X() + (cy * b2 - by * c2) / d;
+        _y = a.Y() + (bx * c2 - cx * b2) / d;
+        _r = std::hypot(a.X() - _x, a.Y() - _y);
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+double FittedShape::Volume() const
+{
+  switch (this->type)
+  {
+    case BOX:
+      return this->size.X() * this->size.Y() * this->size.Z();
+    case CYLINDER:
+      return M_PI * this->size.X() * this->size.X() * this->size.Z();
+    case HULL:
+    {
+      double volume{0.0};
+      for (const auto &t : this->triangles)
+      {
+        volume += this->vertices[t[0]].Dot(
+            this->vertices[t[1]].Cross(this->vertices[t[2]]));
+      }
+      return volume / 6.0;
+    }
+  }
+  return 0.0;
+}
+
+/////////////////////////////////////////////////
+size_t FittedShape::PairCost() const
+{
+  return this->type == HULL ? this->triangles.size() : 1u;
+}
+
+/////////////////////////////////////////////////
+void CollisionFitter::AddTriangle(const ignition::math::Vector3d &_a,
+    const ignition::math::Vector3d &_b, const ignition::math::Vector3d &_c)
+{
+  this->points.push_back(_a);
+  this->points.push_back(_b);
+  this->points.push_back(_c);
+}
+
+/////////////////////////////////////////////////
+size_t CollisionFitter::TriangleCount() const
+{
+  return this->points.size() / 3;
+}
+
+/////////////////////////////////////////////////
+Fit CollisionFitter::Compute(const double _tolerance,
+    const unsigned int _maxBoxes) const
+{
+  Fit fit;
+  if (this->points.empty())
+    return fit;
+
+  FittedShape hull;
+  hull.type = FittedShape::HULL;
+  bool solid = ConvexHull(this->points, hull.vertices, hull.triangles);
+  if (solid)
+    fit.hullVolume = hull.Volume();
+
+  // Enclosing the hull's vertices encloses all triangles
+  const auto &outline = solid ? hull.vertices : this->points;
+
+  // Yaw giving the smallest box
+  double bestYaw{0.0};
+  Bounds best;
+  for (double yaw = 0.0; yaw < M_PI * 0.5; yaw += kYawStep)
+  {
+    auto c = std::cos(yaw);
+    auto s = std::sin(yaw);
+
+    Bounds bounds;
+    double p[3];
+    for (const auto &v : outline)
+    {
+      ToFrame(v, c, s, p);
+      bounds.Add(p);
+    }
+
+    if (best.Empty() || bounds.Volume() < best.Volume())
+    {
+      best = bounds;
+      bestYaw = yaw;
+    }
+  }
+
+  std::vector<Fit> candidates;
+
+  // Single box or cylinder, whichever is tighter
+  {
+    Fit single;
+    single.shapes.push_back(BoxFromBounds(best, bestYaw));
+
+    double x, y, r;
+    EnclosingCircle(outline, x, y, r);
+
+    FittedShape cylinder;
+    cylinder.type = FittedShape::CYLINDER;
+    cylinder.center = ignition::math::Vector3d(x, y,
+        (best.min[2] + best.max[2]) * 0.5);
+    cylinder.size = ignition::math::Vector3d(r, r,
+        std::max(best.max[2] - best.min[2], kMinThickness));
+    if (cylinder.Volume() < single.shapes[0].Volume())
+      single.shapes[0] = cylinder;
+
+    candidates.push_back(single);
+  }
+
+  // Slabs along each axis of the best box's frame, clipping triangles at
+  // the slab boundaries so each slab's box only covers what's inside it
+  auto c = std::cos(bestYaw);
+  auto s = std::sin(bestYaw);
+  std::vector<std::array<double, 3>> local(this->points.size());
+  for (size_t i = 0; i < this->points.size(); ++i)
+    ToFrame(this->points[i], c, s, local[i].data());
+
+  for (unsigned int count = 2; count <= _maxBoxes; ++count)
+  {
+    Fit tightest;
+    double tightestVolume{std::numeric_limits<double>::max()};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      auto lo = best.min[axis];
+      auto width = (best.max[axis] - lo) / count;
+      if (width <= 0.0)
+        continue;
+
+      std::vector<Bounds> slabs(count);
+      for (size_t t = 0; t + 2 < local.size(); t += 3)
+      {
+        const double *v[3] = {local[t].data(), local[t + 1].data(),
+            local[t + 2].data()};
+
+        auto tMin = std::min({v[0][axis], v[1][axis], v[2][axis]});
+        auto tMax = std::max({v[0][axis], v[1][axis], v[2][axis]});
+        auto first = std::max(0, static_cast<int>((tMin - lo) / width));
+        auto last = std::min(static_cast<int>(count) - 1,
+            static_cast<int>((tMax - lo) / width));
+
+        for (int slab = first; slab <= last; ++slab)
+        {
+          auto s0 = lo + slab * width;
+          auto s1 = s0 + width;
+
+          // Vertices inside the slab
+          for (int k = 0; k < 3; ++k)
+          {
+            if (v[k][axis] >= s0 && v[k][axis] <= s1)
+              slabs[slab].Add(v[k]);
+          }
+
+          // Edges crossing the slab's planes
+          for (int k = 0; k < 3; ++k)
+          {
+            const double *a = v[k];
+            const double *b = v[(k + 1) % 3];
+            auto da = b[axis] - a[axis];
+            if (std::abs(da) < 1e-12)
+              continue;
+
+            for (auto plane : {s0, s1})
+            {
+              auto f = (plane - a[axis]) / da;
+              if (f <= 0.0 || f >= 1.0)
+                continue;
+
+              double p[3];
+              for (int i = 0; i < 3; ++i)
+                p[i] = a[i] + (b[i] - a[i]) * f;
+              slabs[slab].Add(p);
+            }
+          }
+        }
+      }
+
+      Fit slabFit;
+      double volume{0.0};
+      for (const auto &slab : slabs)
+      {
+        if (slab.Empty())
+          continue;
+        slabFit.shapes.push_back(BoxFromBounds(slab, bestYaw));
+        volume += slab.Volume();
+      }
+
+      if (volume < tightestVolume)
+      {
+        tightestVolume = volume;
+        tightest = slabFit;
+      }
+    }
+
+    if (!tightest.shapes.empty())
+      candidates.push_back(tightest);
+  }
+
+  for (auto &candidate : candidates)
+  {
+    candidate.hullVolume = fit.hullVolume;
+    for (const auto &shape : candidate.shapes)
+    {
+      candidate.volume += shape.Volume();
+      candidate.pairCost += shape.PairCost();
+    }
+    candidate.withinTolerance = !solid ||
+        candidate.volume <= fit.hullVolume * (1.0 + _tolerance);
+  }
+
+  // Cheapest candidate within tolerance
+  for (const auto &candidate : candidates)
+  {
+    if (candidate.withinTolerance)
+      return candidate;
+  }
+
+  // The hull is exact, but only worth it if simpler than the input
+  if (hull.triangles.size() < this->TriangleCount())
+  {
+    fit.shapes.push_back(hull);
+    fit.volume = fit.hullVolume;
+    fit.pairCost = hull.PairCost();
+    fit.withinTolerance = true;
+    return fit;
+  }
+
+  return *std::min_element(candidates.begin(), candidates.end(),
+      [](const Fit &_a, const Fit &_b)
+      {
+        return _a.volume < _b.volume;
+      });
+}
+
+/////////////////////////////////////////////////
+bool CollisionFitter::ConvexHull(
+    const std::vector<ignition::math::Vector3d> &_points,
+    std::vector<ignition::math::Vector3d> &_vertices,
+    std::vector<std::array<size_t, 3>> &_triangles)
+{
+  _vertices.clear();
+  _triangles.clear();
+  if (_points.size() < 4)
+    return false;
+
+  // Tolerance relative to the size of the point set
+  ignition::math::Vector3d min = _points[0];
+  ignition::math::Vector3d max = _points[0];
+  for (const auto &p : _points)
+  {
+    min.Min(p);
+    max.Max(p);
+  }
+  auto eps = 1e-9 * std::max(1.0, (max - min).Length());
+
+  // Initial tetrahedron from extreme points
+  size_t i0{0};
+  for (size_t i = 1; i < _points.size(); ++i)
+  {
+    if (_points[i].X() < _points[i0].X())
+      i0 = i;
+  }
+
+  auto farthest = [&](std::function<double(const ignition::math::Vector3d &)>
+      _distance, double &_best)
+  {
+    size_t index{0};
+    _best = -1.0;
+    for (size_t i = 0; i < _points.size(); ++i)
+    {
+      auto d = _distance(_points[i]);
+      if (d > _best)
+      {
+        _best = d;
+        index = i;
+      }
+    }
+    return index;
+  };
+
+  const auto &p0 = _points[i0];
+  double dist;
+  auto i1 = farthest([&](const ignition::math::Vector3d &_p)
+      {
+        return (_p - p0).Length();
+      }, dist);
+  if (dist < eps)
+    return false;
+
+  auto line = (_points[i1] - p0).Normalize();
+  auto i2 = farthest([&](const ignition::math::Vector3d &_p)
+      {
+        return line.Cross(_p - p0).Length();
+      }, dist);
+  if (dist < eps)
+    return false;
+
+  auto normal = line.Cross(_points[i2] - p0).Normalize();
+  auto i3 = farthest([&](const ignition::math::Vector3d &_p)
+      {
+        return std::abs(normal.Dot(_p - p0));
+      }, dist);
+  if (dist < eps)
+    return false;
+
+  auto interior = (_points[i0] + _points[i1] + _points[i2] + _points[i3]) *
+      0.25;
+
+  struct Face
+  {
+    size_t v[3];
+    ignition::math::Vector3d normal;
+    double offset;
+  };
+
+  // Faces point away from the interior point
+  auto makeFace = [&](size_t _a, size_t _b, size_t _c)
+  {
+    Face face;
+    auto n = (_points[_b] - _points[_a]).Cross(_points[_c] - _points[_a]);
+    if (n.Dot(interior - _points[_a]) > 0)
+    {
+      std::swap(_b, _c);
+      n = -n;
+    }
+    face.v[0] = _a;
+    face.v[1] = _b;
+    face.v[2] = _c;
+    face.normal = n.Normalize();
+    face.offset = face.normal.Dot(_points[_a]);
+    return face;
+  };
+
+  std::vector<Face> faces{makeFace(i0, i1, i2), makeFace(i0, i1, i3),
+      makeFace(i0, i2, i3), makeFace(i1, i2, i3)};
+
+  // Add points one at a time, replacing the faces they can see
+  std::vector<bool> visible;
+  for (size_t p = 0; p < _points.size(); ++p)
+  {
+    visible.assign(faces.size(), false);
+    bool any{false};
+    for (size_t f = 0; f < faces.size(); ++f)
+    {
+      if (faces[f].normal.Dot(_points[p]) - faces[f].offset > eps)
+      {
+        visible[f] = true;
+        any = true;
+      }
+    }
+    if (!any)
+      continue;
+
+    // The horizon is made of edges which belong to a single visible face
+    std::map<std::pair<size_t, size_t>, int> edges;
+    for (size_t f = 0; f < faces.size(); ++f)
+    {
+      if (!visible[f])
+        continue;
+      for (int k = 0; k < 3; ++k)
+      {
+        auto a = faces[f].v[k];
+        auto b = faces[f].v[(k + 1) % 3];
+        edges[std::make_pair(std::min(a, b), std::max(a, b))]++;
+      }
+    }
+
+    std::vector<Face> kept;
+    for (size_t f = 0; f < faces.size(); ++f)
+    {
+      if (!visible[f])
+        kept.push_back(faces[f]);
+    }
+    for (const auto &edge : edges)
+    {
+      if (edge.second == 1)
+        kept.push_back(makeFace(edge.first.first, edge.first.second, p));
+    }
+    faces.swap(kept);
+  }
+
+  // Only keep vertices used by faces
+  std::map<size_t, size_t> used;
+  for (const auto &face : faces)
+  {
+    std::array<size_t, 3> triangle;
+    for (int k = 0; k < 3; ++k)
+    {
+      auto it = used.find(face.v[k]);
+      if (it == used.end())
+      {
+        it = used.insert(std::make_pair(face.v[k], _vertices.size())).first;
+        _vertices.push_back(_points[face.v[k]]);
+      }
+      triangle[k] = it->second;
+    }
+    _triangles.push_back(triangle);
+  }
+
+  return true;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_COLLISIONFITTER_HH_
+#define SERVICESIM_COLLISIONFITTER_HH_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+namespace servicesim
+{
+  /// \brief A collision shape fitted to a link's meshes, in the link frame.
+  struct FittedShape
+  {
+    /// \brief Shape types
+    enum Type
+    {
+      /// \brief Box with the given size
+      BOX,
+
+      /// \brief Cylinder along Z, with the radius on size X and the length
+      /// on size Z
+      CYLINDER,
+
+      /// \brief Convex hull, as a triangle mesh
+      HULL
+    };
+
+    /// \brief Shape type
+    Type type{BOX};
+
+    /// \brief Center of the shape
+    ignition::math::Vector3d center;
+
+    /// \brief Rotation about Z
+    double yaw{0.0};
+
+    /// \brief Box size, or cylinder radius and length
+    ignition::math::Vector3d size;
+
+    /// \brief Hull vertices, relative to the link
+    std::vector<ignition::math::Vector3d> vertices;
+
+    /// \brief Hull triangles, as indices into vertices
+    std::vector<std::array<size_t, 3>> triangles;
+
+    /// \brief Volume enclosed by the shape.
+    /// \return Volume in cubic meters.
+    double Volume() const;
+
+    /// \brief Rough cost of colliding this shape against a primitive,
+    /// counting one per primitive and one per triangle, as ODE tests
+    /// trimeshes triangle by triangle.
+    /// \return Cost.
+    size_t PairCost() const;
+  };
+
+  /// \brief Result of fitting a link.
+  struct Fit
+  {
+    /// \brief Fitted shapes
+    std::vector<FittedShape> shapes;
+
+    /// \brief Total volume of the shapes
+    double volume{0.0};
+
+    /// \brief Volume of the convex hull of all triangles
+    double hullVolume{0.0};
+
+    /// \brief Total pair cost of the shapes
+    size_t pairCost{0};
+
+    /// \brief False if no candidate was within tolerance and the hull
+    /// wasn't simpler than the input, so the tightest candidate was kept
+    bool withinTolerance{false};
+  };
+
+  /// \brief Fits simple collision shapes to the triangles of a link's
+  /// meshes.
+  ///
+  /// Shapes always enclose all triangles. Candidates are tried from the
+  /// cheapest to collide: a single box or cylinder, then boxes covering
+  /// slabs of the mesh along one of its axes, up to a maximum count. The
+  /// first candidate whose volume exceeds the convex hull's by no more than
+  /// the tolerance wins. Otherwise the convex hull itself is used, unless it
+  /// has more triangles than the input, in which case the tightest
+  /// candidate is kept.
+  ///
+  /// Boxes and slabs are aligned with the yaw which gives the smallest
+  /// single box. Cylinders are upright.
+  class CollisionFitter
+  {
+    /// \brief Add a triangle.
+    /// \param[in] _a First vertex.
+    /// \param[in] _b Second vertex.
+    /// \param[in] _c Third vertex.
+    public: void AddTriangle(const ignition::math::Vector3d &_a,
+        const ignition::math::Vector3d &_b,
+        const ignition::math::Vector3d &_c);
+
+    /// \brief Number of triangles added.
+    /// \return Triangle count.
+    public: size_t TriangleCount() const;
+
+    /// \brief Fit shapes to the triangles added so far.
+    /// \param[in] _tolerance Largest accepted volume in excess of the
+    /// convex hull, as a fraction of the hull's volume.
+    /// \param[in] _maxBoxes Largest number of slab boxes to try.
+    /// \return Fitted shapes, empty if there are no triangles.
+    public: Fit Compute(const double _tolerance,
+        const unsigned int _maxBoxes) const;
+
+    /// \brief Compute the convex hull of a set of points.
+    /// \param[in] _points Points.
+    /// \param[out] _vertices Hull vertices.
+    /// \param[out] _triangles Hull triangles, facing outwards.
+    /// \return False if the points are all on a plane.
+    public: static bool ConvexHull(
+        const std::vector<ignition::math::Vector3d> &_points,
+        std::vector<ignition::math::Vector3d> &_vertices,
+        std::vector<std::array<size_t, 3>> &_triangles);
+
+    /// \brief Triangle vertices, three per triangle
+    private: std::vector<ignition::math::Vector3d> points;
+  };
+}
+#endif
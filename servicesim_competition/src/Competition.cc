@@ -0,0 +1,707 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/stringmsg.pb.h>
+#include <ignition/transport/Node.hh>
+#include <gazebo/common/Console.hh>
+
+#include <ros/ros.h>
+#include <servicesim_competition/Score.h>
+
+#include "Competition.hh"
+#include "Conversions.hh"
+#include "CP_DropOff.hh"
+#include "CP_GoToPickUp.hh"
+#include "CP_PickUp.hh"
+#include "CP_ReturnToStart.hh"
+#include "RoomIndex.hh"
+
+/////////////////////////////////////////////////
+class servicesim::CompetitionPrivate
+{
+  /// \brief Pick-up location name
+  public: std::string pickUpLocation;
+
+  /// \brief Drop-off location name
+  public: std::string dropOffLocation;
+
+  /// \brief Guest name
+  public: std::string guestName;
+
+  /// \brief Keep robot start pose
+  public: ignition::math::Pose3d robotStartPose;
+
+  /// \brief Finds entities tested against rooms
+  public: Competition::Locator locator;
+
+  /// \brief Moves entities when seeking to a checkpoint
+  public: Competition::Placer placer;
+
+  /// \brief Vector of checkpoints
+  public: std::vector<std::unique_ptr<Checkpoint>> checkpoints;
+
+  /// \brief Checkpoints which are complete once an entity is in a room, in
+  /// the same order as checkpoints. Null for other checkpoints.
+  public: std::vector<ContainCheckpoint *> containCheckpoints;
+
+  /// \brief Checkpoint number the containment state below refers to
+  public: uint8_t containCurrent{0};
+
+  /// \brief True if the entity was inside the room on the last update
+  public: bool contained{false};
+
+  /// \brief True if the checkpoint should be notified on the next test even
+  /// if the state didn't change
+  public: bool containNotify{false};
+
+  /// \brief Current checkpoint number, starting from 1.
+  /// Zero means no checkpoint.
+  public: uint8_t current{0};
+
+  /// \brief True once all checkpoints have been completed
+  public: bool complete{false};
+
+  /// \brief ROS node handle
+  public: std::unique_ptr<ros::NodeHandle> rosNode{nullptr};
+
+  /// \brief ROS new task service server
+  public: ros::ServiceServer newTaskRosService;
+
+  /// \brief ROS task info service server
+  public: ros::ServiceServer taskInfoRosService;
+
+  /// \brief ROS room info service server
+  public: ros::ServiceServer roomInfoRosService;
+
+  /// \brief ROS all room info service server
+  public: ros::ServiceServer allRoomInfoRosService;
+
+  /// \brief ROS point in room service server
+  public: ros::ServiceServer pointInRoomRosService;
+
+  /// \brief ROS seek checkpoint service server, only advertised when
+  /// enabled
+  public: ros::ServiceServer seekCheckpointRosService;
+
+  /// \brief Ignition transport node, to make the guest follow when seeking
+  public: ignition::transport::Node ignNode;
+
+  /// \brief Protects current, complete and the seek request between the
+  /// ROS services and Update
+  public: std::mutex seekMutex;
+
+  /// \brief Notified when Update handled the seek request
+  public: std::condition_variable seekDone;
+
+  /// \brief Checkpoint to jump to on the next update, zero for none
+  public: unsigned int seekTarget{0};
+
+  /// \brief True if the last seek request reached its checkpoint
+  public: bool seekResult{false};
+
+  /// \brief Thread Update was last called from
+  public: std::thread::id updateThread;
+
+  /// \brief ROS publisher for the score.
+  public: ros::Publisher scoreRosPub;
+
+  /// \brief Frequency in Hz to publish score message
+  public: double scoreFreq{50};
+
+  /// \brief Time the score was last published
+  public: gazebo::common::Time lastScorePub;
+
+  /// \brief Map with coordinates for every room's drop-off region
+  /// Room name - pair<min, max>
+  public: std::map<std::string, std::pair<ignition::math::Vector3d,
+                                          ignition::math::Vector3d>> roomInfo;
+
+  /// \brief Spatial index over roomInfo, for point queries
+  public: RoomIndex roomIndex;
+};
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+Competition::Competition()
+    : dataPtr(new CompetitionPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+Competition::~Competition()
+{
+}
+
+/////////////////////////////////////////////////
+bool Competition::Load(const sdf::ElementPtr &_sdf, const Locator &_locator,
+    const Placer &_placer)
+{
+  this->dataPtr->locator = _locator;
+  this->dataPtr->placer = _placer;
+
+  // Load general competition parameters
+  if (_sdf->HasElement("score_frequency"))
+    this->dataPtr->scoreFreq = _sdf->Get<double>("score_frequency");
+
+  if (!_sdf->HasElement("pick_up_location"))
+  {
+    gzerr << "Missing <pick_up_location>, competition not initialized"
+          << std::endl;
+    return false;
+  }
+  this->dataPtr->pickUpLocation = _sdf->Get<std::string>("pick_up_location");
+
+  if (!_sdf->HasElement("drop_off_location"))
+  {
+    gzerr << "Missing <drop_off_location>, competition not initialized"
+          << std::endl;
+    return false;
+  }
+  this->dataPtr->dropOffLocation = _sdf->Get<std::string>("drop_off_location");
+
+  if (!_sdf->HasElement("robot_start_pose"))
+  {
+    gzerr << "Missing <robot_start_pose>, competition not initialized"
+          << std::endl;
+    return false;
+  }
+  this->dataPtr->robotStartPose =
+      _sdf->Get<ignition::math::Pose3d>("robot_start_pose");
+
+  this->dataPtr->guestName = _sdf->Get<std::string>("guest_name");
+
+  if (!_sdf->HasElement("room_info"))
+  {
+    gzerr << "Missing <room_info>, competition not initialized"
+          << std::endl;
+    return false;
+  }
+
+  auto roomInfoElem = _sdf->GetElement("room_info");
+  while (roomInfoElem)
+  {
+    auto name = roomInfoElem->Get<std::string>("name");
+    auto min = roomInfoElem->Get<ignition::math::Vector3d>("min");
+    auto max = roomInfoElem->Get<ignition::math::Vector3d>("max");
+
+    this->dataPtr->roomInfo[name] = std::make_pair(min, max);
+    roomInfoElem = roomInfoElem->GetNextElement("room_info");
+  }
+  this->dataPtr->roomIndex.Build(this->dataPtr->roomInfo);
+
+  // Create checkpoints
+  {
+    std::unique_ptr<CP_GoToPickUp> cp(new CP_GoToPickUp(
+        _sdf->GetElement("go_to_pick_up")));
+    this->dataPtr->containCheckpoints.push_back(cp.get());
+    this->dataPtr->checkpoints.push_back(std::move(cp));
+  }
+
+  {
+    std::unique_ptr<CP_PickUp> cp(new CP_PickUp(
+        _sdf->GetElement("pick_up")));
+    this->dataPtr->containCheckpoints.push_back(nullptr);
+    this->dataPtr->checkpoints.push_back(std::move(cp));
+  }
+
+  {
+    std::unique_ptr<CP_DropOff> cp(new CP_DropOff(
+        _sdf->GetElement("drop_off")));
+    this->dataPtr->containCheckpoints.push_back(cp.get());
+    this->dataPtr->checkpoints.push_back(std::move(cp));
+  }
+
+  {
+    std::unique_ptr<CP_ReturnToStart> cp(new CP_ReturnToStart(
+        _sdf->GetElement("return_to_start")));
+    this->dataPtr->containCheckpoints.push_back(cp.get());
+    this->dataPtr->checkpoints.push_back(std::move(cp));
+  }
+
+  for (auto cp : this->dataPtr->containCheckpoints)
+  {
+    if (cp && this->dataPtr->roomInfo.find(cp->Room()) ==
+        this->dataPtr->roomInfo.end())
+    {
+      gzerr << "Unknown room [" << cp->Room() << "] for checkpoint ["
+            << cp->Name() << "]" << std::endl;
+    }
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Competition::Advertise()
+{
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM("A ROS node for Gazebo has not been initialized,"
+        << "unable to load plugin. Load the Gazebo system plugin "
+        << "'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return false;
+  }
+
+  this->dataPtr->rosNode.reset(new ros::NodeHandle());
+
+  // Advertise new task service
+  this->dataPtr->newTaskRosService = this->dataPtr->rosNode->advertiseService(
+      "/servicesim/new_task", &Competition::OnNewTaskRosService, this);
+
+  // Advertise task info service
+  this->dataPtr->taskInfoRosService = this->dataPtr->rosNode->advertiseService(
+      "/servicesim/task_info", &Competition::OnTaskInfoRosService, this);
+
+  // Advertise room info service
+  this->dataPtr->roomInfoRosService = this->dataPtr->rosNode->advertiseService(
+      "/servicesim/room_info", &Competition::OnRoomInfoRosService, this);
+
+  // Advertise all room info service
+  this->dataPtr->allRoomInfoRosService =
+      this->dataPtr->rosNode->advertiseService("/servicesim/all_room_info",
+      &Competition::OnAllRoomInfoRosService, this);
+
+  // Advertise point in room service
+  this->dataPtr->pointInRoomRosService =
+      this->dataPtr->rosNode->advertiseService("/servicesim/point_in_room",
+      &Competition::OnPointInRoomRosService, this);
+
+  // Seeking skips parts of the task, so it's only for tests and benchmarks
+  bool enableSeek{false};
+  this->dataPtr->rosNode->param("/servicesim/enable_seek", enableSeek, false);
+  if (enableSeek)
+  {
+    this->dataPtr->seekCheckpointRosService =
+        this->dataPtr->rosNode->advertiseService(
+        "/servicesim/seek_checkpoint",
+        &Competition::OnSeekCheckpointRosService, this);
+
+    gzmsg << "[ServiceSim] Checkpoint seeking enabled" << std::endl;
+  }
+
+  // Advertise score messages
+  this->dataPtr->scoreRosPub =
+      this->dataPtr->rosNode->advertise<servicesim_competition::Score>(
+      "/servicesim/score", 1000);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Competition::OnNewTaskRosService(
+    servicesim_competition::NewTask::Request &_req,
+    servicesim_competition::NewTask::Response &_res)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->seekMutex);
+
+    if (this->dataPtr->current != 0)
+    {
+      gzerr << "Competition is already running." << std::endl;
+      return false;
+    }
+
+    // Start checkpoint
+    this->dataPtr->current = 1;
+    this->dataPtr->checkpoints[this->dataPtr->current - 1]->Start();
+  }
+
+  // Respond
+  _res.pick_up_location = this->dataPtr->pickUpLocation;
+  _res.drop_off_location = this->dataPtr->dropOffLocation;
+  _res.guest_name = this->dataPtr->guestName;
+  _res.robot_start_pose = convert(this->dataPtr->robotStartPose);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Competition::OnTaskInfoRosService(
+    servicesim_competition::TaskInfo::Request &_req,
+    servicesim_competition::TaskInfo::Response &_res)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->seekMutex);
+
+    if (this->dataPtr->current == 0)
+    {
+      gzerr << "Competition has not been started yet."
+            << " Please call `/servicesim/new_task`"
+            <<   "service to start the competition." << std::endl;
+
+      return false;
+    }
+  }
+
+  // Respond
+  _res.pick_up_location = this->dataPtr->pickUpLocation;
+  _res.drop_off_location = this->dataPtr->dropOffLocation;
+  _res.guest_name = this->dataPtr->guestName;
+  _res.robot_start_pose = convert(this->dataPtr->robotStartPose);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Competition::OnRoomInfoRosService(
+    servicesim_competition::RoomInfo::Request &_req,
+    servicesim_competition::RoomInfo::Response &_res)
+{
+  auto room = this->dataPtr->roomInfo.find(_req.name);
+  if (room == this->dataPtr->roomInfo.end())
+  {
+    gzwarn << "Unknown room [" << _req.name << "]" << std::endl;
+    return false;
+  }
+
+  _res.min = convert(room->second.first);
+  _res.max = convert(room->second.second);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Competition::OnAllRoomInfoRosService(
+    servicesim_competition::AllRoomInfo::Request &/*_req*/,
+    servicesim_competition::AllRoomInfo::Response &_res)
+{
+  _res.rooms.resize(this->dataPtr->roomInfo.size());
+
+  size_t i{0};
+  for (const auto &room : this->dataPtr->roomInfo)
+  {
+    _res.rooms[i].name = room.first;
+    _res.rooms[i].min = convert(room.second.first);
+    _res.rooms[i].max = convert(room.second.second);
+    ++i;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Competition::OnPointInRoomRosService(
+    servicesim_competition::PointInRoom::Request &_req,
+    servicesim_competition::PointInRoom::Response &_res)
+{
+  _res.names.resize(_req.points.size());
+
+  for (size_t i = 0; i < _req.points.size(); ++i)
+  {
+    const auto &point = _req.points[i];
+    _res.names[i] = this->dataPtr->roomIndex.RoomAt(
+        ignition::math::Vector3d(point.x, point.y, point.z));
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Competition::OnSeekCheckpointRosService(
+    servicesim_competition::SeekCheckpoint::Request &_req,
+    servicesim_competition::SeekCheckpoint::Response &_res)
+{
+  _res.success = false;
+
+  unsigned int target = _req.checkpoint;
+  auto &checkpoints = this->dataPtr->checkpoints;
+
+  if (target < 1 || target > checkpoints.size())
+  {
+    gzerr << "Can't seek to checkpoint [" << target << "], it should be from 1"
+          << " to " << checkpoints.size() << std::endl;
+    return true;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->seekMutex);
+
+    if (this->dataPtr->complete)
+    {
+      gzerr << "Can't seek, the competition is already complete."
+            << std::endl;
+      return true;
+    }
+
+    // Completed checkpoints can't be undone
+    unsigned int current = this->dataPtr->current;
+    if (target < current)
+    {
+      gzerr << "Can't seek back to checkpoint [" << target
+            << "] from checkpoint [" << current << "]" << std::endl;
+      return true;
+    }
+  }
+
+  // Place models first, so rooms and the guest's pick-up radius are tested
+  // against the new poses
+  if ((_req.place_robot || _req.place_guest) && !this->dataPtr->placer)
+  {
+    gzerr << "Can't place models in this simulator." << std::endl;
+    return true;
+  }
+
+  if (_req.place_robot &&
+      !this->dataPtr->placer(_req.robot_name, convert(_req.robot_pose)))
+  {
+    gzerr << "Failed to place robot [" << _req.robot_name << "]" << std::endl;
+    return true;
+  }
+
+  if (_req.place_guest && !this->dataPtr->placer(this->dataPtr->guestName,
+      convert(_req.guest_pose)))
+  {
+    gzerr << "Failed to place guest [" << this->dataPtr->guestName << "]"
+          << std::endl;
+    return true;
+  }
+
+  // The guest only follows the robot while being taken to the drop-off.
+  // This is done before changing checkpoints, which are left untouched if it
+  // fails.
+  auto service = "/servicesim/" + this->dataPtr->guestName;
+  ignition::msgs::Boolean rep;
+  bool result{false};
+  if (dynamic_cast<CP_DropOff *>(checkpoints[target - 1].get()))
+  {
+    ignition::msgs::StringMsg req;
+    req.set_data(_req.robot_name);
+
+    if (!this->dataPtr->ignNode.Request(service + "/follow", req, 500, rep,
+        result) || !result || !rep.data())
+    {
+      gzerr << "Guest [" << this->dataPtr->guestName
+            << "] didn't follow robot [" << _req.robot_name
+            << "], it should be placed within the pick-up radius" << std::endl;
+      return true;
+    }
+  }
+  // Fails if the guest wasn't following anyway
+  else
+  {
+    this->dataPtr->ignNode.Request(service + "/unfollow", 500, rep, result);
+  }
+
+  // Checkpoints are changed on the simulator's thread at the start of its
+  // next update, which is waited for
+  std::unique_lock<std::mutex> lock(this->dataPtr->seekMutex);
+  this->dataPtr->seekTarget = target;
+  this->dataPtr->seekResult = false;
+
+  // servicesim_2d serves ROS between updates, on the same thread
+  if (std::this_thread::get_id() == this->dataPtr->updateThread)
+  {
+    this->ApplySeek();
+  }
+  else if (!this->dataPtr->seekDone.wait_for(lock, std::chrono::seconds(5),
+      [this] {return this->dataPtr->seekTarget == 0;}))
+  {
+    this->dataPtr->seekTarget = 0;
+    gzerr << "Can't seek to checkpoint [" << target << "], the simulation "
+          << "isn't running" << std::endl;
+    return true;
+  }
+
+  _res.success = this->dataPtr->seekResult;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void Competition::ApplySeek()
+{
+  unsigned int target = this->dataPtr->seekTarget;
+  if (target == 0)
+    return;
+
+  this->dataPtr->seekTarget = 0;
+  this->dataPtr->seekDone.notify_all();
+
+  // The task may have moved on since the request was accepted
+  unsigned int current = this->dataPtr->current;
+  if (this->dataPtr->complete || target < current)
+  {
+    gzerr << "Can't seek to checkpoint [" << target
+          << "], the competition moved past it" << std::endl;
+    return;
+  }
+
+  // Complete earlier checkpoints, and let them clean up since they won't be
+  // checked again
+  auto &checkpoints = this->dataPtr->checkpoints;
+  for (auto i = std::max(current, 1u); i < target; ++i)
+  {
+    checkpoints[i - 1]->Skip();
+    checkpoints[i - 1]->Check();
+  }
+
+  if (current != target)
+  {
+    this->dataPtr->current = target;
+    checkpoints[target - 1]->Start();
+  }
+
+  this->dataPtr->seekResult = true;
+
+  gzmsg << "[ServiceSim] Jumped to checkpoint \""
+        << checkpoints[target - 1]->Name() << "\"" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void Competition::CheckContain()
+{
+  auto current = this->dataPtr->current;
+
+  // Checkpoint changed, notify the new checkpoint on its first test, since
+  // the state may have changed while it wasn't being tested
+  if (this->dataPtr->containCurrent != current)
+  {
+    this->dataPtr->containCurrent = current;
+    this->dataPtr->containNotify = true;
+  }
+
+  auto cp = this->dataPtr->containCheckpoints[current - 1];
+  if (!cp)
+    return;
+
+  auto room = this->dataPtr->roomInfo.find(cp->Room());
+  if (room == this->dataPtr->roomInfo.end())
+    return;
+
+  // The robot may be inserted after the competition starts
+  ignition::math::Vector3d pos;
+  if (!this->dataPtr->locator || !this->dataPtr->locator(cp->Entity(), pos))
+    return;
+
+  // Rooms are flat boxes, so only X and Y are tested
+  const auto &min = room->second.first;
+  const auto &max = room->second.second;
+  bool contained =
+      pos.X() >= std::min(min.X(), max.X()) &&
+      pos.X() <= std::max(min.X(), max.X()) &&
+      pos.Y() >= std::min(min.Y(), max.Y()) &&
+      pos.Y() <= std::max(min.Y(), max.Y());
+
+  if (this->dataPtr->containNotify || contained != this->dataPtr->contained)
+    cp->OnContain(contained);
+
+  this->dataPtr->containNotify = false;
+  this->dataPtr->contained = contained;
+}
+
+/////////////////////////////////////////////////
+void Competition::Update(const gazebo::common::Time &_simTime,
+    const double _penalty)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->seekMutex);
+  this->dataPtr->updateThread = std::this_thread::get_id();
+
+  this->ApplySeek();
+
+  if (this->dataPtr->current == 0)
+    return;
+
+  // Test whether the entity entered or left the current checkpoint's room
+  this->CheckContain();
+
+  // If current checkpoint is complete
+  if (this->dataPtr->checkpoints[this->dataPtr->current - 1]->Check())
+  {
+    // Next checkpoint
+    this->dataPtr->current++;
+
+    // Check if competition complete
+    if (this->dataPtr->current > this->dataPtr->checkpoints.size())
+    {
+      gzmsg << "[ServiceSim] Competition complete!" << std::endl;
+      this->dataPtr->current = 0;
+      this->dataPtr->complete = true;
+    }
+    else
+    {
+      this->dataPtr->checkpoints[this->dataPtr->current - 1]->Start();
+    }
+  }
+
+  // If current checkpoint is paused, go back to previous one
+  if (this->dataPtr->current > 0 &&
+      this->dataPtr->checkpoints[this->dataPtr->current - 1]->Paused())
+  {
+    // Previous checkpoint
+    this->dataPtr->current--;
+
+    if (this->dataPtr->current > 0)
+      this->dataPtr->checkpoints[this->dataPtr->current - 1]->Start();
+  }
+
+  // Publish ROS score message, starting over if time went backwards
+  if (_simTime < this->dataPtr->lastScorePub)
+    this->dataPtr->lastScorePub = _simTime;
+
+  if (_simTime - this->dataPtr->lastScorePub < 1/this->dataPtr->scoreFreq)
+    return;
+
+  servicesim_competition::Score msg;
+  msg.score = this->Score(_penalty);
+
+  this->dataPtr->scoreRosPub.publish(msg);
+  this->dataPtr->lastScorePub = _simTime;
+}
+
+/////////////////////////////////////////////////
+double Competition::Score(const double _penalty) const
+{
+  double total{0.0};
+  for (const auto &cp : this->dataPtr->checkpoints)
+    total += cp->Score();
+
+  return total + _penalty;
+}
+
+/////////////////////////////////////////////////
+bool Competition::Running() const
+{
+  return this->dataPtr->current != 0;
+}
+
+/////////////////////////////////////////////////
+bool Competition::Complete() const
+{
+  return this->dataPtr->complete;
+}
+
+/////////////////////////////////////////////////
+std::string Competition::GuestName() const
+{
+  return this->dataPtr->guestName;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d Competition::RobotStartPose() const
+{
+  return this->dataPtr->robotStartPose;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_COMPETITION_HH_
+#define SERVICESIM_COMPETITION_HH_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include <sdf/sdf.hh>
+#include <gazebo/common/Time.hh>
+
+#include <servicesim_competition/AllRoomInfo.h>
+#include <servicesim_competition/NewTask.h>
+#include <servicesim_competition/PointInRoom.h>
+#include <servicesim_competition/RoomInfo.h>
+#include <servicesim_competition/SeekCheckpoint.h>
+#include <servicesim_competition/TaskInfo.h>
+
+namespace servicesim
+{
+  class CompetitionPrivate;
+
+  /// \brief The competition task, independent from the simulator running
+  /// it: checkpoints, scoring, rooms and the /servicesim ROS interface.
+  ///
+  /// It's driven by the CompetitionPlugin in Gazebo and by the servicesim_2d
+  /// simulator, which both set the checkpoints' clock, give entity positions
+  /// through a locator and call Update once per step.
+  ///
+  /// When the /servicesim/enable_seek ROS parameter is true, the
+  /// /servicesim/seek_checkpoint service jumps straight to a checkpoint, for
+  /// tests and benchmarks which don't need to go through the earlier ones.
+  /// The jump happens on the next Update, which the service waits for.
+  class Competition
+  {
+    /// \brief Finds an entity's position in the world.
+    /// The first parameter is the entity name, the second is set to its
+    /// position. Returns false if the entity doesn't exist, such as a robot
+    /// which hasn't been inserted yet.
+    public: using Locator = std::function<bool(const std::string &,
+        ignition::math::Vector3d &)>;
+
+    /// \brief Moves an entity to a world pose when seeking to a checkpoint.
+    /// The first parameter is the entity name, the second is its new pose.
+    /// Returns false if the entity doesn't exist.
+    public: using Placer = std::function<bool(const std::string &,
+        const ignition::math::Pose3d &)>;
+
+    /// \brief Constructor
+    public: Competition();
+
+    /// \brief Destructor
+    public: ~Competition();
+
+    /// \brief Load the task and create the checkpoints.
+    /// \param[in] _sdf The CompetitionPlugin's SDF element.
+    /// \param[in] _locator Finds entities tested against rooms.
+    /// \param[in] _placer Moves entities when seeking to a checkpoint. May be
+    /// null if entities can't be moved.
+    /// \return False if a required element is missing.
+    public: bool Load(const sdf::ElementPtr &_sdf, const Locator &_locator,
+        const Placer &_placer);
+
+    /// \brief Advertise the ROS services and the score topic.
+    /// \return False if ROS hasn't been initialized.
+    public: bool Advertise();
+
+    /// \brief Move through checkpoints and publish the score.
+    /// \param[in] _simTime Current sim time.
+    /// \param[in] _penalty Penalty from contacts, added to the score.
+    public: void Update(const gazebo::common::Time &_simTime,
+        const double _penalty);
+
+    /// \brief Total score.
+    /// \param[in] _penalty Penalty from contacts.
+    /// \return Sum of all checkpoint scores and the penalty.
+    public: double Score(const double _penalty) const;
+
+    /// \brief Whether a task has been started and not finished yet.
+    /// \return True while running.
+    public: bool Running() const;
+
+    /// \brief Whether all checkpoints have been completed.
+    /// \return True once complete.
+    public: bool Complete() const;
+
+    /// \brief Get the guest's name.
+    /// \return Guest name.
+    public: std::string GuestName() const;
+
+    /// \brief Get the pose the robot starts at.
+    /// \return Start pose.
+    public: ignition::math::Pose3d RobotStartPose() const;
+
+    /// \brief Service when competitor asks to start competition.
+    /// \param[in] _req Competitor's request.
+    /// \param[out] _res Response containing information about the task.
+    /// \return False if failed.
+    private: bool OnNewTaskRosService(
+        servicesim_competition::NewTask::Request &_req,
+        servicesim_competition::NewTask::Response &_res);
+
+    /// \brief Service when competitor asks about task information.
+    /// \param[in] _req Competitor's request.
+    /// \param[out] _res Response containing information about the task.
+    /// \return False if failed.
+    private: bool OnTaskInfoRosService(
+        servicesim_competition::TaskInfo::Request &_req,
+        servicesim_competition::TaskInfo::Response &_res);
+
+    /// \brief Service when competitor asks information about a room.
+    /// \param[in] _req Competitor's request.
+    /// \param[out] _res Response containing information about the room.
+    /// \return False if failed.
+    private: bool OnRoomInfoRosService(
+        servicesim_competition::RoomInfo::Request &_req,
+        servicesim_competition::RoomInfo::Response &_res);
+
+    /// \brief Service when competitor asks information about all rooms.
+    /// \param[in] _req Competitor's request.
+    /// \param[out] _res Response containing information about all rooms.
+    /// \return False if failed.
+    private: bool OnAllRoomInfoRosService(
+        servicesim_competition::AllRoomInfo::Request &_req,
+        servicesim_competition::AllRoomInfo::Response &_res);
+
+    /// \brief Service when competitor asks which rooms points are in.
+    /// \param[in] _req Competitor's request.
+    /// \param[out] _res Response containing a room name per point.
+    /// \return False if failed.
+    private: bool OnPointInRoomRosService(
+        servicesim_competition::PointInRoom::Request &_req,
+        servicesim_competition::PointInRoom::Response &_res);
+
+    /// \brief Service to jump straight to a checkpoint, for tests.
+    /// \param[in] _req Request with the checkpoint and where to place models.
+    /// \param[out] _res Response telling whether the seek succeeded.
+    /// \return False if failed.
+    private: bool OnSeekCheckpointRosService(
+        servicesim_competition::SeekCheckpoint::Request &_req,
+        servicesim_competition::SeekCheckpoint::Response &_res);
+
+    /// \brief Jump to the checkpoint requested through the seek service, if
+    /// any. Called on the simulator's thread with seekMutex locked.
+    private: void ApplySeek();
+
+    /// \brief Test whether the current checkpoint's entity is inside its
+    /// room and notify the checkpoint when that changes.
+    private: void CheckContain();
+
+    /// \internal
+    private: std::unique_ptr<CompetitionPrivate> dataPtr;
+  };
+}
+#endif
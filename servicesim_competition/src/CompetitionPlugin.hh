@@ -24,14 +24,12 @@
 #include <gazebo/common/Plugin.hh>
 #include <gazebo/common/UpdateInfo.hh>
 
-#include <servicesim_competition/NewTask.h>
-#include <servicesim_competition/RoomInfo.h>
-#include <servicesim_competition/TaskInfo.h>
-
 namespace servicesim
 {
   class CompetitionPluginPrivate;
 
+  /// \brief Runs the competition in Gazebo. The task itself is in the
+  /// Competition class, shared with the servicesim_2d simulator.
   class CompetitionPlugin : public gazebo::WorldPlugin
   {
     // Documentation inherited
@@ -41,30 +39,6 @@ namespace servicesim
     public: void Load(gazebo::physics::WorldPtr _world, sdf::ElementPtr _sdf)
         override;
 
-    /// \brief Service when competitor asks to start competition.
-    /// \param[in] _req Competitor's request.
-    /// \param[out] _res Response containing information about the task.
-    /// \return False if failed.
-    private: bool OnNewTaskRosService(
-        servicesim_competition::NewTask::Request &_req,
-        servicesim_competition::NewTask::Response &_res);
-
-    /// \brief Service when competitor asks about task information.
-    /// \param[in] _req Competitor's request.
-    /// \param[out] _res Response containing information about the task.
-    /// \return False if failed.
-    private: bool OnTaskInfoRosService(
-        servicesim_competition::TaskInfo::Request &_req,
-        servicesim_competition::TaskInfo::Response &_res);
-
-    /// \brief Service when competitor asks information about a room.
-    /// \param[in] _req Competitor's request.
-    /// \param[out] _res Response containing information about the room.
-    /// \return False if failed.
-    private: bool OnRoomInfoRosService(
-        servicesim_competition::RoomInfo::Request &_req,
-        servicesim_competition::RoomInfo::Response &_res);
-
     /// \brief Update on world update begin
     /// \param[in] _info Update info
     private: void OnUpdate(const gazebo::common::UpdateInfo &_info);
@@ -22,13 +22,7 @@ geometry_msgs::Pose servicesim::convert(
     const ignition::math::Pose3d &_pose)
 {
   geometry_msgs::Pose msg;
-  msg.position.x = _pose.Pos().X();
-  msg.position.y = _pose.Pos().Y();
-  msg.position.z = _pose.Pos().Z();
-  msg.orientation.x = _pose.Rot().X();
-  msg.orientation.y = _pose.Rot().Y();
-  msg.orientation.z = _pose.Rot().Z();
-  msg.orientation.w = _pose.Rot().W();
+  convert(_pose, msg);
   return msg;
 }
 
@@ -43,3 +37,55 @@ geometry_msgs::Point servicesim::convert(
   return msg;
 }
 
+//////////////////////////////////////////////////
+ignition::math::Pose3d servicesim::convert(const geometry_msgs::Pose &_msg)
+{
+  return ignition::math::Pose3d(
+      _msg.position.x, _msg.position.y, _msg.position.z,
+      _msg.orientation.w, _msg.orientation.x, _msg.orientation.y,
+      _msg.orientation.z);
+}
+
+//////////////////////////////////////////////////
+void servicesim::convert(const ignition::math::Pose3d &_pose,
+    geometry_msgs::Pose &_msg)
+{
+  _msg.position.x = _pose.Pos().X();
+  _msg.position.y = _pose.Pos().Y();
+  _msg.position.z = _pose.Pos().Z();
+  _msg.orientation.x = _pose.Rot().X();
+  _msg.orientation.y = _pose.Rot().Y();
+  _msg.orientation.z = _pose.Rot().Z();
+  _msg.orientation.w = _pose.Rot().W();
+}
+
+//////////////////////////////////////////////////
+void servicesim::convert(const ignition::math::Vector3d &_linear,
+    const ignition::math::Vector3d &_angular, geometry_msgs::Twist &_msg)
+{
+  _msg.linear.x = _linear.X();
+  _msg.linear.y = _linear.Y();
+  _msg.linear.z = _linear.Z();
+  _msg.angular.x = _angular.X();
+  _msg.angular.y = _angular.Y();
+  _msg.angular.z = _angular.Z();
+}
+
+//////////////////////////////////////////////////
+void servicesim::convert(const std::vector<ignition::math::Pose3d> &_poses,
+    std::vector<geometry_msgs::Pose> &_msgs)
+{
+  _msgs.resize(_poses.size());
+  for (size_t i = 0; i < _poses.size(); ++i)
+    convert(_poses[i], _msgs[i]);
+}
+
+//////////////////////////////////////////////////
+void servicesim::convert(const std::vector<ignition::math::Vector3d> &_linear,
+    const std::vector<ignition::math::Vector3d> &_angular,
+    std::vector<geometry_msgs::Twist> &_msgs)
+{
+  _msgs.resize(_linear.size());
+  for (size_t i = 0; i < _linear.size() && i < _angular.size(); ++i)
+    convert(_linear[i], _angular[i], _msgs[i]);
+}
@@ -18,8 +18,11 @@
 #ifndef SERVICESIM_CONVERSIONS_HH_
 #define SERVICESIM_CONVERSIONS_HH_
 
+#include <vector>
+
 #include <geometry_msgs/Pose.h>
 #include <geometry_msgs/Point.h>
+#include <geometry_msgs/Twist.h>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 
@@ -34,5 +37,41 @@ namespace servicesim
   /// \param[in] _vec Ignition vector 3d to convert.
   /// \return ROS geometry pose message
   geometry_msgs::Point convert(const ignition::math::Vector3d &_vec);
+
+  /// \brief Return the equivalent Ignition pose
+  /// \param[in] _msg ROS geometry pose message to convert.
+  /// \return Ignition pose 3d
+  ignition::math::Pose3d convert(const geometry_msgs::Pose &_msg);
+
+  /// \brief Fill an existing ROS message, avoiding a copy
+  /// \param[in] _pose Ignition pose 3d to convert.
+  /// \param[out] _msg ROS geometry pose message to be filled
+  void convert(const ignition::math::Pose3d &_pose,
+      geometry_msgs::Pose &_msg);
+
+  /// \brief Fill an existing ROS message, avoiding a copy
+  /// \param[in] _linear Linear velocity.
+  /// \param[in] _angular Angular velocity.
+  /// \param[out] _msg ROS geometry twist message to be filled
+  void convert(const ignition::math::Vector3d &_linear,
+      const ignition::math::Vector3d &_angular, geometry_msgs::Twist &_msg);
+
+  /// \brief Convert an array of poses into an existing array of ROS
+  /// messages. The output is resized as needed, so its memory can be reused
+  /// across calls.
+  /// \param[in] _poses Ignition poses to convert.
+  /// \param[out] _msgs ROS geometry pose messages to be filled
+  void convert(const std::vector<ignition::math::Pose3d> &_poses,
+      std::vector<geometry_msgs::Pose> &_msgs);
+
+  /// \brief Convert arrays of linear and angular velocities into an existing
+  /// array of ROS messages. The output is resized as needed, so its memory
+  /// can be reused across calls.
+  /// \param[in] _linear Linear velocities.
+  /// \param[in] _angular Angular velocities, same size as _linear.
+  /// \param[out] _msgs ROS geometry twist messages to be filled
+  void convert(const std::vector<ignition::math::Vector3d> &_linear,
+      const std::vector<ignition::math::Vector3d> &_angular,
+      std::vector<geometry_msgs::Twist> &_msgs);
 }
 #endif
@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/math/Box.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/physics.hh>
+#include <gazebo/sensors/SensorsIface.hh>
+#include <gazebo/sensors/Sensor.hh>
+
+#include <ros/ros.h>
+#include <sensor_msgs/LaserScan.h>
+
+#include "CpuLidarPlugin.hh"
+#include "LidarRaycaster.hh"
+#include "LoadProfiler.hh"
+#include "ModelTracker.hh"
+#include "RandomStream.hh"
+#include "StaticGeometry.hh"
+
+/////////////////////////////////////////////////
+class servicesim::CpuLidarPluginPrivate
+{
+  /// \brief Model the lidar is on
+  public: gazebo::physics::ModelPtr model;
+
+  /// \brief Link the lidar is attached to
+  public: gazebo::physics::LinkPtr link;
+
+  /// \brief Pointer to the world
+  public: gazebo::physics::WorldPtr world;
+
+  /// \brief Connection to world update
+  public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+  /// \brief ROS node handle
+  public: std::unique_ptr<ros::NodeHandle> rosNode{nullptr};
+
+  /// \brief Scan publisher
+  public: ros::Publisher rosPub;
+
+  /// \brief Message reused across publications
+  public: sensor_msgs::LaserScan msg;
+
+  /// \brief Casts rays against the flattened world
+  public: LidarRaycaster raycaster;
+
+  /// \brief Lidar pose relative to the link
+  public: ignition::math::Pose3d offset;
+
+  /// \brief Name of the sensor to deactivate, empty once done
+  public: std::string sensorName;
+
+  /// \brief Number of rays
+  public: unsigned int samples{640};
+
+  /// \brief Angle of the first ray
+  public: double minAngle{-IGN_PI * 0.5};
+
+  /// \brief Angle of the last ray
+  public: double maxAngle{IGN_PI * 0.5};
+
+  /// \brief Hits closer than this are ignored
+  public: double minRange{0.1};
+
+  /// \brief Maximum range
+  public: double maxRange{30.0};
+
+  /// \brief Noise standard deviation
+  public: double noise{0.0};
+
+  /// \brief Random numbers for noise
+  public: RandomStream random;
+
+  /// \brief Radius of actors' circles
+  public: double actorRadius{0.25};
+
+  /// \brief Threads to cast rays with
+  public: unsigned int threads{1};
+
+  /// \brief Time between scans
+  public: double updatePeriod{0.1};
+
+  /// \brief Time of the last scan
+  public: gazebo::common::Time lastUpdate;
+
+  /// \brief Tells when models were inserted or removed
+  public: ModelTracker models;
+
+  /// \brief Number of scans computed
+  public: unsigned int scanCount{0};
+
+  /// \brief Total wall time spent computing scans, in milliseconds
+  public: double scanTime{0.0};
+};
+
+using namespace servicesim;
+GZ_REGISTER_MODEL_PLUGIN(servicesim::CpuLidarPlugin)
+
+/////////////////////////////////////////////////
+CpuLidarPlugin::CpuLidarPlugin()
+    : dataPtr(new CpuLidarPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+CpuLidarPlugin::~CpuLidarPlugin()
+{
+  if (this->dataPtr->scanCount > 0)
+  {
+    gzmsg << "[ServiceSim] CPU lidar computed " << this->dataPtr->scanCount
+          << " scans, average "
+          << this->dataPtr->scanTime / this->dataPtr->scanCount
+          << " ms per scan" << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void CpuLidarPlugin::Load(gazebo::physics::ModelPtr _model,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("CpuLidarPlugin::Load", "plugin", _model->GetName());
+
+  this->dataPtr->model = _model;
+  this->dataPtr->world = _model->GetWorld();
+  this->dataPtr->random.SetName("CpuLidarPlugin/" + _model->GetName());
+
+  std::string ns = _model->GetName();
+  if (_sdf->HasElement("robotNamespace"))
+    ns = _sdf->Get<std::string>("robotNamespace");
+
+  // ROS transport
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM("A ROS node for Gazebo has not been initialized,"
+        << "unable to load plugin. Load the Gazebo system plugin "
+        << "'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  // Only replace the regular sensor when asked to
+  bool enabled{false};
+  ros::param::param<bool>("/" + ns + "/cpu_lidar", enabled, false);
+  if (!enabled)
+    return;
+
+  // Fixed joints are lumped into their parent link, so fall back to the
+  // canonical link
+  if (_sdf->HasElement("linkName"))
+  {
+    auto linkName = _sdf->Get<std::string>("linkName");
+    this->dataPtr->link = _model->GetLink(linkName);
+    if (!this->dataPtr->link)
+    {
+      gzwarn << "Link [" << linkName << "] not found, using the canonical "
+             << "link." << std::endl;
+    }
+  }
+
+  if (!this->dataPtr->link)
+    this->dataPtr->link = _model->GetLink();
+
+  if (!this->dataPtr->link)
+  {
+    gzerr << "Model has no links, CPU lidar not loaded." << std::endl;
+    return;
+  }
+
+  if (_sdf->HasElement("offset"))
+    this->dataPtr->offset = _sdf->Get<ignition::math::Pose3d>("offset");
+
+  if (_sdf->HasElement("sensorName"))
+    this->dataPtr->sensorName = _sdf->Get<std::string>("sensorName");
+
+  if (_sdf->HasElement("updateRate"))
+  {
+    auto rate = _sdf->Get<double>("updateRate");
+    if (rate > 0)
+      this->dataPtr->updatePeriod = 1.0 / rate;
+  }
+
+  if (_sdf->HasElement("samples"))
+  {
+    this->dataPtr->samples =
+        std::max(1u, _sdf->Get<unsigned int>("samples"));
+  }
+
+  if (_sdf->HasElement("minAngle"))
+    this->dataPtr->minAngle = _sdf->Get<double>("minAngle");
+
+  if (_sdf->HasElement("maxAngle"))
+    this->dataPtr->maxAngle = _sdf->Get<double>("maxAngle");
+
+  if (_sdf->HasElement("minRange"))
+    this->dataPtr->minRange = _sdf->Get<double>("minRange");
+
+  if (_sdf->HasElement("maxRange"))
+    this->dataPtr->maxRange = _sdf->Get<double>("maxRange");
+
+  if (_sdf->HasElement("gaussianNoise"))
+    this->dataPtr->noise = _sdf->Get<double>("gaussianNoise");
+
+  if (_sdf->HasElement("actorRadius"))
+    this->dataPtr->actorRadius = _sdf->Get<double>("actorRadius");
+
+  this->dataPtr->threads =
+      std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+  if (_sdf->HasElement("threads"))
+  {
+    this->dataPtr->threads =
+        std::max(1u, _sdf->Get<unsigned int>("threads"));
+  }
+
+  std::string topic{"scan"};
+  if (_sdf->HasElement("topicName"))
+    topic = _sdf->Get<std::string>("topicName");
+
+  std::string frame{"lidar_frame"};
+  if (_sdf->HasElement("frameName"))
+    frame = _sdf->Get<std::string>("frameName");
+  if (!frame.empty() && frame[0] == '/')
+    frame = frame.substr(1);
+
+  // Fields which don't change between scans
+  auto &msg = this->dataPtr->msg;
+  msg.header.frame_id = frame;
+  msg.angle_min = this->dataPtr->minAngle;
+  msg.angle_max = this->dataPtr->maxAngle;
+  msg.angle_increment = this->dataPtr->samples > 1 ?
+      (this->dataPtr->maxAngle - this->dataPtr->minAngle) /
+      (this->dataPtr->samples - 1) : 0.0;
+  msg.time_increment = 0;
+  msg.scan_time = 0;
+  msg.range_min = this->dataPtr->minRange;
+  msg.range_max = this->dataPtr->maxRange;
+  msg.ranges.resize(this->dataPtr->samples);
+  msg.intensities.assign(this->dataPtr->samples, 0.0f);
+
+  this->dataPtr->rosNode.reset(new ros::NodeHandle("/" + ns));
+  this->dataPtr->rosPub =
+      this->dataPtr->rosNode->advertise<sensor_msgs::LaserScan>(topic, 1);
+
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateBegin(
+      std::bind(&CpuLidarPlugin::OnUpdate, this));
+
+  gzmsg << "[ServiceSim] CPU lidar publishing on [/" << ns << "/" << topic
+        << "] with " << this->dataPtr->threads << " threads" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void CpuLidarPlugin::BuildStatic()
+{
+  flattenStaticModels(this->dataPtr->world, this->dataPtr->model,
+      this->dataPtr->raycaster);
+
+  gzmsg << "[ServiceSim] CPU lidar flattened static models into "
+        << this->dataPtr->raycaster.StaticSegmentCount() << " segments"
+        << std::endl;
+}
+
+/////////////////////////////////////////////////
+void CpuLidarPlugin::UpdateDynamic()
+{
+  auto &raycaster = this->dataPtr->raycaster;
+  raycaster.ClearDynamic();
+
+  for (const auto &model : this->dataPtr->world->Models())
+  {
+    if (model->IsStatic() || model == this->dataPtr->model)
+      continue;
+
+    // Actors are moved kinematically and their bounding boxes don't follow
+    // the skeleton, so a circle around their root at all heights is enough
+    if (boost::dynamic_pointer_cast<gazebo::physics::Actor>(model))
+    {
+      auto pos = model->WorldPose().Pos();
+      raycaster.AddDynamicCircle(pos.X(), pos.Y(),
+          this->dataPtr->actorRadius, std::numeric_limits<double>::lowest(),
+          std::numeric_limits<double>::max());
+      continue;
+    }
+
+    auto box = model->BoundingBox();
+    auto min = box.Min();
+    auto max = box.Max();
+    raycaster.AddDynamicSegment(min.X(), min.Y(), max.X(), min.Y(), min.Z(),
+        max.Z());
+    raycaster.AddDynamicSegment(max.X(), min.Y(), max.X(), max.Y(), min.Z(),
+        max.Z());
+    raycaster.AddDynamicSegment(max.X(), max.Y(), min.X(), max.Y(), min.Z(),
+        max.Z());
+    raycaster.AddDynamicSegment(min.X(), max.Y(), min.X(), min.Y(), min.Z(),
+        max.Z());
+  }
+}
+
+/////////////////////////////////////////////////
+void CpuLidarPlugin::OnUpdate()
+{
+  // Sensors are created after model plugins are loaded, so keep trying
+  if (!this->dataPtr->sensorName.empty())
+  {
+    auto sensor = gazebo::sensors::get_sensor(this->dataPtr->sensorName);
+    if (sensor)
+    {
+      sensor->SetActive(false);
+      gzmsg << "[ServiceSim] Deactivated sensor [" << sensor->ScopedName()
+            << "], replaced by the CPU lidar" << std::endl;
+      this->dataPtr->sensorName.clear();
+    }
+  }
+
+  auto simTime = this->dataPtr->world->SimTime();
+  auto dt = (simTime - this->dataPtr->lastUpdate).Double();
+
+  // Time went backwards, e.g. after a reset
+  if (dt < 0)
+  {
+    this->dataPtr->lastUpdate = simTime;
+    return;
+  }
+
+  if (dt < this->dataPtr->updatePeriod)
+    return;
+
+  this->dataPtr->lastUpdate = simTime;
+
+  if (this->dataPtr->rosPub.getNumSubscribers() == 0)
+    return;
+
+  auto start = std::chrono::steady_clock::now();
+
+  // Rebuild static geometry when models are inserted or removed, such as
+  // streamed furniture
+  if (this->dataPtr->models.Changed(this->dataPtr->world))
+    this->BuildStatic();
+
+  this->UpdateDynamic();
+
+  auto pose = this->dataPtr->offset + this->dataPtr->link->WorldPose();
+
+  auto &msg = this->dataPtr->msg;
+  this->dataPtr->raycaster.Scan(pose.Pos().X(), pose.Pos().Y(),
+      pose.Pos().Z(), pose.Rot().Yaw(), this->dataPtr->minAngle,
+      msg.angle_increment, this->dataPtr->minRange, this->dataPtr->maxRange,
+      this->dataPtr->threads, msg.ranges);
+
+  if (this->dataPtr->noise > 0)
+  {
+    for (auto &range : msg.ranges)
+    {
+      if (std::isinf(range))
+        continue;
+
+      range = ignition::math::clamp(static_cast<double>(range) +
+          this->dataPtr->random.DblNormal(0.0, this->dataPtr->noise),
+          this->dataPtr->minRange, this->dataPtr->maxRange);
+    }
+  }
+
+  msg.header.stamp.sec = simTime.sec;
+  msg.header.stamp.nsec = simTime.nsec;
+  this->dataPtr->rosPub.publish(msg);
+
+  this->dataPtr->scanTime += std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+  this->dataPtr->scanCount++;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_CPULIDARPLUGIN_HH_
+#define SERVICESIM_CPULIDARPLUGIN_HH_
+
+#include <memory>
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class CpuLidarPluginPrivate;
+
+  /// \brief A model plugin which publishes the same sensor_msgs/LaserScan as
+  /// gazebo_ros_gpu_laser, but computes it on the CPU so it works on hosts
+  /// without a GPU.
+  ///
+  /// At load, and again whenever models are inserted or removed, the
+  /// collisions of all static models are flattened into 2D segments which
+  /// keep their height range. Actors are added on every scan as circles and
+  /// other dynamic models as their bounding boxes. Rays are cast by a
+  /// LidarRaycaster, split between threads, without going through the
+  /// physics engine.
+  ///
+  /// The plugin is only active if the ROS parameter
+  /// /<robotNamespace>/cpu_lidar is true. In that case it also deactivates
+  /// the sensor given by <sensorName>, so there is a single scan publisher.
+  ///
+  /// The plugin has the following SDF description:
+  /// <robotNamespace>  ROS namespace, defaults to the model name.
+  /// <topicName>       Topic within the namespace, defaults to "scan".
+  /// <frameName>       Frame of the scan messages.
+  /// <linkName>        Link the lidar is attached to, defaults to the
+  ///                   model's canonical link.
+  /// <offset>          Pose of the lidar relative to the link.
+  /// <sensorName>      Name of the sensor to deactivate, optional.
+  /// <updateRate>      Scan frequency in Hz, defaults to 10.
+  /// <samples>         Number of rays, defaults to 640.
+  /// <minAngle>        Angle of the first ray in radians.
+  /// <maxAngle>        Angle of the last ray in radians.
+  /// <minRange>        Hits closer than this are ignored, defaults to 0.1.
+  /// <maxRange>        Maximum range, defaults to 30.
+  /// <gaussianNoise>   Standard deviation of noise added to ranges.
+  /// <actorRadius>     Radius of the circle standing for each actor,
+  ///                   defaults to 0.25.
+  /// <threads>         Number of threads to cast rays with, defaults to the
+  ///                   number of cores, up to 4.
+  class CpuLidarPlugin : public gazebo::ModelPlugin
+  {
+    /// \brief Constructor
+    public: CpuLidarPlugin();
+
+    /// \brief Destructor
+    public: ~CpuLidarPlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::ModelPtr _model, sdf::ElementPtr _sdf)
+        override;
+
+    /// \brief Flatten the collisions of all static models.
+    private: void BuildStatic();
+
+    /// \brief Add actors and other moving models.
+    private: void UpdateDynamic();
+
+    /// \brief Main loop
+    private: void OnUpdate();
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<CpuLidarPluginPrivate> dataPtr;
+  };
+}
+#endif
@@ -17,8 +17,8 @@
 
 #include <functional>
 
+#include <ignition/math/Helpers.hh>
 #include <ignition/math/Pose3.hh>
-#include <ignition/math/Rand.hh>
 #include <ignition/math/Vector3.hh>
 
 #include <ignition/msgs/boolean.pb.h>
@@ -30,6 +30,8 @@
 #include <gazebo/physics/physics.hh>
 
 #include "FollowActorPlugin.hh"
+#include "FollowBehavior.hh"
+#include "LoadProfiler.hh"
 
 #include <ros/ros.h>
 
@@ -41,23 +43,14 @@ class servicesim::FollowActorPluginPrivate
   /// \brief Pointer to the actor.
   public: gazebo::physics::ActorPtr actor{nullptr};
 
-  /// \brief Velocity of the actor
-  public: double velocity{0.8};
-
   /// \brief List of connections such as WorldUpdateBegin
   public: std::vector<gazebo::event::ConnectionPtr> connections;
 
   /// \brief Current target model to follow
   public: gazebo::physics::ModelPtr target{nullptr};
 
-  /// \brief Minimum distance in meters to keep away from target.
-  public: double minDistance{1.2};
-
-  /// \brief Maximum distance in meters to keep away from target.
-  public: double maxDistance{4};
-
-  /// \brief Radius around actor from where it can be picked up
-  public: double pickUpRadius{2};
+  /// \brief Walks after the target and decides when to drift
+  public: FollowBehavior behavior;
 
   /// \brief Margin by which to increase an obstacle's bounding box on every
   /// direction (2x per axis).
@@ -67,18 +60,9 @@ class servicesim::FollowActorPluginPrivate
   /// with the actor's walking animation.
   public: double animationFactor{5.1};
 
-  /// \brief Maximum angle when drifting
-  public: double maxDriftAngle{IGN_PI * 0.2};
-
-  /// \brief List of times when actor should drift away
-  public: std::vector<gazebo::common::Time> driftTimes;
-
   /// \brief Time of the last update.
   public: gazebo::common::Time lastUpdate;
 
-  /// \brief Time tolerance when checking drift time
-  public: gazebo::common::Time timeTolerance{0.5};
-
   /// \brief List of models to ignore when checking collisions.
   public: std::vector<std::string> ignoreModels;
 
@@ -88,6 +72,9 @@ class servicesim::FollowActorPluginPrivate
   /// \brief Publishes drift notifications
   public: ignition::transport::Node::Publisher driftIgnPub;
 
+  /// \brief Publishes the current follow target
+  public: ignition::transport::Node::Publisher followingIgnPub;
+
   /// \brief Namespace for Ignition transport communication:
   /// * /<namespace>/<actor_name>/follow
   /// * /<namespace>/<actor_name>/unfollow
@@ -114,29 +101,18 @@ FollowActorPlugin::FollowActorPlugin()
 void FollowActorPlugin::Load(gazebo::physics::ModelPtr _model,
     sdf::ElementPtr _sdf)
 {
+  LoadTimer timer("FollowActorPlugin::Load", "plugin", _model->GetName());
+
   this->dataPtr->actor =
       boost::dynamic_pointer_cast<gazebo::physics::Actor>(_model);
 
+  // Velocity, distances and drift times
+  this->dataPtr->behavior.Load(_sdf, _model->GetName());
+
   // Read in the namespace
   if (_sdf->HasElement("namespace"))
     this->dataPtr->ns = "/" + _sdf->Get<std::string>("namespace");
 
-  // Read in the velocity
-  if (_sdf->HasElement("velocity"))
-    this->dataPtr->velocity = _sdf->Get<double>("velocity");
-
-  // Read in the follow distance
-  if (_sdf->HasElement("min_distance"))
-    this->dataPtr->minDistance = _sdf->Get<double>("min_distance");
-
-  // Read in the follow distance
-  if (_sdf->HasElement("max_distance"))
-    this->dataPtr->maxDistance = _sdf->Get<double>("max_distance");
-
-  // Read in the pickup radius
-  if (_sdf->HasElement("pickup_radius"))
-    this->dataPtr->pickUpRadius = _sdf->Get<double>("pickup_radius");
-
   // Read in the obstacle margin
   if (_sdf->HasElement("obstacle_margin"))
     this->dataPtr->obstacleMargin = _sdf->Get<double>("obstacle_margin");
@@ -159,17 +135,6 @@ void FollowActorPlugin::Load(gazebo::physics::ModelPtr _model,
     }
   }
 
-  // Read in drift times
-  if (_sdf->HasElement("drift_time"))
-  {
-    auto driftElem = _sdf->GetElement("drift_time");
-    while (driftElem)
-    {
-      this->dataPtr->driftTimes.push_back(driftElem->Get<double>());
-      driftElem = driftElem->GetNextElement("drift_time");
-    }
-  }
-
   // Read in the animation name
   std::string animation{"animation"};
   if (_sdf->HasElement("animation"))
@@ -211,6 +176,12 @@ void FollowActorPlugin::Load(gazebo::physics::ModelPtr _model,
       this->dataPtr->ignNode.Advertise<ignition::msgs::UInt32>(
       this->dataPtr->ns + "/" + this->dataPtr->actor->GetName() + "/drift");
 
+  // Follow state publisher
+  this->dataPtr->followingIgnPub =
+      this->dataPtr->ignNode.Advertise<ignition::msgs::StringMsg>(
+      this->dataPtr->ns + "/" + this->dataPtr->actor->GetName() +
+      "/following");
+
   // Advertise drift cheat service
   this->dataPtr->driftService = this->dataPtr->rosNode.advertiseService(
       "/servicesim/drift", &FollowActorPlugin::OnDriftRosService, this);
@@ -225,10 +196,25 @@ void FollowActorPlugin::Reset()
           << "] stopped following target [" << this->dataPtr->target->GetName()
           << "]" << std::endl;
   }
-  this->dataPtr->target = nullptr;
+  this->SetTarget(nullptr);
   this->dataPtr->lastUpdate = gazebo::common::Time::Zero;
 }
 
+/////////////////////////////////////////////////
+void FollowActorPlugin::SetTarget(const gazebo::physics::ModelPtr &_target)
+{
+  if (this->dataPtr->target == _target)
+    return;
+
+  this->dataPtr->target = _target;
+
+  // Notify follow state
+  ignition::msgs::StringMsg msg;
+  if (_target)
+    msg.set_data(_target->GetName());
+  this->dataPtr->followingIgnPub.Publish(msg);
+}
+
 /////////////////////////////////////////////////
 bool FollowActorPlugin::ObstacleOnTheWay() const
 {
@@ -291,81 +277,45 @@ void FollowActorPlugin::OnUpdate(const gazebo::common::UpdateInfo &_info)
 //  if (this->ObstacleOnTheWay())
   //  return;
 
-  // Is it drift time?
-  gazebo::common::Time driftTime;
-  for (auto t : this->dataPtr->driftTimes)
-  {
-    double diff = abs((t - _info.simTime).Double());
-    if (diff <= this->dataPtr->timeTolerance.Double())
-    {
-      driftTime = t;
-      break;
-    }
-
-    if (t > _info.simTime)
-      break;
-  }
-
   // Current pose - actor is oriented Y-up and Z-front
   auto actorPose = this->dataPtr->actor->WorldPose();
-  auto zPos = actorPose.Pos().Z();
-
-  // Current target
-  auto targetPose = this->dataPtr->target->WorldPose();
 
-  // Direction to target
-  auto dir = targetPose.Pos() - actorPose.Pos();
-  dir.Z(0);
-
-  // Stop if too close to target
-  if (driftTime == gazebo::common::Time::Zero &&
-      dir.Length() <= this->dataPtr->minDistance)
-  {
-    return;
-  }
+  double yaw;
+  FollowBehavior::Drift drift;
+  bool moved = this->dataPtr->behavior.Update(_info.simTime.Double(), dt,
+      this->dataPtr->target->WorldPose().Pos(), this->dataPtr->driftFlag,
+      actorPose.Pos(), yaw, drift);
 
   // Stop following if too far from target
-  if (dir.Length() > this->dataPtr->maxDistance)
+  if (drift == FollowBehavior::TOO_FAR)
   {
     gzwarn << "Target [" << this->dataPtr->target->GetName()
            <<  "] too far, actor [" << this->dataPtr->actor->GetName()
            <<"] stopped following" << std::endl;
-    this->dataPtr->target = nullptr;
+    this->SetTarget(nullptr);
 
     // Publish drift notification
     // 1: target too far
     ignition::msgs::UInt32 msg;
-    msg.set_data(1);
+    msg.set_data(drift);
     this->dataPtr->driftIgnPub.Publish(msg);
-
-    return;
   }
-
-  dir.Normalize();
-
-  // Towards target
-  ignition::math::Angle yaw = atan2(dir.Y(), dir.X()) + IGN_PI_2;
-
-  // Drift
-  if (driftTime != gazebo::common::Time::Zero || this->dataPtr->driftFlag)
+  else if (drift == FollowBehavior::SCHEDULED)
   {
-    // Change direction a bit
-    yaw += ignition::math::Rand::DblUniform(-1, 1) *
-        this->dataPtr->maxDriftAngle;
-
     // Stop following
-    this->dataPtr->target = nullptr;
+    this->SetTarget(nullptr);
 
     // Notify
     // 2: drift time
     ignition::msgs::UInt32 msg;
-    msg.set_data(2);
+    msg.set_data(drift);
     this->dataPtr->driftIgnPub.Publish(msg);
 
     if (!this->dataPtr->driftFlag)
     {
       gzwarn << "Actor [" << this->dataPtr->actor->GetName()
-             <<  "] drifting due to scheduled time: " << driftTime << std::endl;
+             <<  "] drifting due to scheduled time: "
+             << this->dataPtr->behavior.DriftTime() << std::endl;
     }
     else
     {
@@ -373,13 +323,12 @@ void FollowActorPlugin::OnUpdate(const gazebo::common::UpdateInfo &_info)
              <<  "] drifted as requested! (cheat)" << std::endl;
       this->dataPtr->driftFlag = false;
     }
-    // Don't return yet, so the actor moves away
   }
-  yaw.Normalize();
 
-  actorPose.Pos() += dir * this->dataPtr->velocity * dt;
-  actorPose.Pos().Z(zPos);
-  actorPose.Rot() = ignition::math::Quaterniond(IGN_PI_2, 0, yaw.Radian());
+  if (!moved)
+    return;
+
+  actorPose.Rot() = ignition::math::Quaterniond(IGN_PI_2, 0, yaw + IGN_PI_2);
 
   // Distance traveled is used to coordinate motion with the walking
   // animation
@@ -412,13 +361,8 @@ void FollowActorPlugin::OnFollow(const ignition::msgs::StringMsg &_req,
   }
 
   // Check pickup radius
-  auto actorPos = this->dataPtr->actor->WorldPose().Pos();
-  auto targetPos = model->WorldPose().Pos();
-
-  auto posDiff = actorPos - targetPos;
-  posDiff.Z(0);
-
-  if (posDiff.Length() > this->dataPtr->pickUpRadius)
+  if (!this->dataPtr->behavior.InPickUpRadius(
+      this->dataPtr->actor->WorldPose().Pos(), model->WorldPose().Pos()))
   {
     gzwarn << "Target [" << model->GetName() <<  "] too far from actor ["
            << this->dataPtr->actor->GetName() <<"]" << std::endl;
@@ -428,7 +372,7 @@ void FollowActorPlugin::OnFollow(const ignition::msgs::StringMsg &_req,
   gzmsg << "Actor [" << this->dataPtr->actor->GetName()
         << "] is following target [" << targetName << "]" << std::endl;
 
-  this->dataPtr->target = model;
+  this->SetTarget(model);
   _res.set_data(true);
   _result = true;
 }
@@ -448,7 +392,7 @@ void FollowActorPlugin::OnUnfollow(ignition::msgs::Boolean &_res,
         << "] stopped following target [" << this->dataPtr->target->GetName()
         << "]" << std::endl;
 
-  this->dataPtr->target = nullptr;
+  this->SetTarget(nullptr);
 
   // Publish drift notification
   // 3: user requested
@@ -58,6 +58,12 @@ namespace servicesim
   ///              2: Scheduled drift time
   ///              3: User requested unfollow
   ///
+  /// Following publisher:
+  ///   * Use: Listen to changes of the follow target
+  ///   * Topic: /<namespace>/<actor_name>/following
+  ///   * Message: ignition.msgs.StringMsg with the target's name, empty when
+  ///              the actor stops following
+  ///
   /// ## SDF parameters
   ///
   /// <namespace>: Namespace for transport
@@ -112,6 +118,10 @@ namespace servicesim
     /// \brief When user requests reset.
     private: void Reset() override;
 
+    /// \brief Set a new follow target and notify listeners.
+    /// \param[in] _target New target, null to stop following.
+    private: void SetTarget(const gazebo::physics::ModelPtr &_target);
+
     /// \brief Checks if there is an obstacle on the way.
     /// \return True if there is
     private: bool ObstacleOnTheWay() const;
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+
+#include <ignition/math/Angle.hh>
+
+#include "FollowBehavior.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+void FollowBehavior::Load(const sdf::ElementPtr &_sdf,
+    const std::string &_name)
+{
+  // Each actor draws from its own stream, so runs are reproducible
+  this->random.SetName("FollowActorPlugin/" + _name);
+
+  // Read in the velocity
+  if (_sdf->HasElement("velocity"))
+    this->velocity = _sdf->Get<double>("velocity");
+
+  // Read in the follow distance
+  if (_sdf->HasElement("min_distance"))
+    this->minDistance = _sdf->Get<double>("min_distance");
+
+  // Read in the follow distance
+  if (_sdf->HasElement("max_distance"))
+    this->maxDistance = _sdf->Get<double>("max_distance");
+
+  // Read in the pickup radius
+  if (_sdf->HasElement("pickup_radius"))
+    this->pickUpRadius = _sdf->Get<double>("pickup_radius");
+
+  // Read in drift times
+  if (_sdf->HasElement("drift_time"))
+  {
+    auto driftElem = _sdf->GetElement("drift_time");
+    while (driftElem)
+    {
+      this->driftTimes.push_back(driftElem->Get<double>());
+      driftElem = driftElem->GetNextElement("drift_time");
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+bool FollowBehavior::InPickUpRadius(const ignition::math::Vector3d &_actor,
+    const ignition::math::Vector3d &_target) const
+{
+  auto posDiff = _actor - _target;
+  posDiff.Z(0);
+
+  return posDiff.Length() <= this->pickUpRadius;
+}
+
+/////////////////////////////////////////////////
+bool FollowBehavior::Update(const double _simTime, const double _dt,
+    const ignition::math::Vector3d &_target, const bool _forceDrift,
+    ignition::math::Vector3d &_pos, double &_yaw, Drift &_drift)
+{
+  _drift = NONE;
+
+  // Is it drift time?
+  double driftTime{0.0};
+  for (auto t : this->driftTimes)
+  {
+    if (std::abs(t - _simTime) <= this->timeTolerance)
+    {
+      driftTime = t;
+      break;
+    }
+
+    if (t > _simTime)
+      break;
+  }
+
+  // Direction to target
+  auto dir = _target - _pos;
+  dir.Z(0);
+
+  // Stop if too close to target
+  if (driftTime == 0.0 && dir.Length() <= this->minDistance)
+    return false;
+
+  // Stop following if too far from target
+  if (dir.Length() > this->maxDistance)
+  {
+    _drift = TOO_FAR;
+    return false;
+  }
+
+  dir.Normalize();
+
+  // Towards target
+  ignition::math::Angle yaw = std::atan2(dir.Y(), dir.X());
+
+  // Drift, changing direction a bit and stopping following, but still
+  // moving on this step so the actor walks away
+  if (driftTime != 0.0 || _forceDrift)
+  {
+    yaw += this->random.DblUniform(-1, 1) * this->maxDriftAngle;
+    _drift = SCHEDULED;
+
+    if (driftTime != 0.0)
+      this->driftTime = driftTime;
+  }
+  yaw.Normalize();
+
+  _pos += dir * this->velocity * _dt;
+  _yaw = yaw.Radian();
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+double FollowBehavior::DriftTime() const
+{
+  return this->driftTime;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_FOLLOWBEHAVIOR_HH_
+#define SERVICESIM_FOLLOWBEHAVIOR_HH_
+
+#include <string>
+#include <vector>
+
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Vector3.hh>
+#include <sdf/sdf.hh>
+
+#include "RandomStream.hh"
+
+namespace servicesim
+{
+  /// \brief How an actor walks after its follow target and when it drifts
+  /// away, without the actor itself. Shared by the FollowActorPlugin and the
+  /// servicesim_2d simulator, so both move the guest the same way.
+  ///
+  /// Reads the <velocity>, <min_distance>, <max_distance>, <pickup_radius>
+  /// and <drift_time> elements of the FollowActorPlugin's SDF.
+  class FollowBehavior
+  {
+    /// \brief Why the actor stopped following, with the codes published on
+    /// the drift topic
+    public: enum Drift
+    {
+      /// \brief Still following
+      NONE = 0,
+
+      /// \brief Target beyond <max_distance>
+      TOO_FAR = 1,
+
+      /// \brief Scheduled drift time, or drift requested through ROS
+      SCHEDULED = 2,
+
+      /// \brief Unfollow requested
+      REQUESTED = 3
+    };
+
+    /// \brief Load parameters.
+    /// \param[in] _sdf The FollowActorPlugin's SDF element.
+    /// \param[in] _name Actor name, which names the random stream drift
+    /// headings are drawn from.
+    public: void Load(const sdf::ElementPtr &_sdf, const std::string &_name);
+
+    /// \brief Whether a target is close enough to be followed.
+    /// \param[in] _actor Actor position.
+    /// \param[in] _target Target position.
+    /// \return True if within the pick-up radius on the XY plane.
+    public: bool InPickUpRadius(const ignition::math::Vector3d &_actor,
+        const ignition::math::Vector3d &_target) const;
+
+    /// \brief Walk one step after the target.
+    /// \param[in] _simTime Current sim time in seconds.
+    /// \param[in] _dt Time since the last step in seconds.
+    /// \param[in] _target Target position.
+    /// \param[in] _forceDrift True to drift away on this step.
+    /// \param[in,out] _pos Actor position, moved on the XY plane.
+    /// \param[out] _yaw Walking direction, set if the actor moved.
+    /// \param[out] _drift Why the actor stopped following, NONE if it
+    /// should keep following.
+    /// \return True if the actor moved.
+    public: bool Update(const double _simTime, const double _dt,
+        const ignition::math::Vector3d &_target, const bool _forceDrift,
+        ignition::math::Vector3d &_pos, double &_yaw, Drift &_drift);
+
+    /// \brief Scheduled time of the latest drift.
+    /// \return Time in seconds, zero if the actor never drifted on schedule.
+    public: double DriftTime() const;
+
+    /// \brief Velocity of the actor
+    private: double velocity{0.8};
+
+    /// \brief Minimum distance in meters to keep away from target.
+    private: double minDistance{1.2};
+
+    /// \brief Maximum distance in meters to keep away from target.
+    private: double maxDistance{4};
+
+    /// \brief Radius around actor from where it can be picked up
+    private: double pickUpRadius{2};
+
+    /// \brief Maximum angle when drifting
+    private: double maxDriftAngle{IGN_PI * 0.2};
+
+    /// \brief Times in seconds when the actor should drift away, in order
+    private: std::vector<double> driftTimes;
+
+    /// \brief Time tolerance when checking drift time
+    private: double timeTolerance{0.5};
+
+    /// \brief Scheduled time of the latest drift
+    private: double driftTime{0.0};
+
+    /// \brief Random numbers for drift headings
+    private: RandomStream random;
+  };
+}
+#endif
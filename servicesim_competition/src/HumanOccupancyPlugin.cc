@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/Actor.hh>
+#include <gazebo/physics/Model.hh>
+#include <gazebo/physics/World.hh>
+
+#include <nav_msgs/OccupancyGrid.h>
+#include <ros/ros.h>
+
+#include "HumanOccupancyPlugin.hh"
+#include "LoadProfiler.hh"
+#include "ModelTracker.hh"
+
+/////////////////////////////////////////////////
+class servicesim::HumanOccupancyPluginPrivate
+{
+  /// \brief Pointer to the world
+  public: gazebo::physics::WorldPtr world;
+
+  /// \brief Connection to world update
+  public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+  /// \brief ROS node handle
+  public: std::unique_ptr<ros::NodeHandle> rosNode{nullptr};
+
+  /// \brief Publishes the grid
+  public: ros::Publisher rosPub;
+
+  /// \brief Grid reused across publications
+  public: nav_msgs::OccupancyGrid msg;
+
+  /// \brief Indices of the cells stamped since the last clear
+  public: std::vector<uint32_t> stamped;
+
+  /// \brief Robot name
+  public: std::string robotName;
+
+  /// \brief All actors
+  public: std::vector<gazebo::physics::ModelPtr> actors;
+
+  /// \brief Actor positions on the previous update
+  public: std::vector<ignition::math::Vector3d> lastPositions;
+
+  /// \brief Tells when models were inserted or removed
+  public: ModelTracker models;
+
+  /// \brief Cell side length
+  public: double resolution{0.05};
+
+  /// \brief Window side length
+  public: double size{10.0};
+
+  /// \brief Distance from the window's center at which it's moved
+  public: double recenterDistance{2.5};
+
+  /// \brief Radius of each actor's disc
+  public: double actorRadius{0.25};
+
+  /// \brief Time to project actors' motion, zero to disable
+  public: double velocityHorizon{0.0};
+
+  /// \brief Cell value for projected motion
+  public: int8_t velocityCost{50};
+
+  /// \brief True once the window has been placed
+  public: bool centered{false};
+
+  /// \brief Window center on the plane, X
+  public: double centerX{0.0};
+
+  /// \brief Window center on the plane, Y
+  public: double centerY{0.0};
+
+  /// \brief Time between publications
+  public: double updatePeriod{0.2};
+
+  /// \brief Time of the last update
+  public: gazebo::common::Time lastUpdate;
+};
+
+using namespace servicesim;
+GZ_REGISTER_WORLD_PLUGIN(servicesim::HumanOccupancyPlugin)
+
+/// \brief Value of cells occupied by an actor
+static const int8_t kOccupied = 100;
+
+/////////////////////////////////////////////////
+HumanOccupancyPlugin::HumanOccupancyPlugin()
+    : dataPtr(new HumanOccupancyPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+void HumanOccupancyPlugin::Load(gazebo::physics::WorldPtr _world,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("HumanOccupancyPlugin::Load", "plugin");
+
+  this->dataPtr->world = _world;
+
+  std::string topic{"/servicesim/human_occupancy"};
+  if (_sdf->HasElement("topic"))
+    topic = _sdf->Get<std::string>("topic");
+
+  this->dataPtr->msg.header.frame_id = "map";
+  if (_sdf->HasElement("frame"))
+    this->dataPtr->msg.header.frame_id = _sdf->Get<std::string>("frame");
+
+  if (_sdf->HasElement("update_rate"))
+  {
+    auto rate = _sdf->Get<double>("update_rate");
+    if (rate > 0)
+      this->dataPtr->updatePeriod = 1.0 / rate;
+  }
+
+  if (_sdf->HasElement("robot_name"))
+    this->dataPtr->robotName = _sdf->Get<std::string>("robot_name");
+
+  if (_sdf->HasElement("resolution"))
+  {
+    auto resolution = _sdf->Get<double>("resolution");
+    if (resolution > 0)
+      this->dataPtr->resolution = resolution;
+  }
+
+  if (_sdf->HasElement("size"))
+  {
+    auto size = _sdf->Get<double>("size");
+    if (size > 0)
+      this->dataPtr->size = size;
+  }
+
+  this->dataPtr->recenterDistance = this->dataPtr->size * 0.25;
+  if (_sdf->HasElement("recenter_distance"))
+  {
+    this->dataPtr->recenterDistance =
+        _sdf->Get<double>("recenter_distance");
+  }
+
+  if (_sdf->HasElement("actor_radius"))
+    this->dataPtr->actorRadius = _sdf->Get<double>("actor_radius");
+
+  if (_sdf->HasElement("velocity_horizon"))
+    this->dataPtr->velocityHorizon = _sdf->Get<double>("velocity_horizon");
+
+  if (_sdf->HasElement("velocity_cost"))
+  {
+    this->dataPtr->velocityCost = static_cast<int8_t>(
+        std::max(1, std::min(100, _sdf->Get<int>("velocity_cost"))));
+  }
+
+  // Fields which don't change between publications
+  auto &msg = this->dataPtr->msg;
+  auto cells = static_cast<uint32_t>(
+      std::ceil(this->dataPtr->size / this->dataPtr->resolution));
+  msg.info.resolution = this->dataPtr->resolution;
+  msg.info.width = cells;
+  msg.info.height = cells;
+  msg.info.origin.orientation.w = 1.0;
+  msg.data.assign(static_cast<size_t>(cells) * cells, 0);
+
+  // ROS transport
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM("A ROS node for Gazebo has not been initialized,"
+        << "unable to load plugin. Load the Gazebo system plugin "
+        << "'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->dataPtr->rosNode.reset(new ros::NodeHandle());
+  this->dataPtr->rosPub =
+      this->dataPtr->rosNode->advertise<nav_msgs::OccupancyGrid>(topic, 1);
+
+  // Stamp after physics has been updated
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateEnd(
+      std::bind(&HumanOccupancyPlugin::OnUpdate, this));
+
+  gzmsg << "[ServiceSim] Human occupancy plugin loaded, publishing on ["
+        << topic << "]" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void HumanOccupancyPlugin::UpdateActors()
+{
+  auto world = this->dataPtr->world;
+
+  // Only go through models when some have been inserted or removed
+  if (!this->dataPtr->models.Changed(world))
+    return;
+
+  this->dataPtr->actors.clear();
+  this->dataPtr->lastPositions.clear();
+  for (const auto &model : world->Models())
+  {
+    if (!boost::dynamic_pointer_cast<gazebo::physics::Actor>(model))
+      continue;
+
+    this->dataPtr->actors.push_back(model);
+    this->dataPtr->lastPositions.push_back(model->WorldPose().Pos());
+  }
+}
+
+/////////////////////////////////////////////////
+void HumanOccupancyPlugin::Recenter(const double _x, const double _y)
+{
+  this->dataPtr->centerX = _x;
+  this->dataPtr->centerY = _y;
+  this->dataPtr->centered = true;
+
+  // Keep cells aligned with the world's grid, so they don't shimmer as the
+  // window moves
+  auto resolution = this->dataPtr->resolution;
+  auto half = this->dataPtr->msg.info.width * resolution * 0.5;
+  auto &origin = this->dataPtr->msg.info.origin.position;
+  origin.x = std::floor((_x - half) / resolution) * resolution;
+  origin.y = std::floor((_y - half) / resolution) * resolution;
+
+  std::fill(this->dataPtr->msg.data.begin(), this->dataPtr->msg.data.end(),
+      0);
+  this->dataPtr->stamped.clear();
+}
+
+/////////////////////////////////////////////////
+void HumanOccupancyPlugin::Stamp(const double _x0, const double _y0,
+    const double _x1, const double _y1, const double _radius,
+    const int8_t _value)
+{
+  auto &msg = this->dataPtr->msg;
+  auto resolution = this->dataPtr->resolution;
+  auto originX = msg.info.origin.position.x;
+  auto originY = msg.info.origin.position.y;
+  int64_t width = msg.info.width;
+  int64_t height = msg.info.height;
+
+  // Cells around the segment's bounding box
+  auto colMin = std::max<int64_t>(0, static_cast<int64_t>(std::floor(
+      (std::min(_x0, _x1) - _radius - originX) / resolution)));
+  auto colMax = std::min<int64_t>(width - 1, static_cast<int64_t>(std::floor(
+      (std::max(_x0, _x1) + _radius - originX) / resolution)));
+  auto rowMin = std::max<int64_t>(0, static_cast<int64_t>(std::floor(
+      (std::min(_y0, _y1) - _radius - originY) / resolution)));
+  auto rowMax = std::min<int64_t>(height - 1, static_cast<int64_t>(std::floor(
+      (std::max(_y0, _y1) + _radius - originY) / resolution)));
+
+  auto dx = _x1 - _x0;
+  auto dy = _y1 - _y0;
+  auto lengthSquared = dx * dx + dy * dy;
+  auto radiusSquared = _radius * _radius;
+
+  for (auto row = rowMin; row <= rowMax; ++row)
+  {
+    auto y = originY + (row + 0.5) * resolution;
+    for (auto col = colMin; col <= colMax; ++col)
+    {
+      auto x = originX + (col + 0.5) * resolution;
+
+      // Closest point on the segment to the cell's center
+      double t{0.0};
+      if (lengthSquared > 0)
+      {
+        t = ((x - _x0) * dx + (y - _y0) * dy) / lengthSquared;
+        t = std::max(0.0, std::min(1.0, t));
+      }
+      auto ex = x - (_x0 + t * dx);
+      auto ey = y - (_y0 + t * dy);
+      if (ex * ex + ey * ey > radiusSquared)
+        continue;
+
+      auto index = static_cast<uint32_t>(row * width + col);
+      auto &cell = msg.data[index];
+      if (cell == 0)
+        this->dataPtr->stamped.push_back(index);
+      cell = std::max(cell, _value);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void HumanOccupancyPlugin::OnUpdate()
+{
+  auto simTime = this->dataPtr->world->SimTime();
+  auto dt = (simTime - this->dataPtr->lastUpdate).Double();
+
+  // Time went backwards, e.g. after a reset
+  if (dt < 0)
+  {
+    this->dataPtr->lastUpdate = simTime;
+    return;
+  }
+
+  if (dt < this->dataPtr->updatePeriod)
+    return;
+
+  this->dataPtr->lastUpdate = simTime;
+
+  this->UpdateActors();
+
+  // Velocities are estimated from the previous update, so positions are
+  // tracked even while nobody is subscribed
+  std::vector<ignition::math::Vector3d> positions;
+  positions.reserve(this->dataPtr->actors.size());
+  for (const auto &actor : this->dataPtr->actors)
+    positions.push_back(actor->WorldPose().Pos());
+
+  auto lastPositions = this->dataPtr->lastPositions;
+  this->dataPtr->lastPositions = positions;
+
+  if (this->dataPtr->rosPub.getNumSubscribers() == 0)
+    return;
+
+  // The robot may not have been spawned yet
+  auto robot = this->dataPtr->world->ModelByName(this->dataPtr->robotName);
+  if (!robot)
+    return;
+
+  auto robotPos = robot->WorldPose().Pos();
+  if (!this->dataPtr->centered ||
+      std::hypot(robotPos.X() - this->dataPtr->centerX,
+                 robotPos.Y() - this->dataPtr->centerY) >
+      this->dataPtr->recenterDistance)
+  {
+    this->Recenter(robotPos.X(), robotPos.Y());
+  }
+  else
+  {
+    // Only clear what was stamped last time
+    for (auto index : this->dataPtr->stamped)
+      this->dataPtr->msg.data[index] = 0;
+    this->dataPtr->stamped.clear();
+  }
+
+  for (size_t i = 0; i < positions.size(); ++i)
+  {
+    const auto &pos = positions[i];
+
+    if (this->dataPtr->velocityHorizon > 0)
+    {
+      auto velocity = (pos - lastPositions[i]) / dt;
+      auto end = pos + velocity * this->dataPtr->velocityHorizon;
+      this->Stamp(pos.X(), pos.Y(), end.X(), end.Y(),
+          this->dataPtr->actorRadius, this->dataPtr->velocityCost);
+    }
+
+    this->Stamp(pos.X(), pos.Y(), pos.X(), pos.Y(),
+        this->dataPtr->actorRadius, kOccupied);
+  }
+
+  auto &msg = this->dataPtr->msg;
+  msg.header.stamp.sec = simTime.sec;
+  msg.header.stamp.nsec = simTime.nsec;
+  msg.info.map_load_time = msg.header.stamp;
+  this->dataPtr->rosPub.publish(msg);
+}
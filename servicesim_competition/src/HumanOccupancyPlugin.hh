@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_HUMANOCCUPANCYPLUGIN_HH_
+#define SERVICESIM_HUMANOCCUPANCYPLUGIN_HH_
+
+#include <cstdint>
+#include <memory>
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  class HumanOccupancyPluginPrivate;
+
+  /// \brief Publishes the ground-truth footprints of all actors as a
+  /// nav_msgs/OccupancyGrid in a window around the robot, as a reference
+  /// for tuning costmaps.
+  ///
+  /// Each actor is stamped as a disc. Optionally, the area it will sweep
+  /// over the next <velocity_horizon> seconds at its current velocity is
+  /// stamped at a lower cost. Between publications, only the cells stamped
+  /// last time are cleared, so the cost of an update depends on the number
+  /// of actors and not on the size of the grid. The window is only moved,
+  /// and fully cleared, once the robot is farther than <recenter_distance>
+  /// from its center.
+  ///
+  /// SDF params:
+  ///   * <topic> ROS topic, defaults to /servicesim/human_occupancy
+  ///   * <frame> Frame of the grid, defaults to map
+  ///   * <update_rate> Publish frequency in Hz, defaults to 5
+  ///   * <robot_name> Name of the robot model the window follows
+  ///   * <resolution> Cell side length in meters, defaults to 0.05
+  ///   * <size> Side length of the square window in meters, defaults to 10
+  ///   * <recenter_distance> Distance in meters from the window's center
+  ///                         at which it is moved, defaults to <size> / 4
+  ///   * <actor_radius> Radius of each actor's disc, defaults to 0.25
+  ///   * <velocity_horizon> Time in seconds to project actors' motion,
+  ///                        defaults to 0, which disables it
+  ///   * <velocity_cost> Cell value for the projected motion, from 1 to
+  ///                     100, defaults to 50
+  class HumanOccupancyPlugin : public gazebo::WorldPlugin
+  {
+    /// \brief Constructor
+    public: HumanOccupancyPlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::WorldPtr _world, sdf::ElementPtr _sdf)
+        override;
+
+    /// \brief Update the list of actors if models were inserted or removed.
+    private: void UpdateActors();
+
+    /// \brief Move the window to be centered on a position, clearing all
+    /// cells.
+    /// \param[in] _x X of the new center.
+    /// \param[in] _y Y of the new center.
+    private: void Recenter(const double _x, const double _y);
+
+    /// \brief Stamp the cells within a distance of a segment.
+    /// \param[in] _x0 X of the segment's start.
+    /// \param[in] _y0 Y of the segment's start.
+    /// \param[in] _x1 X of the segment's end.
+    /// \param[in] _y1 Y of the segment's end.
+    /// \param[in] _radius Distance from the segment.
+    /// \param[in] _value Cell value, cells already higher are kept.
+    private: void Stamp(const double _x0, const double _y0, const double _x1,
+        const double _y1, const double _radius, const int8_t _value);
+
+    /// \brief Called at the end of every world iteration
+    private: void OnUpdate();
+
+    /// \internal
+    private: std::unique_ptr<HumanOccupancyPluginPrivate> dataPtr;
+  };
+}
+#endif
@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Pose3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/common/Mesh.hh>
+#include <gazebo/common/MeshManager.hh>
+#include <gazebo/common/Skeleton.hh>
+#include <gazebo/common/SkeletonAnimation.hh>
+#include <gazebo/physics/Actor.hh>
+#include <gazebo/physics/World.hh>
+
+#include "IdleActorPlugin.hh"
+#include "LoadProfiler.hh"
+#include "RandomStream.hh"
+
+/// \brief Radius around the actor's origin which may still show on a
+/// camera when the origin is outside its field of view
+static const double kBodyRadius = 0.3;
+
+/// \brief Latest starting point in seconds within the animation, which
+/// loops
+static const double kMaxStartOffset = 30.0;
+
+/////////////////////////////////////////////////
+class servicesim::IdleActorPluginPrivate
+{
+  /// \brief Pointer to the actor
+  public: gazebo::physics::ActorPtr actor{nullptr};
+
+  /// \brief Pointer to the world
+  public: gazebo::physics::WorldPtr world{nullptr};
+
+  /// \brief Connection to world update
+  public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+  /// \brief Robot name
+  public: std::string robotName;
+
+  /// \brief Distance within which the actor can be seen
+  public: double range{8.0};
+
+  /// \brief Heading of each camera relative to the robot
+  public: std::vector<double> cameraYaws;
+
+  /// \brief Half the horizontal field of view of each camera
+  public: std::vector<double> cameraHalfFovs;
+
+  /// \brief Time between skeleton updates
+  public: double updatePeriod{0.1};
+
+  /// \brief This actor's offset within the update period
+  public: double phase{0.0};
+
+  /// \brief Starting point within the animation
+  public: double startOffset{0.0};
+
+  /// \brief Index of the last update period which was handled
+  public: int64_t lastTick{std::numeric_limits<int64_t>::min()};
+
+  /// \brief Sim time when the script time was last advanced
+  public: double lastAnimated{0.0};
+
+  /// \brief True once the skeleton has been updated at least once
+  public: bool posed{false};
+
+  /// \brief Pose the actor is kept at
+  public: ignition::math::Pose3d pose;
+
+  /// \brief Random numbers for this actor's phase and starting point
+  public: RandomStream random;
+};
+
+using namespace servicesim;
+GZ_REGISTER_MODEL_PLUGIN(servicesim::IdleActorPlugin)
+
+/////////////////////////////////////////////////
+IdleActorPlugin::IdleActorPlugin()
+    : dataPtr(new IdleActorPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+void IdleActorPlugin::Load(gazebo::physics::ModelPtr _model,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("IdleActorPlugin::Load", "plugin", _model->GetName());
+
+  this->dataPtr->actor =
+      boost::dynamic_pointer_cast<gazebo::physics::Actor>(_model);
+  if (!this->dataPtr->actor)
+  {
+    gzerr << "IdleActorPlugin must be attached to an actor." << std::endl;
+    return;
+  }
+  this->dataPtr->world = _model->GetWorld();
+  this->dataPtr->random.SetName("IdleActorPlugin/" + _model->GetName());
+
+  if (_sdf->HasElement("robot_name"))
+    this->dataPtr->robotName = _sdf->Get<std::string>("robot_name");
+
+  if (_sdf->HasElement("range"))
+    this->dataPtr->range = _sdf->Get<double>("range");
+
+  if (_sdf->HasElement("update_rate"))
+  {
+    auto rate = _sdf->Get<double>("update_rate");
+    if (rate > 0)
+      this->dataPtr->updatePeriod = 1.0 / rate;
+  }
+
+  if (_sdf->HasElement("camera"))
+  {
+    auto cameraElem = _sdf->GetElement("camera");
+    while (cameraElem)
+    {
+      this->dataPtr->cameraYaws.push_back(cameraElem->Get<double>("yaw"));
+      this->dataPtr->cameraHalfFovs.push_back(
+          cameraElem->Get<double>("fov") * 0.5);
+      cameraElem = cameraElem->GetNextElement("camera");
+    }
+  }
+
+  // Read in the animation name
+  std::string animation{"animation"};
+  if (_sdf->HasElement("animation"))
+    animation = _sdf->Get<std::string>("animation");
+
+  auto skelAnims = this->dataPtr->actor->SkeletonAnimations();
+  if (skelAnims.find(animation) == skelAnims.end())
+  {
+    gzerr << "Skeleton animation [" << animation << "] not found in Actor."
+          << std::endl;
+    return;
+  }
+
+  // Custom trajectories take the actor's pose as the root bone's pose, so
+  // place it where a script would have, given the animation's root at its
+  // start
+  this->dataPtr->pose = _model->WorldPose();
+  auto skinFile = _model->GetSDF()->GetElement("skin")->Get<std::string>(
+      "filename");
+  auto mesh = gazebo::common::MeshManager::Instance()->GetMesh(skinFile);
+  if (mesh && mesh->HasSkeleton())
+  {
+    auto rootName = mesh->GetSkeleton()->GetRootNode()->GetName();
+    auto frame = skelAnims[animation]->PoseAt(0.0);
+    if (frame.find(rootName) != frame.end())
+    {
+      auto root = frame[rootName];
+      auto &pose = this->dataPtr->pose;
+      pose.Pos() += pose.Rot().RotateVector(root.Translation());
+      pose.Rot() = pose.Rot() * root.Rotation();
+    }
+  }
+
+  // The script time is driven from here rather than from sim time
+  gazebo::physics::TrajectoryInfoPtr trajectoryInfo(
+      new gazebo::physics::TrajectoryInfo());
+  trajectoryInfo->type = animation;
+  trajectoryInfo->duration = 1.0;
+  this->dataPtr->actor->SetCustomTrajectory(trajectoryInfo);
+
+  this->dataPtr->phase =
+      this->dataPtr->random.DblUniform(0.0, this->dataPtr->updatePeriod);
+  this->dataPtr->startOffset =
+      this->dataPtr->random.DblUniform(0.0, kMaxStartOffset);
+
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateBegin(
+      std::bind(&IdleActorPlugin::OnUpdate, this, std::placeholders::_1));
+
+  this->Reset();
+}
+
+/////////////////////////////////////////////////
+void IdleActorPlugin::Reset()
+{
+  // Not loaded
+  if (!this->dataPtr->updateConnection)
+    return;
+
+  this->dataPtr->lastTick = std::numeric_limits<int64_t>::min();
+  this->dataPtr->lastAnimated = this->dataPtr->world->SimTime().Double();
+  this->dataPtr->posed = false;
+
+  // Resets put the actor back at its SDF pose
+  this->dataPtr->actor->SetWorldPose(this->dataPtr->pose, false, false);
+
+  this->dataPtr->actor->SetScriptTime(this->dataPtr->startOffset);
+}
+
+/////////////////////////////////////////////////
+bool IdleActorPlugin::InView() const
+{
+  auto robot = this->dataPtr->world->ModelByName(this->dataPtr->robotName);
+  if (!robot)
+    return false;
+
+  auto robotPose = robot->WorldPose();
+  auto diff = this->dataPtr->actor->WorldPose().Pos() - robotPose.Pos();
+  auto distance = std::hypot(diff.X(), diff.Y());
+
+  if (distance > this->dataPtr->range)
+    return false;
+
+  if (this->dataPtr->cameraYaws.empty() || distance < kBodyRadius)
+    return true;
+
+  // The body can show at the edge of the image before its origin does
+  auto margin = std::atan2(kBodyRadius, distance);
+  auto bearing = std::atan2(diff.Y(), diff.X()) - robotPose.Rot().Yaw();
+  for (size_t i = 0; i < this->dataPtr->cameraYaws.size(); ++i)
+  {
+    ignition::math::Angle offset(bearing - this->dataPtr->cameraYaws[i]);
+    offset.Normalize();
+    if (std::abs(offset.Radian()) <= this->dataPtr->cameraHalfFovs[i] + margin)
+      return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+void IdleActorPlugin::OnUpdate(const gazebo::common::UpdateInfo &_info)
+{
+  // Stopped actors are skipped by Gazebo, so only let the actor run on the
+  // steps where its skeleton should be updated
+  if (this->dataPtr->actor->IsActive())
+    this->dataPtr->actor->Stop();
+
+  auto simTime = _info.simTime.Double();
+
+  // Time went backwards, e.g. after a reset
+  if (simTime < this->dataPtr->lastAnimated)
+    this->Reset();
+
+  auto tick = static_cast<int64_t>(std::floor(
+      (simTime - this->dataPtr->phase) / this->dataPtr->updatePeriod));
+  if (tick <= this->dataPtr->lastTick)
+    return;
+
+  this->dataPtr->lastTick = tick;
+
+  // Always pose the skeleton once, so the actor doesn't stay in its bind
+  // pose until the robot comes by
+  if (this->dataPtr->posed && !this->InView())
+  {
+    this->dataPtr->lastAnimated = simTime;
+    return;
+  }
+
+  this->dataPtr->actor->SetScriptTime(this->dataPtr->actor->ScriptTime() +
+      simTime - this->dataPtr->lastAnimated);
+  this->dataPtr->lastAnimated = simTime;
+  this->dataPtr->posed = true;
+
+  this->dataPtr->actor->Play();
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_IDLEACTORPLUGIN_HH_
+#define SERVICESIM_IDLEACTORPLUGIN_HH_
+
+#include <memory>
+
+#include <gazebo/common/Plugin.hh>
+#include <gazebo/common/UpdateInfo.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class IdleActorPluginPrivate;
+
+  /// \brief Plays an idle animation, such as standing, talking or sitting,
+  /// on an actor which stays in place.
+  ///
+  /// The skeleton is only updated while the actor could be seen by the
+  /// robot's cameras, at <update_rate>. Each actor gets its own phase within
+  /// the update period and its own starting point in the animation, so
+  /// crowds neither update on the same step nor move in sync. Out of view,
+  /// the actor is stopped and keeps its last skeleton pose, so Gazebo
+  /// doesn't update it at all.
+  ///
+  /// The actor is placed once, where its SDF script would have placed it at
+  /// the start of the animation, and after that the plugin never moves it
+  /// or changes its collisions. Bones, and any collisions attached to them,
+  /// only follow the animation when the skeleton is updated.
+  ///
+  /// The plugin has the following SDF description:
+  /// <animation>     Name of the actor's animation to play. Defaults to
+  ///                 "animation".
+  /// <robot_name>    Name of the robot whose cameras see the actor.
+  /// <range>         Distance in meters within which the actor can be
+  ///                 seen. Defaults to 8.
+  /// <camera>        Element with a "yaw" attribute, the camera's heading
+  ///                 relative to the robot, and a "fov" attribute, its
+  ///                 horizontal field of view, both in radians. More than
+  ///                 one <camera> can be defined. Without cameras, every
+  ///                 direction counts as seen.
+  /// <update_rate>   Frequency in Hz of skeleton updates while seen.
+  ///                 Defaults to 10. Gazebo throttles actor updates
+  ///                 further at high rates.
+  class IdleActorPlugin : public gazebo::ModelPlugin
+  {
+    /// \brief Constructor
+    public: IdleActorPlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::ModelPtr _model, sdf::ElementPtr _sdf)
+        override;
+
+    // Documentation inherited
+    public: void Reset() override;
+
+    /// \brief Whether the actor could be seen by the robot's cameras.
+    /// \return True if seen.
+    private: bool InView() const;
+
+    /// \brief Main loop
+    /// \param[in] _info Update info
+    private: void OnUpdate(const gazebo::common::UpdateInfo &_info);
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<IdleActorPluginPrivate> dataPtr;
+  };
+}
+#endif
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "KinematicBase.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+void KinematicBase::Load(const sdf::ElementPtr &_sdf)
+{
+  if (_sdf->HasElement("linearAcceleration"))
+  {
+    this->linearAcceleration =
+        std::abs(_sdf->Get<double>("linearAcceleration"));
+  }
+
+  if (_sdf->HasElement("angularAcceleration"))
+  {
+    this->angularAcceleration =
+        std::abs(_sdf->Get<double>("angularAcceleration"));
+  }
+
+  if (_sdf->HasElement("commandTimeout"))
+    this->commandTimeout = _sdf->Get<double>("commandTimeout");
+}
+
+/////////////////////////////////////////////////
+void KinematicBase::Reset(const ignition::math::Pose3d &_start)
+{
+  this->startPose = _start;
+  this->x = _start.Pos().X();
+  this->y = _start.Pos().Y();
+  this->yaw = _start.Rot().Yaw();
+  this->linear = 0.0;
+  this->angular = 0.0;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->commandLinear = 0.0;
+  this->commandAngular = 0.0;
+  this->commandTime = 0.0;
+}
+
+/////////////////////////////////////////////////
+void KinematicBase::SetCommand(const double _linear, const double _angular,
+    const double _time)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->commandLinear = _linear;
+  this->commandAngular = _angular;
+  this->commandTime = _time;
+}
+
+/////////////////////////////////////////////////
+void KinematicBase::Update(const double _simTime, const double _dt)
+{
+  double targetLinear;
+  double targetAngular;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    targetLinear = this->commandLinear;
+    targetAngular = this->commandAngular;
+    if (_simTime - this->commandTime > this->commandTimeout)
+    {
+      targetLinear = 0.0;
+      targetAngular = 0.0;
+    }
+  }
+
+  // Follow the command within the acceleration limits
+  auto maxLinear = this->linearAcceleration * _dt;
+  this->linear += std::max(-maxLinear,
+      std::min(maxLinear, targetLinear - this->linear));
+
+  auto maxAngular = this->angularAcceleration * _dt;
+  this->angular += std::max(-maxAngular,
+      std::min(maxAngular, targetAngular - this->angular));
+
+  // Integrate at the midpoint heading
+  auto heading = this->yaw + this->angular * _dt * 0.5;
+  this->x += this->linear * std::cos(heading) * _dt;
+  this->y += this->linear * std::sin(heading) * _dt;
+  this->yaw += this->angular * _dt;
+}
+
+/////////////////////////////////////////////////
+void KinematicBase::Stop(const double _x, const double _y)
+{
+  this->x = _x;
+  this->y = _y;
+  this->linear = 0.0;
+}
+
+/////////////////////////////////////////////////
+void KinematicBase::Teleport(const ignition::math::Pose3d &_pose)
+{
+  this->x = _pose.Pos().X();
+  this->y = _pose.Pos().Y();
+  this->yaw = _pose.Rot().Yaw();
+  this->linear = 0.0;
+  this->angular = 0.0;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d KinematicBase::Pose() const
+{
+  const auto &start = this->startPose;
+  return ignition::math::Pose3d(this->x, this->y, start.Pos().Z(),
+      start.Rot().Roll(), start.Rot().Pitch(), this->yaw);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d KinematicBase::LinearVelocity() const
+{
+  return ignition::math::Vector3d(this->linear * std::cos(this->yaw),
+      this->linear * std::sin(this->yaw), 0);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d KinematicBase::AngularVelocity() const
+{
+  return ignition::math::Vector3d(0, 0, this->angular);
+}
+
+/////////////////////////////////////////////////
+void KinematicBase::Odometry(nav_msgs::Odometry &_msg) const
+{
+  // Pose relative to the start
+  const auto &start = this->startPose;
+  auto startYaw = start.Rot().Yaw();
+  auto dx = this->x - start.Pos().X();
+  auto dy = this->y - start.Pos().Y();
+  auto cosStart = std::cos(startYaw);
+  auto sinStart = std::sin(startYaw);
+  auto relYaw = this->yaw - startYaw;
+
+  _msg.pose.pose.position.x = dx * cosStart + dy * sinStart;
+  _msg.pose.pose.position.y = -dx * sinStart + dy * cosStart;
+  _msg.pose.pose.position.z = 0.0;
+  _msg.pose.pose.orientation.x = 0.0;
+  _msg.pose.pose.orientation.y = 0.0;
+  _msg.pose.pose.orientation.z = std::sin(relYaw * 0.5);
+  _msg.pose.pose.orientation.w = std::cos(relYaw * 0.5);
+  _msg.twist.twist.linear.x = this->linear;
+  _msg.twist.twist.angular.z = this->angular;
+}
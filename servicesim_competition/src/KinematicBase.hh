@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_KINEMATICBASE_HH_
+#define SERVICESIM_KINEMATICBASE_HH_
+
+#include <mutex>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include <nav_msgs/Odometry.h>
+#include <sdf/sdf.hh>
+
+namespace servicesim
+{
+  /// \brief Integrates velocity commands into a pose on the XY plane, within
+  /// acceleration limits, for a base which doesn't slip. Shared by the
+  /// KinematicBasePlugin and the servicesim_2d simulator.
+  ///
+  /// Commands may be set from any thread. Reads the <linearAcceleration>,
+  /// <angularAcceleration> and <commandTimeout> elements of the
+  /// KinematicBasePlugin's SDF.
+  class KinematicBase
+  {
+    /// \brief Load parameters.
+    /// \param[in] _sdf SDF element.
+    public: void Load(const sdf::ElementPtr &_sdf);
+
+    /// \brief Stop and move back to a start pose, clearing the command.
+    /// \param[in] _start Pose the base starts at. Odometry is relative to it
+    /// and its height, roll and pitch are kept.
+    public: void Reset(const ignition::math::Pose3d &_start);
+
+    /// \brief Set the velocity command.
+    /// \param[in] _linear Forward speed in m/s.
+    /// \param[in] _angular Turning speed in rad/s.
+    /// \param[in] _time Sim time the command was received, in seconds.
+    public: void SetCommand(const double _linear, const double _angular,
+        const double _time);
+
+    /// \brief Move one step.
+    /// \param[in] _simTime Current sim time in seconds.
+    /// \param[in] _dt Time since the last step in seconds.
+    public: void Update(const double _simTime, const double _dt);
+
+    /// \brief Put the base at a position and stop it, such as after running
+    /// into an obstacle. The heading is kept.
+    /// \param[in] _x Position along X.
+    /// \param[in] _y Position along Y.
+    public: void Stop(const double _x, const double _y);
+
+    /// \brief Move the base to a pose and stop it, such as after it's been
+    /// teleported. Odometry stays relative to the start pose.
+    /// \param[in] _pose New pose, of which only X, Y and yaw are used.
+    public: void Teleport(const ignition::math::Pose3d &_pose);
+
+    /// \brief Current world pose.
+    /// \return Pose.
+    public: ignition::math::Pose3d Pose() const;
+
+    /// \brief Current world linear velocity.
+    /// \return Velocity on the XY plane.
+    public: ignition::math::Vector3d LinearVelocity() const;
+
+    /// \brief Current world angular velocity.
+    /// \return Velocity around Z.
+    public: ignition::math::Vector3d AngularVelocity() const;
+
+    /// \brief Fill an odometry message's pose, relative to the start pose,
+    /// and twist. The header and frames are left untouched.
+    /// \param[out] _msg Message to fill.
+    public: void Odometry(nav_msgs::Odometry &_msg) const;
+
+    /// \brief Largest change of forward speed per second
+    private: double linearAcceleration{1.0};
+
+    /// \brief Largest change of turning speed per second
+    private: double angularAcceleration{2.0};
+
+    /// \brief Time without commands after which the base stops
+    private: double commandTimeout{0.5};
+
+    /// \brief Latest commanded forward speed
+    private: double commandLinear{0.0};
+
+    /// \brief Latest commanded turning speed
+    private: double commandAngular{0.0};
+
+    /// \brief Sim time the latest command was received
+    private: double commandTime{0.0};
+
+    /// \brief Protects the command
+    private: mutable std::mutex mutex;
+
+    /// \brief Current forward speed
+    private: double linear{0.0};
+
+    /// \brief Current turning speed
+    private: double angular{0.0};
+
+    /// \brief Pose the base started at
+    private: ignition::math::Pose3d startPose;
+
+    /// \brief Integrated position on the XY plane
+    private: double x{0.0};
+
+    /// \brief Integrated position on the XY plane
+    private: double y{0.0};
+
+    /// \brief Integrated heading
+    private: double yaw{0.0};
+  };
+}
+#endif
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <functional>
+#include <string>
+
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Pose3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/Link.hh>
+#include <gazebo/physics/Model.hh>
+#include <gazebo/physics/World.hh>
+
+#include <geometry_msgs/TransformStamped.h>
+#include <nav_msgs/Odometry.h>
+#include <ros/ros.h>
+#include <tf2_ros/transform_broadcaster.h>
+
+#include "KinematicBase.hh"
+#include "KinematicBasePlugin.hh"
+#include "LoadProfiler.hh"
+
+/////////////////////////////////////////////////
+class servicesim::KinematicBasePluginPrivate
+{
+  /// \brief Pointer to the model
+  public: gazebo::physics::ModelPtr model;
+
+  /// \brief Pointer to the world
+  public: gazebo::physics::WorldPtr world;
+
+  /// \brief Connection to world update
+  public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+  /// \brief ROS node handle
+  public: std::unique_ptr<ros::NodeHandle> rosNode{nullptr};
+
+  /// \brief Velocity command subscriber
+  public: ros::Subscriber commandSub;
+
+  /// \brief Odometry publisher
+  public: ros::Publisher odomPub;
+
+  /// \brief Broadcasts the odometry transform
+  public: std::unique_ptr<tf2_ros::TransformBroadcaster> tfBroadcaster;
+
+  /// \brief Odometry message reused across publications
+  public: nav_msgs::Odometry odomMsg;
+
+  /// \brief True to broadcast the odometry transform
+  public: bool publishTf{true};
+
+  /// \brief Time between odometry publications
+  public: double odomPeriod{0.02};
+
+  /// \brief Integrates commands into the pose
+  public: KinematicBase base;
+
+  /// \brief Pose the robot was spawned at, odometry is relative to it
+  public: ignition::math::Pose3d startPose;
+
+  /// \brief Time of the last update
+  public: gazebo::common::Time lastUpdate;
+
+  /// \brief Time of the last odometry publication
+  public: gazebo::common::Time lastOdom;
+};
+
+using namespace servicesim;
+GZ_REGISTER_MODEL_PLUGIN(servicesim::KinematicBasePlugin)
+
+/////////////////////////////////////////////////
+KinematicBasePlugin::KinematicBasePlugin()
+    : dataPtr(new KinematicBasePluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+KinematicBasePlugin::~KinematicBasePlugin()
+{
+  this->dataPtr->updateConnection.reset();
+  this->dataPtr->commandSub.shutdown();
+}
+
+/////////////////////////////////////////////////
+void KinematicBasePlugin::Load(gazebo::physics::ModelPtr _model,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("KinematicBasePlugin::Load", "plugin", _model->GetName());
+
+  this->dataPtr->model = _model;
+  this->dataPtr->world = _model->GetWorld();
+
+  std::string ns = _model->GetName();
+  if (_sdf->HasElement("robotNamespace"))
+    ns = _sdf->Get<std::string>("robotNamespace");
+
+  std::string commandTopic{"cmd_vel"};
+  if (_sdf->HasElement("commandTopic"))
+    commandTopic = _sdf->Get<std::string>("commandTopic");
+
+  std::string odomTopic{"odom"};
+  if (_sdf->HasElement("odometryTopic"))
+    odomTopic = _sdf->Get<std::string>("odometryTopic");
+
+  std::string odomFrame{"odom"};
+  if (_sdf->HasElement("odometryFrame"))
+    odomFrame = _sdf->Get<std::string>("odometryFrame");
+
+  std::string baseFrame{"base_footprint"};
+  if (_sdf->HasElement("robotBaseFrame"))
+    baseFrame = _sdf->Get<std::string>("robotBaseFrame");
+
+  if (_sdf->HasElement("publishTf"))
+    this->dataPtr->publishTf = _sdf->Get<bool>("publishTf");
+
+  if (_sdf->HasElement("updateRate"))
+  {
+    auto rate = _sdf->Get<double>("updateRate");
+    if (rate > 0)
+      this->dataPtr->odomPeriod = 1.0 / rate;
+  }
+
+  // Acceleration limits and command timeout
+  this->dataPtr->base.Load(_sdf);
+
+  // The physics engine doesn't integrate forces or solve joints and contacts
+  // for kinematic links, they only follow the pose set on every update
+  for (const auto &link : _model->GetLinks())
+    link->SetKinematic(true);
+
+  // No wheel-ground contacts, the base stays at its spawn height
+  if (_sdf->HasElement("disableCollisions"))
+  {
+    auto linkElem = _sdf->GetElement("disableCollisions");
+    while (linkElem)
+    {
+      auto linkName = linkElem->Get<std::string>();
+      auto link = _model->GetLink(linkName);
+      if (link)
+        link->SetCollideMode("none");
+      else
+        gzwarn << "Link [" << linkName << "] not found." << std::endl;
+
+      linkElem = linkElem->GetNextElement("disableCollisions");
+    }
+  }
+
+  this->dataPtr->startPose = _model->WorldPose();
+  this->Reset();
+
+  // ROS transport
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM("A ROS node for Gazebo has not been initialized,"
+        << "unable to load plugin. Load the Gazebo system plugin "
+        << "'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->dataPtr->rosNode.reset(new ros::NodeHandle(ns));
+
+  this->dataPtr->commandSub = this->dataPtr->rosNode->subscribe(
+      commandTopic, 1, &KinematicBasePlugin::OnCommand, this);
+
+  this->dataPtr->odomPub =
+      this->dataPtr->rosNode->advertise<nav_msgs::Odometry>(odomTopic, 1);
+
+  if (this->dataPtr->publishTf)
+    this->dataPtr->tfBroadcaster.reset(new tf2_ros::TransformBroadcaster());
+
+  // The robot doesn't slip, so covariances are small
+  auto &msg = this->dataPtr->odomMsg;
+  msg.header.frame_id = odomFrame;
+  msg.child_frame_id = baseFrame;
+  for (unsigned int i = 0; i < 6; ++i)
+  {
+    msg.pose.covariance[i * 7] = 1e-6;
+    msg.twist.covariance[i * 7] = 1e-6;
+  }
+
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateBegin(
+      std::bind(&KinematicBasePlugin::OnUpdate, this));
+
+  gzmsg << "[ServiceSim] Kinematic base moving [" << _model->GetName()
+        << "] from [" << this->dataPtr->rosNode->resolveName(commandTopic)
+        << "]" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void KinematicBasePlugin::Reset()
+{
+  this->dataPtr->base.Reset(this->dataPtr->startPose);
+}
+
+/////////////////////////////////////////////////
+void KinematicBasePlugin::OnCommand(
+    const geometry_msgs::Twist::ConstPtr &_msg)
+{
+  this->dataPtr->base.SetCommand(_msg->linear.x, _msg->angular.z,
+      this->dataPtr->world->SimTime().Double());
+}
+
+/////////////////////////////////////////////////
+void KinematicBasePlugin::OnUpdate()
+{
+  auto simTime = this->dataPtr->world->SimTime();
+  auto dt = (simTime - this->dataPtr->lastUpdate).Double();
+  this->dataPtr->lastUpdate = simTime;
+
+  // Time went backwards, e.g. after a reset
+  if (dt < 0)
+  {
+    this->dataPtr->lastOdom = simTime;
+    return;
+  }
+
+  auto &base = this->dataPtr->base;
+  base.Update(simTime.Double(), dt);
+
+  // Follow the model when it's moved from outside, such as through
+  // /gazebo/set_model_state or /servicesim/seek_checkpoint. Otherwise it only
+  // drifts from the base by what physics integrated during one step.
+  auto pose = this->dataPtr->model->WorldPose();
+  ignition::math::Angle yawDiff(pose.Rot().Yaw() - base.Pose().Rot().Yaw());
+  yawDiff.Normalize();
+  if (pose.Pos().Distance(base.Pose().Pos()) > 0.1 ||
+      std::abs(yawDiff.Radian()) > 0.1)
+  {
+    base.Teleport(pose);
+  }
+
+  // Velocities are set too, so sensors see the motion
+  this->dataPtr->model->SetWorldPose(base.Pose());
+  this->dataPtr->model->SetLinearVel(base.LinearVelocity());
+  this->dataPtr->model->SetAngularVel(base.AngularVelocity());
+
+  if ((simTime - this->dataPtr->lastOdom).Double() >=
+      this->dataPtr->odomPeriod)
+  {
+    this->dataPtr->lastOdom = simTime;
+    this->PublishOdometry();
+  }
+}
+
+/////////////////////////////////////////////////
+void KinematicBasePlugin::PublishOdometry()
+{
+  auto simTime = this->dataPtr->world->SimTime();
+
+  auto &msg = this->dataPtr->odomMsg;
+  msg.header.stamp = ros::Time(simTime.sec, simTime.nsec);
+  this->dataPtr->base.Odometry(msg);
+  this->dataPtr->odomPub.publish(msg);
+
+  if (!this->dataPtr->tfBroadcaster)
+    return;
+
+  geometry_msgs::TransformStamped transform;
+  transform.header = msg.header;
+  transform.child_frame_id = msg.child_frame_id;
+  transform.transform.translation.x = msg.pose.pose.position.x;
+  transform.transform.translation.y = msg.pose.pose.position.y;
+  transform.transform.rotation = msg.pose.pose.orientation;
+  this->dataPtr->tfBroadcaster->sendTransform(transform);
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_KINEMATICBASEPLUGIN_HH_
+#define SERVICESIM_KINEMATICBASEPLUGIN_HH_
+
+#include <memory>
+
+#include <geometry_msgs/Twist.h>
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class KinematicBasePluginPrivate;
+
+  /// \brief A model plugin which moves a mobile base by integrating
+  /// geometry_msgs/Twist commands straight into its pose, in place of a
+  /// differential drive on simulated wheels.
+  ///
+  /// Commands are followed within acceleration limits and the robot stops
+  /// if none arrive for a while. All links of the model are made kinematic,
+  /// so the physics engine doesn't integrate forces or solve joints and
+  /// contacts for them, and the links given in <disableCollisions>, such as
+  /// wheels and casters, stop colliding altogether. Collisions of the other
+  /// links are still detected, for the contact penalties. Odometry and
+  /// the odometry to base transform are published like
+  /// gazebo_ros_diff_drive does, with the pose relative to where the robot
+  /// was spawned.
+  ///
+  /// The plugin has the following SDF description:
+  /// <robotNamespace>       ROS namespace, defaults to the model name.
+  /// <commandTopic>         Topic within the namespace, defaults to
+  ///                        "cmd_vel".
+  /// <odometryTopic>        Topic within the namespace, defaults to "odom".
+  /// <odometryFrame>        Defaults to "odom".
+  /// <robotBaseFrame>       Defaults to "base_footprint".
+  /// <publishTf>            True to broadcast the odometry transform,
+  ///                        defaults to true.
+  /// <updateRate>           Odometry frequency in Hz, defaults to 50.
+  /// <linearAcceleration>   Largest change of forward speed in m/s^2,
+  ///                        defaults to 1.
+  /// <angularAcceleration>  Largest change of turning speed in rad/s^2,
+  ///                        defaults to 2.
+  /// <commandTimeout>       Seconds without commands after which the robot
+  ///                        stops, defaults to 0.5.
+  /// <disableCollisions>    Name of a link whose collisions are disabled,
+  ///                        may be repeated.
+  class KinematicBasePlugin : public gazebo::ModelPlugin
+  {
+    /// \brief Constructor
+    public: KinematicBasePlugin();
+
+    /// \brief Destructor
+    public: ~KinematicBasePlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::ModelPtr _model, sdf::ElementPtr _sdf)
+        override;
+
+    // Documentation inherited
+    public: void Reset() override;
+
+    /// \brief Callback when a velocity command is received.
+    /// \param[in] _msg Command.
+    private: void OnCommand(const geometry_msgs::Twist::ConstPtr &_msg);
+
+    /// \brief Called at the beginning of every world iteration
+    private: void OnUpdate();
+
+    /// \brief Publish odometry and the odometry transform.
+    private: void PublishOdometry();
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<KinematicBasePluginPrivate> dataPtr;
+  };
+}
+#endif
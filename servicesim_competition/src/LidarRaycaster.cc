@@ -0,0 +1,433 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "LidarRaycaster.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+void LidarRaycaster::Segments::Add(const double _x0, const double _y0,
+    const double _x1, const double _y1, const double _zMin, const double _zMax)
+{
+  this->x.push_back(_x0);
+  this->y.push_back(_y0);
+  this->dx.push_back(_x1 - _x0);
+  this->dy.push_back(_y1 - _y0);
+  this->zMin.push_back(_zMin);
+  this->zMax.push_back(_zMax);
+}
+
+/////////////////////////////////////////////////
+void LidarRaycaster::Segments::Clear()
+{
+  this->x.clear();
+  this->y.clear();
+  this->dx.clear();
+  this->dy.clear();
+  this->zMin.clear();
+  this->zMax.clear();
+}
+
+/////////////////////////////////////////////////
+void LidarRaycaster::ClearStatic()
+{
+  this->staticSegments.Clear();
+  this->binned.Clear();
+  this->cellStart.clear();
+  this->columns = 0;
+  this->rows = 0;
+}
+
+/////////////////////////////////////////////////
+void LidarRaycaster::AddStaticSegment(const double _x0, const double _y0,
+    const double _x1, const double _y1, const double _zMin, const double _zMax)
+{
+  this->staticSegments.Add(_x0, _y0, _x1, _y1, _zMin, _zMax);
+}
+
+/////////////////////////////////////////////////
+size_t LidarRaycaster::StaticSegmentCount() const
+{
+  return this->staticSegments.x.size();
+}
+
+/////////////////////////////////////////////////
+void LidarRaycaster::BuildStatic(const double _cellSize)
+{
+  this->binned.Clear();
+  this->cellStart.clear();
+  this->columns = 0;
+  this->rows = 0;
+  this->cellSize = _cellSize > 0 ? _cellSize : 1.0;
+
+  const auto &segs = this->staticSegments;
+  auto count = segs.x.size();
+  if (count == 0)
+    return;
+
+  // Grid bounds
+  double minX = std::numeric_limits<double>::max();
+  double minY = std::numeric_limits<double>::max();
+  double maxX = std::numeric_limits<double>::lowest();
+  double maxY = std::numeric_limits<double>::lowest();
+  for (size_t i = 0; i < count; ++i)
+  {
+    minX = std::min({minX, segs.x[i], segs.x[i] + segs.dx[i]});
+    minY = std::min({minY, segs.y[i], segs.y[i] + segs.dy[i]});
+    maxX = std::max({maxX, segs.x[i], segs.x[i] + segs.dx[i]});
+    maxY = std::max({maxY, segs.y[i], segs.y[i] + segs.dy[i]});
+  }
+
+  this->gridX = minX;
+  this->gridY = minY;
+  this->columns = std::max<int64_t>(1,
+      static_cast<int64_t>(std::ceil((maxX - minX) / this->cellSize)));
+  this->rows = std::max<int64_t>(1,
+      static_cast<int64_t>(std::ceil((maxY - minY) / this->cellSize)));
+
+  // Cells overlapped by each segment's bounding box
+  auto cellRange = [&](const size_t _i, int64_t &_c0, int64_t &_c1,
+      int64_t &_r0, int64_t &_r1)
+  {
+    auto x0 = std::min(segs.x[_i], segs.x[_i] + segs.dx[_i]);
+    auto x1 = std::max(segs.x[_i], segs.x[_i] + segs.dx[_i]);
+    auto y0 = std::min(segs.y[_i], segs.y[_i] + segs.dy[_i]);
+    auto y1 = std::max(segs.y[_i], segs.y[_i] + segs.dy[_i]);
+
+    _c0 = static_cast<int64_t>(std::floor((x0 - this->gridX) / this->cellSize));
+    _c1 = static_cast<int64_t>(std::floor((x1 - this->gridX) / this->cellSize));
+    _r0 = static_cast<int64_t>(std::floor((y0 - this->gridY) / this->cellSize));
+    _r1 = static_cast<int64_t>(std::floor((y1 - this->gridY) / this->cellSize));
+
+    _c0 = std::max<int64_t>(0, std::min(_c0, this->columns - 1));
+    _c1 = std::max<int64_t>(0, std::min(_c1, this->columns - 1));
+    _r0 = std::max<int64_t>(0, std::min(_r0, this->rows - 1));
+    _r1 = std::max<int64_t>(0, std::min(_r1, this->rows - 1));
+  };
+
+  // Count segments per cell, then fill each cell's contiguous range
+  auto cellCount = this->columns * this->rows;
+  std::vector<uint32_t> sizes(cellCount, 0);
+  int64_t c0, c1, r0, r1;
+  for (size_t i = 0; i < count; ++i)
+  {
+    cellRange(i, c0, c1, r0, r1);
+    for (auto r = r0; r <= r1; ++r)
+    {
+      for (auto c = c0; c <= c1; ++c)
+        sizes[r * this->columns + c]++;
+    }
+  }
+
+  this->cellStart.resize(cellCount + 1);
+  this->cellStart[0] = 0;
+  for (int64_t i = 0; i < cellCount; ++i)
+    this->cellStart[i + 1] = this->cellStart[i] + sizes[i];
+
+  auto total = this->cellStart.back();
+  this->binned.x.resize(total);
+  this->binned.y.resize(total);
+  this->binned.dx.resize(total);
+  this->binned.dy.resize(total);
+  this->binned.zMin.resize(total);
+  this->binned.zMax.resize(total);
+
+  std::vector<uint32_t> next(this->cellStart.begin(),
+      this->cellStart.end() - 1);
+  for (size_t i = 0; i < count; ++i)
+  {
+    cellRange(i, c0, c1, r0, r1);
+    for (auto r = r0; r <= r1; ++r)
+    {
+      for (auto c = c0; c <= c1; ++c)
+      {
+        auto j = next[r * this->columns + c]++;
+        this->binned.x[j] = segs.x[i];
+        this->binned.y[j] = segs.y[i];
+        this->binned.dx[j] = segs.dx[i];
+        this->binned.dy[j] = segs.dy[i];
+        this->binned.zMin[j] = segs.zMin[i];
+        this->binned.zMax[j] = segs.zMax[i];
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void LidarRaycaster::ClearDynamic()
+{
+  this->dynamicSegments.Clear();
+  this->circleX.clear();
+  this->circleY.clear();
+  this->circleRadius.clear();
+  this->circleZMin.clear();
+  this->circleZMax.clear();
+}
+
+/////////////////////////////////////////////////
+void LidarRaycaster::AddDynamicSegment(const double _x0, const double _y0,
+    const double _x1, const double _y1, const double _zMin, const double _zMax)
+{
+  this->dynamicSegments.Add(_x0, _y0, _x1, _y1, _zMin, _zMax);
+}
+
+/////////////////////////////////////////////////
+void LidarRaycaster::AddDynamicCircle(const double _x, const double _y,
+    const double _radius, const double _zMin, const double _zMax)
+{
+  this->circleX.push_back(_x);
+  this->circleY.push_back(_y);
+  this->circleRadius.push_back(_radius);
+  this->circleZMin.push_back(_zMin);
+  this->circleZMax.push_back(_zMax);
+}
+
+/////////////////////////////////////////////////
+double LidarRaycaster::Closest(const Segments &_segments, const size_t _begin,
+    const size_t _end, const double _x, const double _y, const double _z,
+    const double _dirX, const double _dirY, const double _minRange,
+    double _best)
+{
+  const double *x = _segments.x.data();
+  const double *y = _segments.y.data();
+  const double *dx = _segments.dx.data();
+  const double *dy = _segments.dy.data();
+  const double *zMin = _segments.zMin.data();
+  const double *zMax = _segments.zMax.data();
+
+  // Misses become infinite distances folded in with a min, and the hit
+  // test doesn't short-circuit. Parallel segments divide by zero, which
+  // gives infinities or NaNs that fail all comparisons. Compilers won't
+  // vectorize this min reduction without -ffinite-math-only, which would
+  // break that.
+  const double inf = std::numeric_limits<double>::infinity();
+  for (size_t i = _begin; i < _end; ++i)
+  {
+    double wx = x[i] - _x;
+    double wy = y[i] - _y;
+    double inv = 1.0 / (_dirX * dy[i] - _dirY * dx[i]);
+    double t = (wx * dy[i] - wy * dx[i]) * inv;
+    double s = (wx * _dirY - wy * _dirX) * inv;
+
+    bool hit = (t >= _minRange) & (s >= 0.0) & (s <= 1.0) &
+        (_z >= zMin[i]) & (_z <= zMax[i]);
+    double candidate = hit ? t : inf;
+    _best = candidate < _best ? candidate : _best;
+  }
+
+  return _best;
+}
+
+/////////////////////////////////////////////////
+double LidarRaycaster::Cast(const double _x, const double _y, const double _z,
+    const double _angle, const double _minRange, const double _maxRange) const
+{
+  double dirX = std::cos(_angle);
+  double dirY = std::sin(_angle);
+  double best = _maxRange;
+
+  // Walk the static grid
+  if (this->columns > 0)
+  {
+    auto inf = std::numeric_limits<double>::infinity();
+    double maxX = this->gridX + this->columns * this->cellSize;
+    double maxY = this->gridY + this->rows * this->cellSize;
+
+    // Clip the ray to the grid's box
+    double tEnter = 0.0;
+    double tExit = _maxRange;
+    bool inside = true;
+    if (std::abs(dirX) > 1e-12)
+    {
+      double t0 = (this->gridX - _x) / dirX;
+      double t1 = (maxX - _x) / dirX;
+      tEnter = std::max(tEnter, std::min(t0, t1));
+      tExit = std::min(tExit, std::max(t0, t1));
+    }
+    else if (_x < this->gridX || _x > maxX)
+    {
+      inside = false;
+    }
+    if (std::abs(dirY) > 1e-12)
+    {
+      double t0 = (this->gridY - _y) / dirY;
+      double t1 = (maxY - _y) / dirY;
+      tEnter = std::max(tEnter, std::min(t0, t1));
+      tExit = std::min(tExit, std::max(t0, t1));
+    }
+    else if (_y < this->gridY || _y > maxY)
+    {
+      inside = false;
+    }
+
+    if (inside && tEnter <= tExit)
+    {
+      double px = _x + dirX * tEnter;
+      double py = _y + dirY * tEnter;
+      auto col = std::max<int64_t>(0, std::min<int64_t>(this->columns - 1,
+          static_cast<int64_t>(std::floor((px - this->gridX) /
+          this->cellSize))));
+      auto row = std::max<int64_t>(0, std::min<int64_t>(this->rows - 1,
+          static_cast<int64_t>(std::floor((py - this->gridY) /
+          this->cellSize))));
+
+      int64_t stepX = dirX > 0 ? 1 : -1;
+      int64_t stepY = dirY > 0 ? 1 : -1;
+
+      // Distance along the ray to the next column and row boundaries
+      double tMaxX = inf;
+      double tDeltaX = inf;
+      if (std::abs(dirX) > 1e-12)
+      {
+        double edge = this->gridX + (col + (stepX > 0 ? 1 : 0)) *
+            this->cellSize;
+        tMaxX = (edge - _x) / dirX;
+        tDeltaX = this->cellSize / std::abs(dirX);
+      }
+      double tMaxY = inf;
+      double tDeltaY = inf;
+      if (std::abs(dirY) > 1e-12)
+      {
+        double edge = this->gridY + (row + (stepY > 0 ? 1 : 0)) *
+            this->cellSize;
+        tMaxY = (edge - _y) / dirY;
+        tDeltaY = this->cellSize / std::abs(dirY);
+      }
+
+      while (col >= 0 && col < this->columns && row >= 0 && row < this->rows)
+      {
+        auto cell = row * this->columns + col;
+        best = Closest(this->binned, this->cellStart[cell],
+            this->cellStart[cell + 1], _x, _y, _z, dirX, dirY, _minRange,
+            best);
+
+        // A hit inside this cell can't be beaten by cells further along
+        double cellExit = std::min(tMaxX, tMaxY);
+        if (best <= cellExit || cellExit > tExit)
+          break;
+
+        if (tMaxX < tMaxY)
+        {
+          col += stepX;
+          tMaxX += tDeltaX;
+        }
+        else
+        {
+          row += stepY;
+          tMaxY += tDeltaY;
+        }
+      }
+    }
+  }
+
+  // Dynamic geometry
+  best = Closest(this->dynamicSegments, 0, this->dynamicSegments.x.size(),
+      _x, _y, _z, dirX, dirY, _minRange, best);
+
+  for (size_t i = 0; i < this->circleX.size(); ++i)
+  {
+    if (_z < this->circleZMin[i] || _z > this->circleZMax[i])
+      continue;
+
+    double wx = this->circleX[i] - _x;
+    double wy = this->circleY[i] - _y;
+    double b = wx * dirX + wy * dirY;
+    double c = wx * wx + wy * wy -
+        this->circleRadius[i] * this->circleRadius[i];
+
+    // Origin inside the circle, or circle behind the ray
+    if (c < 0.0 || b < 0.0)
+      continue;
+
+    double disc = b * b - c;
+    if (disc < 0.0)
+      continue;
+
+    double t = b - std::sqrt(disc);
+    if (t >= _minRange && t < best)
+      best = t;
+  }
+
+  return best;
+}
+
+/////////////////////////////////////////////////
+bool LidarRaycaster::WayClear(const double _x0, const double _y0,
+    const double _x1, const double _y1, const double _z,
+    const double _halfWidth) const
+{
+  auto dx = _x1 - _x0;
+  auto dy = _y1 - _y0;
+  auto length = std::hypot(dx, dy);
+  if (length < 1e-6)
+    return true;
+
+  auto angle = std::atan2(dy, dx);
+  auto sideX = -dy / length * _halfWidth;
+  auto sideY = dx / length * _halfWidth;
+  for (int side = -1; side <= 1; ++side)
+  {
+    auto range = this->Cast(_x0 + side * sideX, _y0 + side * sideY, _z,
+        angle, 0.0, length);
+    if (range < length - 1e-3)
+      return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LidarRaycaster::Scan(const double _x, const double _y, const double _z,
+    const double _yaw, const double _minAngle, const double _increment,
+    const double _minRange, const double _maxRange,
+    const unsigned int _threads, std::vector<float> &_ranges) const
+{
+  auto count = _ranges.size();
+
+  auto castRange = [&](const size_t _begin, const size_t _end)
+  {
+    for (size_t i = _begin; i < _end; ++i)
+    {
+      auto range = this->Cast(_x, _y, _z,
+          _yaw + _minAngle + i * _increment, _minRange, _maxRange);
+      _ranges[i] = range >= _maxRange ?
+          std::numeric_limits<float>::infinity() : static_cast<float>(range);
+    }
+  };
+
+  auto threads = std::max(1u, std::min<unsigned int>(_threads, count));
+  if (threads == 1)
+  {
+    castRange(0, count);
+    return;
+  }
+
+  // Threads are kept between scans, and only recreated if the count changes
+  if (!this->workers || this->workers->ThreadCount() != threads - 1)
+    this->workers.reset(new WorkerPool(threads - 1));
+
+  // Contiguous chunks of rays, one per thread
+  auto chunk = (count + threads - 1) / threads;
+  this->workers->Run(threads, [&](const unsigned int _chunk)
+  {
+    castRange(std::min(count, _chunk * chunk),
+        std::min(count, (_chunk + 1) * chunk));
+  });
+}
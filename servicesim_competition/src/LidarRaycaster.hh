@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_LIDARRAYCASTER_HH_
+#define SERVICESIM_LIDARRAYCASTER_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "WorkerPool.hh"
+
+namespace servicesim
+{
+  /// \brief Casts horizontal rays against 2D geometry, without going through
+  /// the physics or rendering engines.
+  ///
+  /// Geometry is made of line segments on the XY plane, each valid between a
+  /// minimum and maximum height, plus circles for moving obstacles such as
+  /// actors. Static segments are binned into a uniform grid which rays walk
+  /// through cell by cell, stopping at the first cell holding a hit. Each
+  /// cell stores its own copy of its segments in contiguous arrays, so the
+  /// per-cell test walks memory linearly. Dynamic segments and circles are
+  /// few and are tested against every ray.
+  class LidarRaycaster
+  {
+    /// \brief Remove all static geometry.
+    public: void ClearStatic();
+
+    /// \brief Add a static segment. Call BuildStatic once all are added.
+    /// \param[in] _x0 X of the first end.
+    /// \param[in] _y0 Y of the first end.
+    /// \param[in] _x1 X of the second end.
+    /// \param[in] _y1 Y of the second end.
+    /// \param[in] _zMin Lowest height at which the segment is hit.
+    /// \param[in] _zMax Highest height at which the segment is hit.
+    public: void AddStaticSegment(const double _x0, const double _y0,
+        const double _x1, const double _y1, const double _zMin,
+        const double _zMax);
+
+    /// \brief Bin static segments into the grid.
+    /// \param[in] _cellSize Length of a grid cell's side in meters.
+    public: void BuildStatic(const double _cellSize = 1.0);
+
+    /// \brief Number of static segments.
+    /// \return Segment count.
+    public: size_t StaticSegmentCount() const;
+
+    /// \brief Remove all dynamic segments and circles.
+    public: void ClearDynamic();
+
+    /// \brief Add a dynamic segment, valid until ClearDynamic.
+    /// \param[in] _x0 X of the first end.
+    /// \param[in] _y0 Y of the first end.
+    /// \param[in] _x1 X of the second end.
+    /// \param[in] _y1 Y of the second end.
+    /// \param[in] _zMin Lowest height at which the segment is hit.
+    /// \param[in] _zMax Highest height at which the segment is hit.
+    public: void AddDynamicSegment(const double _x0, const double _y0,
+        const double _x1, const double _y1, const double _zMin,
+        const double _zMax);
+
+    /// \brief Add a dynamic circle, valid until ClearDynamic.
+    /// \param[in] _x X of the center.
+    /// \param[in] _y Y of the center.
+    /// \param[in] _radius Radius.
+    /// \param[in] _zMin Lowest height at which the circle is hit.
+    /// \param[in] _zMax Highest height at which the circle is hit.
+    public: void AddDynamicCircle(const double _x, const double _y,
+        const double _radius, const double _zMin, const double _zMax);
+
+    /// \brief Cast a fan of rays.
+    /// \param[in] _x X of the rays' origin.
+    /// \param[in] _y Y of the rays' origin.
+    /// \param[in] _z Height of the scan plane.
+    /// \param[in] _yaw Heading the angles are relative to.
+    /// \param[in] _minAngle Angle of the first ray.
+    /// \param[in] _increment Angle between consecutive rays.
+    /// \param[in] _minRange Hits closer than this are ignored.
+    /// \param[in] _maxRange Rays don't go past this distance.
+    /// \param[in] _threads Number of threads to split the rays between.
+    /// Threads are kept for the next scans, so Scan shouldn't be called
+    /// from several threads at once.
+    /// \param[out] _ranges Distance for each ray, infinity if nothing was hit
+    /// within range. Its size sets the number of rays.
+    public: void Scan(const double _x, const double _y, const double _z,
+        const double _yaw, const double _minAngle, const double _increment,
+        const double _minRange, const double _maxRange,
+        const unsigned int _threads, std::vector<float> &_ranges) const;
+
+    /// \brief Cast a single ray.
+    /// \param[in] _x X of the ray's origin.
+    /// \param[in] _y Y of the ray's origin.
+    /// \param[in] _z Height of the scan plane.
+    /// \param[in] _angle Ray direction.
+    /// \param[in] _minRange Hits closer than this are ignored.
+    /// \param[in] _maxRange Maximum distance.
+    /// \return Distance to the closest hit, or _maxRange if none.
+    public: double Cast(const double _x, const double _y, const double _z,
+        const double _angle, const double _minRange,
+        const double _maxRange) const;
+
+    /// \brief Whether a body can move straight between two points, tested
+    /// with rays along its center line and both sides.
+    /// \param[in] _x0 X of the start.
+    /// \param[in] _y0 Y of the start.
+    /// \param[in] _x1 X of the end.
+    /// \param[in] _y1 Y of the end.
+    /// \param[in] _z Height at which the way is tested.
+    /// \param[in] _halfWidth Half the body's width.
+    /// \return True if no ray hits anything before the end.
+    public: bool WayClear(const double _x0, const double _y0,
+        const double _x1, const double _y1, const double _z,
+        const double _halfWidth) const;
+
+    /// \brief Segments in structure-of-arrays layout, as a start point and
+    /// the vector to the end point.
+    private: struct Segments
+    {
+      /// \brief Start X
+      std::vector<double> x;
+
+      /// \brief Start Y
+      std::vector<double> y;
+
+      /// \brief Vector to the end, X
+      std::vector<double> dx;
+
+      /// \brief Vector to the end, Y
+      std::vector<double> dy;
+
+      /// \brief Lowest height
+      std::vector<double> zMin;
+
+      /// \brief Highest height
+      std::vector<double> zMax;
+
+      /// \brief Append a segment
+      void Add(const double _x0, const double _y0, const double _x1,
+          const double _y1, const double _zMin, const double _zMax);
+
+      /// \brief Remove all segments
+      void Clear();
+    };
+
+    /// \brief Closest hit against a range of segments.
+    /// \param[in] _segments Segments to test.
+    /// \param[in] _begin First segment index.
+    /// \param[in] _end One past the last segment index.
+    /// \param[in] _x X of the ray's origin.
+    /// \param[in] _y Y of the ray's origin.
+    /// \param[in] _z Height of the scan plane.
+    /// \param[in] _dirX Ray direction, X.
+    /// \param[in] _dirY Ray direction, Y.
+    /// \param[in] _minRange Hits closer than this are ignored.
+    /// \param[in] _best Closest hit so far.
+    /// \return Closest hit, or _best if none are closer.
+    private: static double Closest(const Segments &_segments,
+        const size_t _begin, const size_t _end, const double _x,
+        const double _y, const double _z, const double _dirX,
+        const double _dirY, const double _minRange, double _best);
+
+    /// \brief Static segments as added, before binning
+    private: Segments staticSegments;
+
+    /// \brief Static segments copied into each cell, cell after cell
+    private: Segments binned;
+
+    /// \brief Index in binned of each cell's first segment, with one extra
+    /// entry at the end
+    private: std::vector<uint32_t> cellStart;
+
+    /// \brief Minimum X of the grid
+    private: double gridX{0.0};
+
+    /// \brief Minimum Y of the grid
+    private: double gridY{0.0};
+
+    /// \brief Grid cell size
+    private: double cellSize{1.0};
+
+    /// \brief Number of cells along X
+    private: int64_t columns{0};
+
+    /// \brief Number of cells along Y
+    private: int64_t rows{0};
+
+    /// \brief Dynamic segments
+    private: Segments dynamicSegments;
+
+    /// \brief Dynamic circle centers, X
+    private: std::vector<double> circleX;
+
+    /// \brief Dynamic circle centers, Y
+    private: std::vector<double> circleY;
+
+    /// \brief Dynamic circle radii
+    private: std::vector<double> circleRadius;
+
+    /// \brief Dynamic circle lowest heights
+    private: std::vector<double> circleZMin;
+
+    /// \brief Dynamic circle highest heights
+    private: std::vector<double> circleZMax;
+
+    /// \brief Threads used by Scan, created on first use
+    private: mutable std::unique_ptr<WorkerPool> workers;
+  };
+}
+#endif
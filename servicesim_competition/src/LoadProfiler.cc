@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <gazebo/common/Console.hh>
+
+#include "LoadProfiler.hh"
+
+using namespace servicesim;
+
+/// \brief Time between two points in milliseconds
+static double Milliseconds(const LoadProfiler::Clock::time_point &_start,
+    const LoadProfiler::Clock::time_point &_end)
+{
+  return std::chrono::duration<double, std::milli>(_end - _start).count();
+}
+
+/// \brief Escape a string to be used within JSON quotes
+static std::string JsonEscape(const std::string &_str)
+{
+  std::string out;
+  for (auto c : _str)
+  {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    if (static_cast<unsigned char>(c) < 0x20)
+      continue;
+    out += c;
+  }
+  return out;
+}
+
+/////////////////////////////////////////////////
+LoadProfiler &LoadProfiler::Instance()
+{
+  static LoadProfiler instance;
+  return instance;
+}
+
+/////////////////////////////////////////////////
+void LoadProfiler::SetEnabled(const bool _enabled)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  if (_enabled && !this->enabled)
+  {
+    this->origin = Clock::now();
+    this->lastActivity = this->origin;
+  }
+  this->enabled = _enabled;
+}
+
+/////////////////////////////////////////////////
+bool LoadProfiler::Enabled() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->enabled;
+}
+
+/////////////////////////////////////////////////
+void LoadProfiler::Record(const std::string &_name,
+    const std::string &_category, const std::string &_detail,
+    const Clock::time_point &_start, const Clock::time_point &_end)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (!this->enabled)
+    return;
+
+  this->spans.push_back(
+      {_name, _category, _detail, _start, _end, std::this_thread::get_id()});
+  this->lastActivity = std::max(this->lastActivity, _end);
+}
+
+/////////////////////////////////////////////////
+LoadProfiler::Clock::time_point LoadProfiler::LastActivity() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->lastActivity;
+}
+
+/////////////////////////////////////////////////
+void LoadProfiler::Report(const std::string &_tracePath) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  // Aggregate spans with the same name
+  struct Total
+  {
+    std::string category;
+    unsigned int count{0};
+    double total{0.0};
+    double max{0.0};
+  };
+  std::map<std::string, Total> totals;
+  std::map<std::string, double> categories;
+  for (const auto &span : this->spans)
+  {
+    auto ms = Milliseconds(span.start, span.end);
+
+    auto &total = totals[span.name];
+    total.category = span.category;
+    total.count++;
+    total.total += ms;
+    total.max = std::max(total.max, ms);
+
+    categories[span.category] += ms;
+  }
+
+  std::vector<std::pair<std::string, Total>> sorted(totals.begin(),
+      totals.end());
+  std::sort(sorted.begin(), sorted.end(),
+      [](const std::pair<std::string, Total> &_a,
+         const std::pair<std::string, Total> &_b)
+      {
+        return _a.second.total > _b.second.total;
+      });
+
+  std::ostringstream report;
+  report << std::fixed << std::setprecision(1);
+  report << "[ServiceSim] Load profile, "
+         << Milliseconds(this->origin, this->lastActivity)
+         << " ms from server start until the last span:" << std::endl;
+  report << "  " << std::setw(10) << "total ms" << std::setw(10) << "max ms"
+         << std::setw(8) << "count" << "  name" << std::endl;
+  for (const auto &entry : sorted)
+  {
+    report << "  " << std::setw(10) << entry.second.total
+           << std::setw(10) << entry.second.max
+           << std::setw(8) << entry.second.count
+           << "  " << entry.first << " [" << entry.second.category << "]"
+           << std::endl;
+  }
+
+  // Slowest individual spans, with their details
+  std::vector<const Span *> slowest;
+  for (const auto &span : this->spans)
+    slowest.push_back(&span);
+  std::sort(slowest.begin(), slowest.end(),
+      [](const Span *_a, const Span *_b)
+      {
+        return (_a->end - _a->start) > (_b->end - _b->start);
+      });
+  if (slowest.size() > 10u)
+    slowest.resize(10u);
+
+  report << "  Slowest spans:" << std::endl;
+  for (const auto span : slowest)
+  {
+    report << "  " << std::setw(10) << Milliseconds(span->start, span->end)
+           << "  " << span->name;
+    if (!span->detail.empty())
+      report << " (" << span->detail << ")";
+    report << std::endl;
+  }
+
+  report << "  Per category:";
+  for (const auto &category : categories)
+    report << " " << category.first << " " << category.second << " ms;";
+  report << std::endl;
+
+  gzmsg << report.str();
+
+  if (_tracePath.empty())
+    return;
+
+  // Chrome trace event format, with complete ("X") events in microseconds
+  std::ofstream file(_tracePath);
+  if (!file.is_open())
+  {
+    gzerr << "Failed to open [" << _tracePath << "] to write load trace"
+          << std::endl;
+    return;
+  }
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+  for (size_t i = 0; i < this->spans.size(); ++i)
+  {
+    const auto &span = this->spans[i];
+    auto ts = std::chrono::duration_cast<std::chrono::microseconds>(
+        span.start - this->origin).count();
+    auto dur = std::chrono::duration_cast<std::chrono::microseconds>(
+        span.end - span.start).count();
+    auto tid = std::hash<std::thread::id>()(span.thread) % 100000;
+
+    file << "{\"name\":\"" << JsonEscape(span.name) << "\","
+         << "\"cat\":\"" << JsonEscape(span.category) << "\","
+         << "\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ","
+         << "\"ts\":" << ts << ",\"dur\":" << dur << ","
+         << "\"args\":{\"detail\":\"" << JsonEscape(span.detail) << "\"}}"
+         << (i + 1 < this->spans.size() ? "," : "") << std::endl;
+  }
+  file << "]}" << std::endl;
+
+  gzmsg << "[ServiceSim] Load trace written to [" << _tracePath << "]"
+        << std::endl;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_LOADPROFILER_HH_
+#define SERVICESIM_LOADPROFILER_HH_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace servicesim
+{
+  /// \brief Collects wall-clock spans recorded while the world is loading,
+  /// shared by all servicesim plugins.
+  ///
+  /// Recording is off until enabled, which is done by the
+  /// LoadProfilerPlugin system plugin, so plugins can be instrumented
+  /// unconditionally.
+  class LoadProfiler
+  {
+    /// \brief Clock used for all spans
+    public: using Clock = std::chrono::steady_clock;
+
+    /// \brief A recorded span
+    public: struct Span
+    {
+      /// \brief What was timed, such as "CompetitionPlugin::Load"
+      std::string name;
+
+      /// \brief Category, such as "plugin" or "model"
+      std::string category;
+
+      /// \brief Extra information, such as the model name
+      std::string detail;
+
+      /// \brief Start time
+      Clock::time_point start;
+
+      /// \brief End time
+      Clock::time_point end;
+
+      /// \brief Thread which recorded the span
+      std::thread::id thread;
+    };
+
+    /// \brief Get the profiler shared by all plugins.
+    /// \return The profiler.
+    public: static LoadProfiler &Instance();
+
+    /// \brief Start or stop recording.
+    /// \param[in] _enabled True to record.
+    public: void SetEnabled(const bool _enabled);
+
+    /// \brief Whether spans are being recorded.
+    /// \return True if recording.
+    public: bool Enabled() const;
+
+    /// \brief Record a span. Does nothing unless enabled.
+    /// \param[in] _name What was timed.
+    /// \param[in] _category Category used to group spans.
+    /// \param[in] _detail Extra information, may be empty.
+    /// \param[in] _start Start time.
+    /// \param[in] _end End time.
+    public: void Record(const std::string &_name, const std::string &_category,
+        const std::string &_detail, const Clock::time_point &_start,
+        const Clock::time_point &_end);
+
+    /// \brief End time of the latest span recorded, or the time recording
+    /// was enabled. Used to attribute the time between events.
+    /// \return Time point.
+    public: Clock::time_point LastActivity() const;
+
+    /// \brief Print a report sorted by total time and write all spans to a
+    /// Chrome trace file, which can be opened on chrome://tracing.
+    /// \param[in] _tracePath Path to the trace file, empty to skip it.
+    public: void Report(const std::string &_tracePath) const;
+
+    /// \brief Constructor, use Instance() instead.
+    private: LoadProfiler() = default;
+
+    /// \brief Protects all members
+    private: mutable std::mutex mutex;
+
+    /// \brief True while recording
+    private: bool enabled{false};
+
+    /// \brief Time recording was enabled
+    private: Clock::time_point origin;
+
+    /// \brief Latest span end time
+    private: Clock::time_point lastActivity;
+
+    /// \brief All spans recorded
+    private: std::vector<Span> spans;
+  };
+
+  /// \brief Records a span from its construction until it goes out of scope.
+  class LoadTimer
+  {
+    /// \brief Constructor
+    /// \param[in] _name What is being timed.
+    /// \param[in] _category Category used to group spans.
+    /// \param[in] _detail Extra information, such as the model name.
+    public: LoadTimer(const std::string &_name, const std::string &_category,
+        const std::string &_detail = "")
+        : name(_name), category(_category), detail(_detail),
+          start(LoadProfiler::Clock::now())
+    {
+    }
+
+    /// \brief Destructor, records the span
+    public: ~LoadTimer()
+    {
+      LoadProfiler::Instance().Record(this->name, this->category,
+          this->detail, this->start, LoadProfiler::Clock::now());
+    }
+
+    /// \brief What is being timed
+    private: std::string name;
+
+    /// \brief Category
+    private: std::string category;
+
+    /// \brief Extra information
+    private: std::string detail;
+
+    /// \brief Start time
+    private: LoadProfiler::Clock::time_point start;
+  };
+}
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/Actor.hh>
+#include <gazebo/physics/PhysicsIface.hh>
+#include <gazebo/physics/World.hh>
+
+#include "LoadProfiler.hh"
+#include "LoadProfilerPlugin.hh"
+
+/////////////////////////////////////////////////
+class servicesim::LoadProfilerPluginPrivate
+{
+  /// \brief Event connections
+  public: std::vector<gazebo::event::ConnectionPtr> connections;
+
+  /// \brief Path to the Chrome trace file
+  public: std::string tracePath{"/tmp/servicesim_load_trace.json"};
+
+  /// \brief Model whose insertion ends profiling, empty for none
+  public: std::string untilModel;
+
+  /// \brief Wall-clock seconds after which profiling ends, zero for none
+  public: double untilSeconds{0.0};
+
+  /// \brief Time profiling started
+  public: LoadProfiler::Clock::time_point start;
+
+  /// \brief True once untilModel has been inserted
+  public: bool modelInserted{false};
+
+  /// \brief Start of the latest world update while waiting, so the time
+  /// simulating isn't counted towards entities inserted later
+  public: LoadProfiler::Clock::time_point lastUpdate;
+
+  /// \brief True once the report has been printed
+  public: bool done{false};
+};
+
+using namespace servicesim;
+GZ_REGISTER_SYSTEM_PLUGIN(servicesim::LoadProfilerPlugin)
+
+/////////////////////////////////////////////////
+LoadProfilerPlugin::LoadProfilerPlugin()
+    : dataPtr(new LoadProfilerPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+void LoadProfilerPlugin::Load(int /*_argc*/, char ** /*_argv*/)
+{
+  auto path = std::getenv("SERVICESIM_LOAD_TRACE");
+  if (path)
+    this->dataPtr->tracePath = path;
+
+  auto model = std::getenv("SERVICESIM_LOAD_UNTIL_MODEL");
+  if (model)
+    this->dataPtr->untilModel = model;
+
+  auto seconds = std::getenv("SERVICESIM_LOAD_SECONDS");
+  if (seconds)
+    this->dataPtr->untilSeconds = std::strtod(seconds, nullptr);
+
+  this->dataPtr->start = LoadProfiler::Clock::now();
+  LoadProfiler::Instance().SetEnabled(true);
+}
+
+/////////////////////////////////////////////////
+void LoadProfilerPlugin::Init()
+{
+  this->dataPtr->connections.push_back(
+      gazebo::event::Events::ConnectAddEntity(
+      std::bind(&LoadProfilerPlugin::OnAddEntity, this,
+      std::placeholders::_1)));
+
+  this->dataPtr->connections.push_back(
+      gazebo::event::Events::ConnectWorldUpdateBegin(
+      std::bind(&LoadProfilerPlugin::OnUpdate, this)));
+
+  gzmsg << "[ServiceSim] Profiling world load" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void LoadProfilerPlugin::OnAddEntity(const std::string &_name)
+{
+  if (this->dataPtr->done)
+    return;
+
+  auto &profiler = LoadProfiler::Instance();
+  auto now = LoadProfiler::Clock::now();
+
+  std::string category{"entity"};
+  auto world = gazebo::physics::get_world();
+  if (world)
+  {
+    auto model = world->ModelByName(_name);
+    if (boost::dynamic_pointer_cast<gazebo::physics::Actor>(model))
+      category = "actor";
+    else if (model)
+      category = "model";
+  }
+
+  profiler.Record("insert " + category, category, _name,
+      std::max(profiler.LastActivity(), this->dataPtr->lastUpdate), now);
+
+  // Its plugins are loaded after it's announced, so wait for the next
+  // world update to end profiling
+  if (_name == this->dataPtr->untilModel)
+    this->dataPtr->modelInserted = true;
+}
+
+/////////////////////////////////////////////////
+void LoadProfilerPlugin::OnUpdate()
+{
+  if (this->dataPtr->done)
+    return;
+
+  bool waitModel = !this->dataPtr->untilModel.empty();
+  bool waitTime = this->dataPtr->untilSeconds > 0;
+
+  if (waitModel && this->dataPtr->modelInserted)
+  {
+    gzmsg << "[ServiceSim] Model [" << this->dataPtr->untilModel
+          << "] loaded, ending load profiling" << std::endl;
+  }
+  else if (waitTime && std::chrono::duration<double>(
+      LoadProfiler::Clock::now() - this->dataPtr->start).count() >=
+      this->dataPtr->untilSeconds)
+  {
+    gzmsg << "[ServiceSim] " << this->dataPtr->untilSeconds
+          << " s elapsed, ending load profiling" << std::endl;
+  }
+  else if (waitModel || waitTime)
+  {
+    this->dataPtr->lastUpdate = LoadProfiler::Clock::now();
+    return;
+  }
+
+  this->dataPtr->done = true;
+
+  auto &profiler = LoadProfiler::Instance();
+  profiler.Report(this->dataPtr->tracePath);
+  profiler.SetEnabled(false);
+
+  // No need to keep listening
+  this->dataPtr->connections.clear();
+}
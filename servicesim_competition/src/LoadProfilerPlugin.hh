@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_LOADPROFILERPLUGIN_HH_
+#define SERVICESIM_LOADPROFILERPLUGIN_HH_
+
+#include <memory>
+#include <string>
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class LoadProfilerPluginPrivate;
+
+  /// \brief A system plugin which profiles world loading.
+  ///
+  /// It enables the LoadProfiler, records the time taken to insert each
+  /// model and actor, and prints a report once loading is over.
+  /// Servicesim plugins record their own Load() calls.
+  ///
+  /// By default loading is over when the first world update starts. Models
+  /// spawned later, such as the robot, can be waited for by setting the
+  /// SERVICESIM_LOAD_UNTIL_MODEL environment variable to a model name.
+  /// Profiling then ends on the first world update after that model was
+  /// inserted, once its plugins have loaded. SERVICESIM_LOAD_SECONDS sets
+  /// the wall-clock seconds after which profiling ends in any case, also
+  /// checked on world updates. When both are set, whichever comes first
+  /// ends profiling.
+  ///
+  /// Model and actor spans go from the end of the previous recorded span
+  /// until Gazebo announces the entity, so they include SDF processing and
+  /// mesh, skin and animation loading for that entity.
+  ///
+  /// Load it with `gzserver -s libLoadProfilerPlugin.so`. The Chrome trace
+  /// is written to the path in the SERVICESIM_LOAD_TRACE environment
+  /// variable, defaulting to /tmp/servicesim_load_trace.json.
+  class LoadProfilerPlugin : public gazebo::SystemPlugin
+  {
+    /// \brief Constructor
+    public: LoadProfilerPlugin();
+
+    // Documentation inherited
+    public: void Load(int _argc = 0, char **_argv = nullptr) override;
+
+    // Documentation inherited
+    public: void Init() override;
+
+    /// \brief Called when an entity is added to the world.
+    /// \param[in] _name Scoped entity name.
+    private: void OnAddEntity(const std::string &_name);
+
+    /// \brief Called on world updates to print the report once loading is
+    /// over.
+    private: void OnUpdate();
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<LoadProfilerPluginPrivate> dataPtr;
+  };
+}
+#endif
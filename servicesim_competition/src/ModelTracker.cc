@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gazebo/physics/Model.hh>
+#include <gazebo/physics/World.hh>
+
+#include "ModelTracker.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+bool ModelTracker::Changed(const gazebo::physics::WorldPtr &_world)
+{
+  auto count = _world->ModelCount();
+  bool changed = this->first || count != this->ids.size();
+  this->first = false;
+
+  // IDs are never reused, so a replaced model always differs
+  this->ids.resize(count);
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    auto model = _world->ModelByIndex(i);
+    uint32_t id = model ? model->GetId() : 0u;
+    if (id != this->ids[i])
+    {
+      this->ids[i] = id;
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
+/////////////////////////////////////////////////
+void ModelTracker::Reset()
+{
+  this->ids.clear();
+  this->first = true;
+}
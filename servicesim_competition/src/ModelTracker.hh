@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_MODELTRACKER_HH_
+#define SERVICESIM_MODELTRACKER_HH_
+
+#include <cstdint>
+#include <vector>
+
+#include <gazebo/physics/PhysicsTypes.hh>
+
+namespace servicesim
+{
+  /// \brief Tells when the set of models in a world changed, by comparing
+  /// model IDs instead of the model count, so a model removed and another
+  /// one inserted between two checks, such as streamed furniture, is seen.
+  class ModelTracker
+  {
+    /// \brief Check the world's models against the last call.
+    /// \param[in] _world Pointer to the world.
+    /// \return True if models were inserted or removed since the last call,
+    /// and on the first call.
+    public: bool Changed(const gazebo::physics::WorldPtr &_world);
+
+    /// \brief Forget the models seen, so the next check reports a change.
+    public: void Reset();
+
+    /// \brief ID of each model, in world order, on the last check
+    private: std::vector<uint32_t> ids;
+
+    /// \brief True until the first check
+    private: bool first{true};
+  };
+}
+#endif
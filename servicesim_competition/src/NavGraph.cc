@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include "NavGraph.hh"
+
+using namespace servicesim;
+
+const uint16_t NavGraph::kNone;
+
+/// \brief Length of the segment between two points on the XY plane
+/// \param[in] _a First point.
+/// \param[in] _b Second point.
+/// \return Length.
+static float Length2d(const ignition::math::Vector3d &_a,
+    const ignition::math::Vector3d &_b)
+{
+  return static_cast<float>(std::hypot(_b.X() - _a.X(), _b.Y() - _a.Y()));
+}
+
+/////////////////////////////////////////////////
+size_t NavGraph::AddNode(const ignition::math::Vector3d &_pos,
+    const std::string &_name)
+{
+  auto index = this->positions.size();
+  this->positions.push_back(_pos);
+  this->names.push_back(_name);
+  this->adjacency.emplace_back();
+  this->nextHops.clear();
+  this->distances.clear();
+  if (!_name.empty())
+    this->destinations.push_back(index);
+  return index;
+}
+
+/////////////////////////////////////////////////
+bool NavGraph::AddEdge(const size_t _a, const size_t _b)
+{
+  if (_a == _b || _a >= this->positions.size() ||
+      _b >= this->positions.size() || this->HasEdge(_a, _b))
+  {
+    return false;
+  }
+
+  auto length = Length2d(this->positions[_a], this->positions[_b]);
+  this->adjacency[_a].push_back({static_cast<uint16_t>(_b), length});
+  this->adjacency[_b].push_back({static_cast<uint16_t>(_a), length});
+  this->edgeCount++;
+  this->nextHops.clear();
+  this->distances.clear();
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool NavGraph::HasEdge(const size_t _a, const size_t _b) const
+{
+  if (_a >= this->adjacency.size())
+    return false;
+
+  for (const auto &neighbor : this->adjacency[_a])
+  {
+    if (neighbor.first == _b)
+      return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+size_t NavGraph::ConnectNearby(const double _distance,
+    const std::function<bool(const ignition::math::Vector3d &,
+    const ignition::math::Vector3d &)> &_clear)
+{
+  size_t added{0};
+  auto count = this->positions.size();
+  for (size_t a = 0; a < count; ++a)
+  {
+    const auto &posA = this->positions[a];
+    for (size_t b = a + 1; b < count; ++b)
+    {
+      const auto &posB = this->positions[b];
+      if (Length2d(posA, posB) > _distance || this->HasEdge(a, b))
+        continue;
+
+      if (_clear(posA, posB) && this->AddEdge(a, b))
+        added++;
+    }
+  }
+  return added;
+}
+
+/////////////////////////////////////////////////
+bool NavGraph::Build()
+{
+  auto count = this->positions.size();
+  if (count >= kNone)
+    return false;
+
+  this->nextHops.assign(count * count, kNone);
+  this->distances.assign(count * count,
+      std::numeric_limits<float>::infinity());
+
+  // Dijkstra from every node, recording the first hop taken to reach each
+  // other node
+  using Entry = std::pair<float, uint16_t>;
+  for (size_t source = 0; source < count; ++source)
+  {
+    auto *dist = &this->distances[source * count];
+    auto *hop = &this->nextHops[source * count];
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>
+        queue;
+    dist[source] = 0.0f;
+    hop[source] = static_cast<uint16_t>(source);
+    queue.push({0.0f, static_cast<uint16_t>(source)});
+
+    while (!queue.empty())
+    {
+      auto top = queue.top();
+      queue.pop();
+
+      auto node = top.second;
+      if (top.first > dist[node])
+        continue;
+
+      for (const auto &neighbor : this->adjacency[node])
+      {
+        auto candidate = top.first + neighbor.second;
+        if (candidate >= dist[neighbor.first])
+          continue;
+
+        dist[neighbor.first] = candidate;
+        hop[neighbor.first] = node == source ? neighbor.first : hop[node];
+        queue.push({candidate, neighbor.first});
+      }
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+size_t NavGraph::NodeCount() const
+{
+  return this->positions.size();
+}
+
+/////////////////////////////////////////////////
+size_t NavGraph::EdgeCount() const
+{
+  return this->edgeCount;
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Vector3d &NavGraph::Position(const size_t _index) const
+{
+  return this->positions[_index];
+}
+
+/////////////////////////////////////////////////
+const std::string &NavGraph::Name(const size_t _index) const
+{
+  return this->names[_index];
+}
+
+/////////////////////////////////////////////////
+const std::vector<size_t> &NavGraph::Destinations() const
+{
+  return this->destinations;
+}
+
+/////////////////////////////////////////////////
+uint16_t NavGraph::NextHop(const size_t _from, const size_t _to) const
+{
+  auto count = this->positions.size();
+  if (_from >= count || _to >= count || this->nextHops.empty())
+    return kNone;
+
+  return this->nextHops[_from * count + _to];
+}
+
+/////////////////////////////////////////////////
+float NavGraph::Distance(const size_t _from, const size_t _to) const
+{
+  auto count = this->positions.size();
+  if (_from >= count || _to >= count || this->distances.empty())
+    return std::numeric_limits<float>::infinity();
+
+  return this->distances[_from * count + _to];
+}
+
+/////////////////////////////////////////////////
+uint16_t NavGraph::Nearest(const ignition::math::Vector3d &_pos) const
+{
+  uint16_t nearest{kNone};
+  float best{std::numeric_limits<float>::infinity()};
+  for (size_t i = 0; i < this->positions.size(); ++i)
+  {
+    auto length = Length2d(_pos, this->positions[i]);
+    if (length < best)
+    {
+      best = length;
+      nearest = static_cast<uint16_t>(i);
+    }
+  }
+  return nearest;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_NAVGRAPH_HH_
+#define SERVICESIM_NAVGRAPH_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+namespace servicesim
+{
+  /// \brief A graph of walkable waypoints with the shortest routes between
+  /// all of them precomputed, so following a route costs a table lookup per
+  /// hop.
+  ///
+  /// Edges are undirected and weighted by their length on the XY plane.
+  /// Named nodes are destinations, such as rooms. Routes are stored as a
+  /// table of next hops, one 16-bit entry per pair of nodes.
+  class NavGraph
+  {
+    /// \brief Next hop when there's no route
+    public: static const uint16_t kNone = 0xFFFF;
+
+    /// \brief Add a node. Routes are dropped until built again.
+    /// \param[in] _pos Node position.
+    /// \param[in] _name Destination name, empty if it isn't one.
+    /// \return Node index.
+    public: size_t AddNode(const ignition::math::Vector3d &_pos,
+        const std::string &_name = "");
+
+    /// \brief Connect two nodes both ways. Routes are dropped until built
+    /// again.
+    /// \param[in] _a First node index.
+    /// \param[in] _b Second node index.
+    /// \return False if the indices are invalid or the nodes are already
+    /// connected.
+    public: bool AddEdge(const size_t _a, const size_t _b);
+
+    /// \brief Whether two nodes are connected by an edge.
+    /// \param[in] _a First node index.
+    /// \param[in] _b Second node index.
+    /// \return True if connected.
+    public: bool HasEdge(const size_t _a, const size_t _b) const;
+
+    /// \brief Connect all pairs of nodes closer than a distance on the XY
+    /// plane, which aren't connected yet, if the way between them is clear.
+    /// Routes are dropped until built again.
+    /// \param[in] _distance Maximum distance between connected nodes.
+    /// \param[in] _clear Whether the way between two node positions is
+    /// clear, such as LidarRaycaster::WayClear.
+    /// \return Number of edges added.
+    public: size_t ConnectNearby(const double _distance,
+        const std::function<bool(const ignition::math::Vector3d &,
+        const ignition::math::Vector3d &)> &_clear);
+
+    /// \brief Compute the shortest routes between all pairs of nodes.
+    /// \return False if there are too many nodes for the table.
+    public: bool Build();
+
+    /// \brief Number of nodes.
+    /// \return Node count.
+    public: size_t NodeCount() const;
+
+    /// \brief Number of edges.
+    /// \return Edge count.
+    public: size_t EdgeCount() const;
+
+    /// \brief Get a node's position.
+    /// \param[in] _index Node index.
+    /// \return Position.
+    public: const ignition::math::Vector3d &Position(const size_t _index)
+        const;
+
+    /// \brief Get a node's destination name.
+    /// \param[in] _index Node index.
+    /// \return Name, empty if the node isn't a destination.
+    public: const std::string &Name(const size_t _index) const;
+
+    /// \brief Indices of all named nodes.
+    /// \return Destination indices.
+    public: const std::vector<size_t> &Destinations() const;
+
+    /// \brief Next node on the shortest route between two nodes.
+    /// \param[in] _from Current node index.
+    /// \param[in] _to Destination node index.
+    /// \return Next node index, _to if already there, or kNone if there's
+    /// no route.
+    public: uint16_t NextHop(const size_t _from, const size_t _to) const;
+
+    /// \brief Length of the shortest route between two nodes.
+    /// \param[in] _from Start node index.
+    /// \param[in] _to Destination node index.
+    /// \return Length on the XY plane, infinity if there's no route.
+    public: float Distance(const size_t _from, const size_t _to) const;
+
+    /// \brief Node closest to a position on the XY plane.
+    /// \param[in] _pos Position.
+    /// \return Node index, or kNone if the graph is empty.
+    public: uint16_t Nearest(const ignition::math::Vector3d &_pos) const;
+
+    /// \brief Node positions
+    private: std::vector<ignition::math::Vector3d> positions;
+
+    /// \brief Node names
+    private: std::vector<std::string> names;
+
+    /// \brief Named nodes
+    private: std::vector<size_t> destinations;
+
+    /// \brief Neighbors of each node, with the edge length
+    private: std::vector<std::vector<std::pair<uint16_t, float>>> adjacency;
+
+    /// \brief Number of edges
+    private: size_t edgeCount{0};
+
+    /// \brief Next hop for each pair of nodes, row per start node
+    private: std::vector<uint16_t> nextHops;
+
+    /// \brief Route length for each pair of nodes, row per start node
+    private: std::vector<float> distances;
+  };
+}
+#endif
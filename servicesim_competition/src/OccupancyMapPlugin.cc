@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/common/Image.hh>
+#include <gazebo/physics/World.hh>
+
+#include <nav_msgs/OccupancyGrid.h>
+#include <ros/ros.h>
+
+#include "LoadProfiler.hh"
+#include "OccupancyMapPlugin.hh"
+#include "OccupancyRasterizer.hh"
+#include "StaticGeometry.hh"
+
+/////////////////////////////////////////////////
+class servicesim::OccupancyMapPluginPrivate
+{
+  /// \brief Pointer to the world
+  public: gazebo::physics::WorldPtr world;
+
+  /// \brief Connection to world update, released once the map is generated
+  public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+  /// \brief ROS node handle
+  public: std::unique_ptr<ros::NodeHandle> rosNode{nullptr};
+
+  /// \brief Latched map publisher
+  public: ros::Publisher rosPub;
+
+  /// \brief The map
+  public: nav_msgs::OccupancyGrid msg;
+
+  /// \brief Cell side length
+  public: double resolution{0.05};
+
+  /// \brief Bottom of the height band
+  public: double minHeight{0.1};
+
+  /// \brief Top of the height band
+  public: double maxHeight{1.5};
+
+  /// \brief True if the map's corners were given
+  public: bool hasBounds{false};
+
+  /// \brief Minimum corner of the map
+  public: ignition::math::Vector2d min;
+
+  /// \brief Maximum corner of the map
+  public: ignition::math::Vector2d max;
+
+  /// \brief Padding around footprints when bounds aren't given
+  public: double padding{1.0};
+
+  /// \brief Threads to fill the grid with
+  public: unsigned int threads{1};
+
+  /// \brief Path of the output files, without extension
+  public: std::string output;
+};
+
+using namespace servicesim;
+GZ_REGISTER_WORLD_PLUGIN(servicesim::OccupancyMapPlugin)
+
+/////////////////////////////////////////////////
+OccupancyMapPlugin::OccupancyMapPlugin()
+    : dataPtr(new OccupancyMapPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+void OccupancyMapPlugin::Load(gazebo::physics::WorldPtr _world,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("OccupancyMapPlugin::Load", "plugin");
+
+  this->dataPtr->world = _world;
+
+  if (_sdf->HasElement("resolution"))
+  {
+    auto resolution = _sdf->Get<double>("resolution");
+    if (resolution > 0)
+      this->dataPtr->resolution = resolution;
+  }
+
+  if (_sdf->HasElement("min_height"))
+    this->dataPtr->minHeight = _sdf->Get<double>("min_height");
+
+  if (_sdf->HasElement("max_height"))
+    this->dataPtr->maxHeight = _sdf->Get<double>("max_height");
+
+  if (_sdf->HasElement("min") && _sdf->HasElement("max"))
+  {
+    auto min = _sdf->Get<ignition::math::Vector3d>("min");
+    auto max = _sdf->Get<ignition::math::Vector3d>("max");
+    this->dataPtr->min.Set(std::min(min.X(), max.X()),
+        std::min(min.Y(), max.Y()));
+    this->dataPtr->max.Set(std::max(min.X(), max.X()),
+        std::max(min.Y(), max.Y()));
+    this->dataPtr->hasBounds = true;
+  }
+
+  if (_sdf->HasElement("padding"))
+    this->dataPtr->padding = _sdf->Get<double>("padding");
+
+  this->dataPtr->threads = std::max(1u, std::thread::hardware_concurrency());
+  if (_sdf->HasElement("threads"))
+  {
+    this->dataPtr->threads =
+        std::max(1u, _sdf->Get<unsigned int>("threads"));
+  }
+
+  if (_sdf->HasElement("output"))
+    this->dataPtr->output = _sdf->Get<std::string>("output");
+
+  std::string topic{"/map"};
+  if (_sdf->HasElement("topic"))
+    topic = _sdf->Get<std::string>("topic");
+
+  this->dataPtr->msg.header.frame_id = "map";
+  if (_sdf->HasElement("frame"))
+    this->dataPtr->msg.header.frame_id = _sdf->Get<std::string>("frame");
+
+  // Files can still be written without ROS
+  if (!topic.empty())
+  {
+    if (!ros::isInitialized())
+    {
+      gzwarn << "A ROS node for Gazebo has not been initialized, the "
+             << "occupancy map won't be published on [" << topic << "]."
+             << std::endl;
+    }
+    else
+    {
+      this->dataPtr->rosNode.reset(new ros::NodeHandle());
+      this->dataPtr->rosPub =
+          this->dataPtr->rosNode->advertise<nav_msgs::OccupancyGrid>(
+          topic, 1, true);
+    }
+  }
+
+  // Collisions only have valid bounding boxes once the world is running
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateBegin(
+      std::bind(&OccupancyMapPlugin::OnUpdate, this));
+}
+
+/////////////////////////////////////////////////
+void OccupancyMapPlugin::Generate()
+{
+  auto start = std::chrono::steady_clock::now();
+
+  OccupancyRasterizer rasterizer;
+  for (const auto &footprint :
+      staticFootprints(this->dataPtr->world, nullptr))
+  {
+    if (footprint.zMax < this->dataPtr->minHeight ||
+        footprint.zMin > this->dataPtr->maxHeight)
+    {
+      continue;
+    }
+    rasterizer.AddPolygon(footprint.corners);
+  }
+
+  auto min = this->dataPtr->min;
+  auto max = this->dataPtr->max;
+  if (!this->dataPtr->hasBounds)
+  {
+    if (!rasterizer.Bounds(min, max))
+    {
+      gzwarn << "No static collisions within the height band, occupancy map "
+             << "not generated." << std::endl;
+      return;
+    }
+    auto padding = this->dataPtr->padding;
+    min.Set(min.X() - padding, min.Y() - padding);
+    max.Set(max.X() + padding, max.Y() + padding);
+  }
+
+  // Snap the origin to the grid, so maps of different worlds line up
+  auto resolution = this->dataPtr->resolution;
+  min.Set(std::floor(min.X() / resolution) * resolution,
+      std::floor(min.Y() / resolution) * resolution);
+  auto width = static_cast<unsigned int>(
+      std::ceil((max.X() - min.X()) / resolution));
+  auto height = static_cast<unsigned int>(
+      std::ceil((max.Y() - min.Y()) / resolution));
+
+  auto &msg = this->dataPtr->msg;
+  rasterizer.Rasterize(min, resolution, width, height,
+      this->dataPtr->threads, msg.data);
+
+  auto simTime = this->dataPtr->world->SimTime();
+  msg.header.stamp.sec = simTime.sec;
+  msg.header.stamp.nsec = simTime.nsec;
+  msg.info.map_load_time = msg.header.stamp;
+  msg.info.resolution = resolution;
+  msg.info.width = width;
+  msg.info.height = height;
+  msg.info.origin.position.x = min.X();
+  msg.info.origin.position.y = min.Y();
+  msg.info.origin.position.z = 0.0;
+  msg.info.origin.orientation.w = 1.0;
+
+  auto ms = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+
+  gzmsg << "[ServiceSim] Generated " << width << " x " << height
+        << " occupancy map from " << rasterizer.PolygonCount()
+        << " static collisions in " << ms << " ms" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void OccupancyMapPlugin::Write() const
+{
+  const auto &msg = this->dataPtr->msg;
+  auto width = msg.info.width;
+  auto height = msg.info.height;
+
+  // Images start at the top row, which is the maximum Y, with occupied cells
+  // in black
+  std::vector<unsigned char> pixels(msg.data.size());
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    auto src = msg.data.data() + static_cast<size_t>(row) * width;
+    auto dst = pixels.data() + static_cast<size_t>(height - 1 - row) * width;
+    for (unsigned int col = 0; col < width; ++col)
+      dst[col] = src[col] == OccupancyRasterizer::kOccupied ? 0 : 254;
+  }
+
+  auto pngPath = this->dataPtr->output + ".png";
+  gazebo::common::Image image;
+  image.SetFromData(pixels.data(), width, height,
+      gazebo::common::Image::L_INT8);
+  image.SavePNG(pngPath);
+
+  auto yamlPath = this->dataPtr->output + ".yaml";
+  std::ofstream yaml(yamlPath);
+  if (!yaml.is_open())
+  {
+    gzerr << "Failed to open [" << yamlPath << "] to write the occupancy map"
+          << std::endl;
+    return;
+  }
+
+  // The image is referenced relative to the YAML file
+  auto imageName = pngPath.substr(pngPath.find_last_of('/') + 1);
+  yaml << "image: " << imageName << std::endl
+       << "resolution: " << msg.info.resolution << std::endl
+       << "origin: [" << msg.info.origin.position.x << ","
+       << msg.info.origin.position.y << ",0.0]" << std::endl
+       << "occupied_thresh: 0.7" << std::endl
+       << "free_thresh: 0.1" << std::endl
+       << "negate: 0" << std::endl;
+
+  gzmsg << "[ServiceSim] Occupancy map written to [" << yamlPath << "]"
+        << std::endl;
+}
+
+/////////////////////////////////////////////////
+void OccupancyMapPlugin::OnUpdate()
+{
+  // Only generate once
+  this->dataPtr->updateConnection.reset();
+
+  this->Generate();
+
+  if (this->dataPtr->msg.data.empty())
+    return;
+
+  if (!this->dataPtr->output.empty())
+    this->Write();
+
+  if (this->dataPtr->rosNode)
+    this->dataPtr->rosPub.publish(this->dataPtr->msg);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_OCCUPANCYMAPPLUGIN_HH_
+#define SERVICESIM_OCCUPANCYMAPPLUGIN_HH_
+
+#include <memory>
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class OccupancyMapPluginPrivate;
+
+  /// \brief A world plugin which generates an occupancy map from the static
+  /// collisions of the loaded world, so each generated world can have a map
+  /// which matches its doors and furniture.
+  ///
+  /// Once the world has started, the footprints of all static collisions
+  /// overlapping the height band are filled into the grid by an
+  /// OccupancyRasterizer. The map is then written as a map_server
+  /// YAML / PNG pair and published once as a latched
+  /// nav_msgs/OccupancyGrid. Streamed furniture is only mapped if it is in
+  /// the world at that time.
+  ///
+  /// The plugin has the following SDF description:
+  /// <resolution>   Cell side length in meters, defaults to 0.05.
+  /// <min_height>   Bottom of the height band in meters, defaults to 0.1.
+  /// <max_height>   Top of the height band in meters, defaults to 1.5.
+  /// <min>          Minimum corner of the map, defaults to the corner of the
+  ///                box holding all footprints, padded by <padding>.
+  /// <max>          Maximum corner of the map, same default as <min>.
+  /// <padding>      Free space around the footprints when <min> and <max>
+  ///                are not given, defaults to 1.
+  /// <threads>      Number of threads to fill the grid with, defaults to
+  ///                the number of cores.
+  /// <output>       Path without extension of the YAML and PNG files, such
+  ///                as /tmp/map. No files are written if not given.
+  /// <topic>        Topic to publish the grid on, defaults to /map. Empty to
+  ///                skip publishing.
+  /// <frame>        Frame of the grid, defaults to "map".
+  class OccupancyMapPlugin : public gazebo::WorldPlugin
+  {
+    /// \brief Constructor
+    public: OccupancyMapPlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::WorldPtr _world, sdf::ElementPtr _sdf)
+        override;
+
+    /// \brief Generate the map.
+    private: void Generate();
+
+    /// \brief Write the map to files.
+    private: void Write() const;
+
+    /// \brief Called on the first world update
+    private: void OnUpdate();
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<OccupancyMapPluginPrivate> dataPtr;
+  };
+}
+#endif
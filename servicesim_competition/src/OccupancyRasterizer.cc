@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "OccupancyRasterizer.hh"
+
+using namespace servicesim;
+
+const int8_t OccupancyRasterizer::kOccupied;
+const int8_t OccupancyRasterizer::kFree;
+
+/// \brief Tolerance in cells, so edges lying on cell borders don't spill
+/// into the next cell due to rounding
+static const double kEpsilon = 1e-6;
+
+/////////////////////////////////////////////////
+void OccupancyRasterizer::Clear()
+{
+  this->corners.clear();
+  this->polygonStart.assign(1, 0);
+  this->mins.clear();
+  this->maxs.clear();
+}
+
+/////////////////////////////////////////////////
+void OccupancyRasterizer::AddPolygon(
+    const std::vector<ignition::math::Vector2d> &_corners)
+{
+  if (_corners.size() < 3)
+    return;
+
+  ignition::math::Vector2d min(std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::max());
+  ignition::math::Vector2d max(std::numeric_limits<double>::lowest(),
+      std::numeric_limits<double>::lowest());
+  for (const auto &corner : _corners)
+  {
+    min.Set(std::min(min.X(), corner.X()), std::min(min.Y(), corner.Y()));
+    max.Set(std::max(max.X(), corner.X()), std::max(max.Y(), corner.Y()));
+    this->corners.push_back(corner);
+  }
+
+  this->polygonStart.push_back(this->corners.size());
+  this->mins.push_back(min);
+  this->maxs.push_back(max);
+}
+
+/////////////////////////////////////////////////
+size_t OccupancyRasterizer::PolygonCount() const
+{
+  return this->mins.size();
+}
+
+/////////////////////////////////////////////////
+bool OccupancyRasterizer::Bounds(ignition::math::Vector2d &_min,
+    ignition::math::Vector2d &_max) const
+{
+  if (this->mins.empty())
+    return false;
+
+  _min = this->mins[0];
+  _max = this->maxs[0];
+  for (size_t i = 1; i < this->mins.size(); ++i)
+  {
+    _min.Set(std::min(_min.X(), this->mins[i].X()),
+        std::min(_min.Y(), this->mins[i].Y()));
+    _max.Set(std::max(_max.X(), this->maxs[i].X()),
+        std::max(_max.Y(), this->maxs[i].Y()));
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+void OccupancyRasterizer::Rasterize(const ignition::math::Vector2d &_origin,
+    const double _resolution, const unsigned int _width,
+    const unsigned int _height, const unsigned int _threads,
+    std::vector<int8_t> &_cells) const
+{
+  _cells.assign(static_cast<size_t>(_width) * _height, kFree);
+  if (_width == 0 || _height == 0 || _resolution <= 0)
+    return;
+
+  // Each thread writes to its own band of rows
+  auto threads = std::max(1u, std::min(_threads, _height));
+  auto band = (_height + threads - 1) / threads;
+
+  std::vector<std::thread> workers;
+  for (unsigned int t = 1; t < threads; ++t)
+  {
+    auto begin = std::min(_height, t * band);
+    auto end = std::min(_height, begin + band);
+    workers.push_back(std::thread(&OccupancyRasterizer::RasterizeRows, this,
+        std::cref(_origin), _resolution, _width, begin, end,
+        std::ref(_cells)));
+  }
+
+  this->RasterizeRows(_origin, _resolution, _width, 0,
+      std::min(_height, band), _cells);
+
+  for (auto &worker : workers)
+    worker.join();
+}
+
+/////////////////////////////////////////////////
+void OccupancyRasterizer::RasterizeRows(
+    const ignition::math::Vector2d &_origin, const double _resolution,
+    const unsigned int _width, const int64_t _rowBegin,
+    const int64_t _rowEnd, std::vector<int8_t> &_cells) const
+{
+  for (size_t p = 0; p < this->mins.size(); ++p)
+  {
+    const auto &min = this->mins[p];
+    const auto &max = this->maxs[p];
+
+    // Rows the polygon overlaps, not counting those it only touches
+    auto rowMin = static_cast<int64_t>(
+        std::floor((min.Y() - _origin.Y()) / _resolution + kEpsilon));
+    auto rowMax = static_cast<int64_t>(
+        std::ceil((max.Y() - _origin.Y()) / _resolution - kEpsilon)) - 1;
+    rowMax = std::max(rowMin, rowMax);
+
+    rowMin = std::max(rowMin, _rowBegin);
+    rowMax = std::min(rowMax, _rowEnd - 1);
+    if (rowMin > rowMax)
+      continue;
+
+    auto begin = this->polygonStart[p];
+    auto end = this->polygonStart[p + 1];
+    auto count = end - begin;
+
+    for (auto row = rowMin; row <= rowMax; ++row)
+    {
+      // Part of the row's strip covered by the polygon
+      auto y0 = std::max(min.Y(), _origin.Y() + row * _resolution);
+      auto y1 = std::min(max.Y(), _origin.Y() + (row + 1) * _resolution);
+
+      // Extent along X of the polygon within the strip, from corners inside
+      // the strip and edges crossing its borders
+      double xMin{std::numeric_limits<double>::max()};
+      double xMax{std::numeric_limits<double>::lowest()};
+      for (size_t i = 0; i < count; ++i)
+      {
+        const auto &a = this->corners[begin + i];
+        const auto &b = this->corners[begin + (i + 1) % count];
+
+        if (a.Y() >= y0 && a.Y() <= y1)
+        {
+          xMin = std::min(xMin, a.X());
+          xMax = std::max(xMax, a.X());
+        }
+
+        auto dy = b.Y() - a.Y();
+        if (std::abs(dy) < 1e-12)
+          continue;
+
+        for (auto y : {y0, y1})
+        {
+          auto t = (y - a.Y()) / dy;
+          if (t < 0 || t > 1)
+            continue;
+
+          auto x = a.X() + t * (b.X() - a.X());
+          xMin = std::min(xMin, x);
+          xMax = std::max(xMax, x);
+        }
+      }
+
+      if (xMin > xMax)
+        continue;
+
+      auto colMin = static_cast<int64_t>(
+          std::floor((xMin - _origin.X()) / _resolution + kEpsilon));
+      auto colMax = static_cast<int64_t>(
+          std::ceil((xMax - _origin.X()) / _resolution - kEpsilon)) - 1;
+      colMax = std::max(colMin, colMax);
+
+      colMin = std::max<int64_t>(colMin, 0);
+      colMax = std::min<int64_t>(colMax, _width - 1);
+      if (colMin > colMax)
+        continue;
+
+      auto cells = _cells.data() + row * _width;
+      std::fill(cells + colMin, cells + colMax + 1, kOccupied);
+    }
+  }
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_OCCUPANCYRASTERIZER_HH_
+#define SERVICESIM_OCCUPANCYRASTERIZER_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ignition/math/Vector2.hh>
+
+namespace servicesim
+{
+  /// \brief Fills an occupancy grid with convex polygons on the XY plane.
+  ///
+  /// A cell is occupied if any polygon overlaps it, so features thinner than
+  /// a cell are never lost. Rows are split into bands, one per thread, and
+  /// each polygon is filled one row at a time from its extent within the
+  /// row.
+  class OccupancyRasterizer
+  {
+    /// \brief Value of occupied cells, as in nav_msgs/OccupancyGrid
+    public: static const int8_t kOccupied = 100;
+
+    /// \brief Value of free cells
+    public: static const int8_t kFree = 0;
+
+    /// \brief Remove all polygons.
+    public: void Clear();
+
+    /// \brief Add a convex polygon.
+    /// \param[in] _corners Corners in order, either direction. Polygons with
+    /// fewer than 3 corners are ignored.
+    public: void AddPolygon(
+        const std::vector<ignition::math::Vector2d> &_corners);
+
+    /// \brief Number of polygons added.
+    /// \return Polygon count.
+    public: size_t PolygonCount() const;
+
+    /// \brief Get the box holding all polygons.
+    /// \param[out] _min Minimum corner.
+    /// \param[out] _max Maximum corner.
+    /// \return False if there are no polygons.
+    public: bool Bounds(ignition::math::Vector2d &_min,
+        ignition::math::Vector2d &_max) const;
+
+    /// \brief Fill a grid.
+    /// \param[in] _origin Position of the grid's minimum corner.
+    /// \param[in] _resolution Cell side length in meters.
+    /// \param[in] _width Number of columns, along X.
+    /// \param[in] _height Number of rows, along Y.
+    /// \param[in] _threads Number of threads to split rows between.
+    /// \param[out] _cells Cells row by row starting from the origin, resized
+    /// to _width * _height.
+    public: void Rasterize(const ignition::math::Vector2d &_origin,
+        const double _resolution, const unsigned int _width,
+        const unsigned int _height, const unsigned int _threads,
+        std::vector<int8_t> &_cells) const;
+
+    /// \brief Fill a range of rows.
+    /// \param[in] _origin Position of the grid's minimum corner.
+    /// \param[in] _resolution Cell side length.
+    /// \param[in] _width Number of columns.
+    /// \param[in] _rowBegin First row.
+    /// \param[in] _rowEnd One past the last row.
+    /// \param[out] _cells All cells of the grid.
+    private: void RasterizeRows(const ignition::math::Vector2d &_origin,
+        const double _resolution, const unsigned int _width,
+        const int64_t _rowBegin, const int64_t _rowEnd,
+        std::vector<int8_t> &_cells) const;
+
+    /// \brief Corners of all polygons, polygon after polygon
+    private: std::vector<ignition::math::Vector2d> corners;
+
+    /// \brief Index in corners of each polygon's first corner, with one
+    /// extra entry at the end
+    private: std::vector<size_t> polygonStart{0};
+
+    /// \brief Minimum corner of each polygon's bounding box
+    private: std::vector<ignition::math::Vector2d> mins;
+
+    /// \brief Maximum corner of each polygon's bounding box
+    private: std::vector<ignition::math::Vector2d> maxs;
+  };
+}
+#endif
@@ -0,0 +1,559 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/physics.hh>
+
+#include <ros/ros.h>
+#include <servicesim_competition/PersonDetections.h>
+
+#include "LidarRaycaster.hh"
+#include "LoadProfiler.hh"
+#include "ModelTracker.hh"
+#include "PersonDetectionPlugin.hh"
+#include "StaticGeometry.hh"
+
+namespace servicesim
+{
+  /// \brief A camera detections are computed for.
+  struct DetectionCamera
+  {
+    /// \brief Sensor name
+    std::string name;
+
+    /// \brief Link the camera is attached to
+    gazebo::physics::LinkPtr link;
+
+    /// \brief Camera pose relative to the link, looking along +X
+    ignition::math::Pose3d pose;
+
+    /// \brief Image width in pixels
+    int width{0};
+
+    /// \brief Image height in pixels
+    int height{0};
+
+    /// \brief Focal length in pixels
+    double focal{0.0};
+
+    /// \brief Near clip distance
+    double near{0.0};
+
+    /// \brief Far clip distance
+    double far{0.0};
+
+    /// \brief Time between publications
+    double updatePeriod{0.0};
+
+    /// \brief Time of the last publication
+    gazebo::common::Time lastUpdate;
+
+    /// \brief Detections publisher
+    ros::Publisher pub;
+
+    /// \brief Message reused across publications
+    servicesim_competition::PersonDetections msg;
+  };
+
+  /// \brief A person which may be detected.
+  struct DetectionActor
+  {
+    /// \brief The actor
+    gazebo::physics::ModelPtr model;
+
+    /// \brief Box collisions the robot collides with, as set up by the
+    /// actor's CollisionActorPlugin. Empty to use a cylinder instead.
+    std::vector<gazebo::physics::CollisionPtr> boxes;
+  };
+
+  /// \brief Private data class for the PersonDetectionPlugin class
+  class PersonDetectionPluginPrivate
+  {
+    /// \brief Model the cameras are on
+    public: gazebo::physics::ModelPtr model;
+
+    /// \brief Pointer to the world
+    public: gazebo::physics::WorldPtr world;
+
+    /// \brief Connection to world update
+    public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+    /// \brief ROS node handle
+    public: std::unique_ptr<ros::NodeHandle> rosNode{nullptr};
+
+    /// \brief All cameras
+    public: std::vector<DetectionCamera> cameras;
+
+    /// \brief All actors in the world
+    public: std::vector<DetectionActor> actors;
+
+    /// \brief Casts occlusion rays against the flattened static world
+    public: LidarRaycaster raycaster;
+
+    /// \brief Radius of the cylinders of actors without collisions
+    public: double actorRadius{0.25};
+
+    /// \brief Height of actors' cylinders
+    public: double actorHeight{1.8};
+
+    /// \brief Height of an actor's origin above its feet
+    public: double actorBase{1.0};
+
+    /// \brief Rays used to test occlusion of each person
+    public: unsigned int visibilitySamples{5};
+
+    /// \brief Tells when models were inserted or removed
+    public: ModelTracker models;
+  };
+}
+
+using namespace servicesim;
+GZ_REGISTER_MODEL_PLUGIN(servicesim::PersonDetectionPlugin)
+
+/// \brief Find a sensor's SDF within a model's SDF.
+/// \param[in] _modelSDF Model SDF.
+/// \param[in] _name Sensor name.
+/// \param[out] _linkName Name of the link holding the sensor.
+/// \return The sensor's SDF, null if not found.
+static sdf::ElementPtr FindSensor(const sdf::ElementPtr &_modelSDF,
+    const std::string &_name, std::string &_linkName)
+{
+  if (!_modelSDF->HasElement("link"))
+    return nullptr;
+
+  auto linkElem = _modelSDF->GetElement("link");
+  while (linkElem)
+  {
+    if (linkElem->HasElement("sensor"))
+    {
+      auto sensorElem = linkElem->GetElement("sensor");
+      while (sensorElem)
+      {
+        if (sensorElem->Get<std::string>("name") == _name)
+        {
+          _linkName = linkElem->Get<std::string>("name");
+          return sensorElem;
+        }
+        sensorElem = sensorElem->GetNextElement("sensor");
+      }
+    }
+    linkElem = linkElem->GetNextElement("link");
+  }
+  return nullptr;
+}
+
+/// \brief Find the box collisions of an actor which the robot collides
+/// with. These are the proxies listed in the actor's CollisionActorPlugin,
+/// or all its boxes if the plugin scales every bone instead.
+/// \param[in] _actor The actor.
+/// \return The box collisions, empty if the actor doesn't collide.
+static std::vector<gazebo::physics::CollisionPtr> FindCollisionBoxes(
+    const gazebo::physics::ModelPtr &_actor)
+{
+  std::vector<gazebo::physics::CollisionPtr> boxes;
+
+  auto actorSDF = _actor->GetSDF();
+  if (!actorSDF || !actorSDF->HasElement("plugin"))
+    return boxes;
+
+  sdf::ElementPtr pluginElem;
+  auto elem = actorSDF->GetElement("plugin");
+  while (elem)
+  {
+    if (elem->Get<std::string>("filename") == "libCollisionActorPlugin.so")
+    {
+      pluginElem = elem;
+      break;
+    }
+    elem = elem->GetNextElement("plugin");
+  }
+
+  if (!pluginElem)
+    return boxes;
+
+  std::set<std::string> proxies;
+  if (pluginElem->HasElement("proxy"))
+  {
+    auto proxyElem = pluginElem->GetElement("proxy");
+    while (proxyElem)
+    {
+      if (proxyElem->HasAttribute("collision"))
+        proxies.insert(proxyElem->Get<std::string>("collision"));
+      proxyElem = proxyElem->GetNextElement("proxy");
+    }
+  }
+
+  for (const auto &link : _actor->GetLinks())
+  {
+    for (const auto &collision : link->GetCollisions())
+    {
+      if (!proxies.empty() &&
+          proxies.find(collision->GetName()) == proxies.end())
+      {
+        continue;
+      }
+
+      if (boost::dynamic_pointer_cast<gazebo::physics::BoxShape>(
+          collision->GetShape()))
+      {
+        boxes.push_back(collision);
+      }
+    }
+  }
+  return boxes;
+}
+
+/////////////////////////////////////////////////
+PersonDetectionPlugin::PersonDetectionPlugin()
+    : dataPtr(new PersonDetectionPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+void PersonDetectionPlugin::Load(gazebo::physics::ModelPtr _model,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("PersonDetectionPlugin::Load", "plugin",
+      _model->GetName());
+
+  this->dataPtr->model = _model;
+  this->dataPtr->world = _model->GetWorld();
+
+  std::string ns = _model->GetName();
+  if (_sdf->HasElement("robotNamespace"))
+    ns = _sdf->Get<std::string>("robotNamespace");
+
+  if (_sdf->HasElement("actorRadius"))
+    this->dataPtr->actorRadius = _sdf->Get<double>("actorRadius");
+
+  if (_sdf->HasElement("actorHeight"))
+    this->dataPtr->actorHeight = _sdf->Get<double>("actorHeight");
+
+  if (_sdf->HasElement("actorBase"))
+    this->dataPtr->actorBase = _sdf->Get<double>("actorBase");
+
+  if (_sdf->HasElement("visibilitySamples"))
+  {
+    this->dataPtr->visibilitySamples =
+        std::max(1u, _sdf->Get<unsigned int>("visibilitySamples"));
+  }
+
+  if (!_sdf->HasElement("camera"))
+  {
+    gzerr << "No <camera> sdf elements found." << std::endl;
+    return;
+  }
+
+  // ROS transport
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM("A ROS node for Gazebo has not been initialized,"
+        << "unable to load plugin. Load the Gazebo system plugin "
+        << "'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->dataPtr->rosNode.reset(new ros::NodeHandle("/" + ns));
+
+  auto cameraElem = _sdf->GetElement("camera");
+  while (cameraElem)
+  {
+    DetectionCamera camera;
+    camera.name = cameraElem->Get<std::string>("sensor");
+
+    std::string linkName;
+    auto sensorElem = FindSensor(_model->GetSDF(), camera.name, linkName);
+    if (!sensorElem || !sensorElem->HasElement("camera"))
+    {
+      gzerr << "Camera sensor [" << camera.name << "] not found in model ["
+            << _model->GetName() << "], skipping." << std::endl;
+      cameraElem = cameraElem->GetNextElement("camera");
+      continue;
+    }
+
+    camera.link = _model->GetLink(linkName);
+    if (!camera.link)
+    {
+      gzerr << "Link [" << linkName << "] not found, skipping camera ["
+            << camera.name << "]." << std::endl;
+      cameraElem = cameraElem->GetNextElement("camera");
+      continue;
+    }
+
+    camera.pose = sensorElem->Get<ignition::math::Pose3d>("pose");
+
+    auto intrinsicsElem = sensorElem->GetElement("camera");
+    auto imageElem = intrinsicsElem->GetElement("image");
+    auto clipElem = intrinsicsElem->GetElement("clip");
+    camera.width = imageElem->Get<int>("width");
+    camera.height = imageElem->Get<int>("height");
+    camera.near = clipElem->Get<double>("near");
+    camera.far = clipElem->Get<double>("far");
+    camera.focal = camera.width * 0.5 /
+        std::tan(intrinsicsElem->Get<double>("horizontal_fov") * 0.5);
+
+    auto rate = sensorElem->Get<double>("update_rate");
+    if (cameraElem->HasElement("updateRate"))
+      rate = cameraElem->Get<double>("updateRate");
+    if (rate > 0)
+      camera.updatePeriod = 1.0 / rate;
+
+    std::string frame = linkName;
+    if (cameraElem->HasElement("frameName"))
+      frame = cameraElem->Get<std::string>("frameName");
+    camera.msg.header.frame_id = frame;
+
+    std::string topic = camera.name + "/detections";
+    if (cameraElem->HasElement("topicName"))
+      topic = cameraElem->Get<std::string>("topicName");
+
+    camera.pub = this->dataPtr->rosNode->advertise<
+        servicesim_competition::PersonDetections>(topic, 1);
+
+    gzmsg << "[ServiceSim] Publishing person detections for camera ["
+          << camera.name << "] on [/" << ns << "/" << topic << "]"
+          << std::endl;
+
+    this->dataPtr->cameras.push_back(camera);
+    cameraElem = cameraElem->GetNextElement("camera");
+  }
+
+  // Detect after physics has been updated
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateEnd(
+      std::bind(&PersonDetectionPlugin::OnUpdate, this));
+}
+
+/////////////////////////////////////////////////
+void PersonDetectionPlugin::UpdateWorld()
+{
+  auto world = this->dataPtr->world;
+
+  // Only go through models when some have been inserted or removed, such
+  // as streamed furniture
+  if (!this->dataPtr->models.Changed(world))
+    return;
+
+  flattenStaticModels(world, this->dataPtr->model, this->dataPtr->raycaster);
+
+  this->dataPtr->actors.clear();
+  for (const auto &model : world->Models())
+  {
+    if (!boost::dynamic_pointer_cast<gazebo::physics::Actor>(model))
+      continue;
+
+    DetectionActor actor;
+    actor.model = model;
+    actor.boxes = FindCollisionBoxes(model);
+    this->dataPtr->actors.push_back(actor);
+  }
+}
+
+/////////////////////////////////////////////////
+void PersonDetectionPlugin::Detect(const size_t _index)
+{
+  auto &camera = this->dataPtr->cameras[_index];
+  auto &msg = camera.msg;
+  msg.detections.clear();
+
+  auto cameraPose = camera.pose + camera.link->WorldPose();
+  auto origin = cameraPose.Pos();
+
+  const unsigned int sides{16};
+  const auto radius = this->dataPtr->actorRadius;
+
+  std::vector<ignition::math::Vector3d> points;
+  for (const auto &actor : this->dataPtr->actors)
+  {
+    // Outline of the person: the corners of its collision boxes, or a
+    // cylinder for actors which don't collide
+    points.clear();
+    for (const auto &collision : actor.boxes)
+    {
+      auto box = boost::static_pointer_cast<gazebo::physics::BoxShape>(
+          collision->GetShape());
+      auto half = box->Size() * 0.5;
+      auto pose = collision->WorldPose();
+      for (auto x : {-half.X(), half.X()})
+        for (auto y : {-half.Y(), half.Y()})
+          for (auto z : {-half.Z(), half.Z()})
+            points.push_back(pose.CoordPositionAdd({x, y, z}));
+    }
+
+    if (points.empty())
+    {
+      auto base = actor.model->WorldPose().Pos();
+      auto bottom = base.Z() - this->dataPtr->actorBase;
+      auto top = bottom + this->dataPtr->actorHeight;
+      for (unsigned int i = 0; i < sides; ++i)
+      {
+        auto angle = 2 * IGN_PI * i / sides;
+        for (auto z : {bottom, top})
+        {
+          points.push_back({base.X() + radius * std::cos(angle),
+              base.Y() + radius * std::sin(angle), z});
+        }
+      }
+    }
+
+    ignition::math::Vector3d low(ignition::math::MAX_D,
+        ignition::math::MAX_D, ignition::math::MAX_D);
+    ignition::math::Vector3d high(ignition::math::LOW_D,
+        ignition::math::LOW_D, ignition::math::LOW_D);
+    for (const auto &point : points)
+    {
+      low.Min(point);
+      high.Max(point);
+    }
+    auto center = (low + high) * 0.5;
+
+    auto local = cameraPose.Rot().RotateVectorReverse(center - origin);
+    if (local.X() < camera.near || local.X() > camera.far)
+      continue;
+
+    // Project the outline, skipping points behind the near plane
+    double uMin{ignition::math::MAX_D};
+    double uMax{ignition::math::LOW_D};
+    double vMin{ignition::math::MAX_D};
+    double vMax{ignition::math::LOW_D};
+    for (const auto &point : points)
+    {
+      auto p = cameraPose.Rot().RotateVectorReverse(point - origin);
+      if (p.X() < camera.near)
+        continue;
+
+      auto u = camera.width * 0.5 - camera.focal * p.Y() / p.X();
+      auto v = camera.height * 0.5 - camera.focal * p.Z() / p.X();
+      uMin = std::min(uMin, u);
+      uMax = std::max(uMax, u);
+      vMin = std::min(vMin, v);
+      vMax = std::max(vMax, v);
+    }
+
+    if (uMax < 0 || vMax < 0 || uMin >= camera.width ||
+        vMin >= camera.height)
+    {
+      continue;
+    }
+
+    // Sight lines across the person's width, perpendicular to the line of
+    // sight on the plane. They're all at the camera's height, so anything
+    // above or below it can't occlude, see the class documentation.
+    auto dx = center.X() - origin.X();
+    auto dy = center.Y() - origin.Y();
+    auto distance = std::hypot(dx, dy);
+    if (distance < 1e-6)
+      continue;
+
+    // Width of the outline across the line of sight
+    double sideMin{ignition::math::MAX_D};
+    double sideMax{ignition::math::LOW_D};
+    for (const auto &point : points)
+    {
+      auto side = ((point.Y() - center.Y()) * dx -
+          (point.X() - center.X()) * dy) / distance;
+      sideMin = std::min(sideMin, side);
+      sideMax = std::max(sideMax, side);
+    }
+
+    auto samples = this->dataPtr->visibilitySamples;
+    unsigned int visible{0};
+    for (unsigned int i = 0; i < samples; ++i)
+    {
+      auto offset = samples > 1 ?
+          sideMin + (sideMax - sideMin) * i / (samples - 1) :
+          (sideMin + sideMax) * 0.5;
+      auto tx = dx - offset * dy / distance;
+      auto ty = dy + offset * dx / distance;
+      auto range = std::hypot(tx, ty);
+
+      auto hit = this->dataPtr->raycaster.Cast(origin.X(), origin.Y(),
+          origin.Z(), std::atan2(ty, tx), 0.0, range);
+      if (hit >= range - 1e-3)
+        visible++;
+    }
+
+    if (visible == 0)
+      continue;
+
+    servicesim_competition::PersonDetection detection;
+    detection.name = actor.model->GetName();
+    detection.x_min = static_cast<int>(std::max(0.0, std::floor(uMin)));
+    detection.y_min = static_cast<int>(std::max(0.0, std::floor(vMin)));
+    detection.x_max = static_cast<int>(
+        std::min(camera.width - 1.0, std::floor(uMax)));
+    detection.y_max = static_cast<int>(
+        std::min(camera.height - 1.0, std::floor(vMax)));
+    detection.depth = local.X();
+    detection.visibility = static_cast<double>(visible) / samples;
+    msg.detections.push_back(detection);
+  }
+
+  std::sort(msg.detections.begin(), msg.detections.end(),
+      [](const servicesim_competition::PersonDetection &_a,
+         const servicesim_competition::PersonDetection &_b)
+      {
+        return _a.depth < _b.depth;
+      });
+
+  camera.pub.publish(msg);
+}
+
+/////////////////////////////////////////////////
+void PersonDetectionPlugin::OnUpdate()
+{
+  auto simTime = this->dataPtr->world->SimTime();
+
+  bool worldUpdated{false};
+  for (size_t i = 0; i < this->dataPtr->cameras.size(); ++i)
+  {
+    auto &camera = this->dataPtr->cameras[i];
+
+    // Time went backwards, e.g. after a reset
+    if (simTime < camera.lastUpdate)
+      camera.lastUpdate = simTime;
+
+    if ((simTime - camera.lastUpdate).Double() < camera.updatePeriod)
+      continue;
+
+    camera.lastUpdate = simTime;
+
+    if (camera.pub.getNumSubscribers() == 0)
+      continue;
+
+    if (!worldUpdated)
+    {
+      this->UpdateWorld();
+      worldUpdated = true;
+    }
+
+    camera.msg.header.stamp.sec = simTime.sec;
+    camera.msg.header.stamp.nsec = simTime.nsec;
+    this->Detect(i);
+  }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_PERSONDETECTIONPLUGIN_HH_
+#define SERVICESIM_PERSONDETECTIONPLUGIN_HH_
+
+#include <memory>
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class PersonDetectionPluginPrivate;
+
+  /// \brief A model plugin which publishes ground-truth person detections
+  /// for the robot's cameras without rendering, so navigation and following
+  /// can be evaluated with the cameras off.
+  ///
+  /// Each actor is represented by the box collisions its
+  /// CollisionActorPlugin sets up, so detections match what the robot
+  /// collides with: the <proxy> collisions if the plugin has any, otherwise
+  /// all its boxes. Actors without that plugin are represented by an
+  /// upright cylinder. The corners of the boxes, or the cylinder's outline,
+  /// are projected through the camera's intrinsics and extrinsics into a
+  /// bounding box. Occlusion is tested by casting a few rays on the plane at
+  /// the camera's height, from the camera across the person's width, against
+  /// the flattened collisions of static models. People outside the image,
+  /// beyond the far clip plane or fully occluded are not reported.
+  ///
+  /// Occlusion is only tested at that single height, which is a known
+  /// limitation. An obstacle which doesn't reach the camera's height, such
+  /// as a desk or a couch, never hides anyone, even a person sitting or
+  /// crouching behind it. One which is only at the camera's height, such as
+  /// a shelf, hides people whose legs would still be in view. Boxes are
+  /// always the full outline, not cropped to the visible part. Doorways are
+  /// open below their frame, since mesh collisions are flattened per
+  /// triangle.
+  ///
+  /// Intrinsics, pose and rate are read from the camera sensors' SDF in the
+  /// model, so they always match what the real camera would see. Cameras
+  /// are not used otherwise, and may be inactive.
+  ///
+  /// The plugin has the following SDF description:
+  /// <robotNamespace>     ROS namespace, defaults to the model name.
+  /// <actorRadius>        Radius of the cylinder standing for actors
+  ///                      without collisions, defaults to 0.25.
+  /// <actorHeight>        Height of the cylinder, defaults to 1.8.
+  /// <actorBase>          Height of an actor's origin above its feet,
+  ///                      defaults to 1.0.
+  /// <visibilitySamples>  Number of rays used to test occlusion of each
+  ///                      person, defaults to 5.
+  /// <camera>             SDF element with a sensor attribute holding the
+  ///                      name of a camera sensor in the model. More than
+  ///                      one <camera> can be defined.
+  ///   <topicName>        Topic within the namespace for
+  ///                      servicesim_competition/PersonDetections messages.
+  ///   <frameName>        Frame of the messages, defaults to the name of
+  ///                      the sensor's link.
+  ///   <updateRate>       Frequency in Hz, defaults to the sensor's rate.
+  class PersonDetectionPlugin : public gazebo::ModelPlugin
+  {
+    /// \brief Constructor
+    public: PersonDetectionPlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::ModelPtr _model, sdf::ElementPtr _sdf)
+        override;
+
+    /// \brief Refresh static geometry and the list of actors when models
+    /// are inserted or removed.
+    private: void UpdateWorld();
+
+    /// \brief Compute and publish detections for a camera.
+    /// \param[in] _index Index of the camera.
+    private: void Detect(const size_t _index);
+
+    /// \brief Main loop
+    private: void OnUpdate();
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<PersonDetectionPluginPrivate> dataPtr;
+  };
+}
+#endif
@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include <boost/any.hpp>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/physics/physics.hh>
+
+#include "PhysicsController.hh"
+#include "StaticGeometry.hh"
+
+using namespace servicesim;
+
+/// \brief Static collisions lower than this are floors, which the robot
+/// always touches
+static const double kFloorHeight = 0.05;
+
+/// \brief Radius of the circle standing for each actor
+static const double kActorRadius = 0.25;
+
+/// \brief Distance between two boxes on the plane.
+/// \param[in] _minA Minimum corner of the first box.
+/// \param[in] _maxA Maximum corner of the first box.
+/// \param[in] _minB Minimum corner of the second box.
+/// \param[in] _maxB Maximum corner of the second box.
+/// \return Distance, zero if they overlap.
+static double BoxDistance(const ignition::math::Vector2d &_minA,
+    const ignition::math::Vector2d &_maxA,
+    const ignition::math::Vector2d &_minB,
+    const ignition::math::Vector2d &_maxB)
+{
+  auto dx = std::max({0.0, _minB.X() - _maxA.X(), _minA.X() - _maxB.X()});
+  auto dy = std::max({0.0, _minB.Y() - _maxA.Y(), _minA.Y() - _maxB.Y()});
+  return std::hypot(dx, dy);
+}
+
+/////////////////////////////////////////////////
+PhysicsController::PhysicsController(const sdf::ElementPtr &_sdf,
+    const gazebo::physics::WorldPtr &_world)
+    : world(_world)
+{
+  if (!_sdf)
+  {
+    gzerr << "Missing SDF element" << std::endl;
+    return;
+  }
+
+  this->robotName = _sdf->Get<std::string>("robot_name");
+  this->groundName = _sdf->Get<std::string>("ground_name");
+
+  // Defaults come from the world
+  auto physics = _world->Physics();
+  try
+  {
+    this->maxIters = boost::any_cast<int>(physics->GetParam("iters"));
+  }
+  catch (const boost::bad_any_cast &)
+  {
+    this->maxIters = 50;
+  }
+  this->minStep = physics->GetMaxStepSize();
+  this->maxStep = this->minStep;
+  this->targetRtf = physics->GetMaxStepSize() *
+      physics->GetRealTimeUpdateRate();
+
+  if (_sdf->HasElement("adaptive_physics"))
+  {
+    auto elem = _sdf->GetElement("adaptive_physics");
+
+    if (elem->HasElement("update_rate"))
+    {
+      auto rate = elem->Get<double>("update_rate");
+      if (rate > 0)
+        this->checkPeriod = 1.0 / rate;
+    }
+
+    if (elem->HasElement("min_iters"))
+      this->minIters = std::max(1, elem->Get<int>("min_iters"));
+
+    if (elem->HasElement("max_iters"))
+      this->maxIters = std::max(1, elem->Get<int>("max_iters"));
+
+    if (elem->HasElement("min_step"))
+      this->minStep = elem->Get<double>("min_step");
+
+    this->maxStep = this->minStep;
+    if (elem->HasElement("max_step"))
+      this->maxStep = std::max(this->minStep, elem->Get<double>("max_step"));
+
+    if (elem->HasElement("target_rtf"))
+      this->targetRtf = elem->Get<double>("target_rtf");
+
+    if (elem->HasElement("near_distance"))
+      this->nearDistance = elem->Get<double>("near_distance");
+
+    if (elem->HasElement("lookahead"))
+      this->lookahead = elem->Get<double>("lookahead");
+
+    if (elem->HasElement("hold_time"))
+      this->holdTime = elem->Get<double>("hold_time");
+  }
+
+  this->minIters = std::min(this->minIters, this->maxIters);
+
+  // Start precise, until the first check says otherwise
+  this->Apply(this->maxIters, this->minStep, "initial");
+
+  gzmsg << "[ServiceSim] Adaptive physics: " << this->minIters << " to "
+        << this->maxIters << " iterations, " << this->minStep * 1000
+        << " to " << this->maxStep * 1000 << " ms steps" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void PhysicsController::UpdateStatic()
+{
+  // Only go through models when some have been inserted or removed, such
+  // as streamed furniture
+  if (!this->models.Changed(this->world))
+    return;
+
+  this->staticMins.clear();
+  this->staticMaxs.clear();
+  for (const auto &footprint : staticFootprints(this->world, nullptr))
+  {
+    if (footprint.zMax < kFloorHeight)
+      continue;
+
+    ignition::math::Vector2d min(std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::max());
+    ignition::math::Vector2d max(std::numeric_limits<double>::lowest(),
+        std::numeric_limits<double>::lowest());
+    for (const auto &corner : footprint.corners)
+    {
+      min.Set(std::min(min.X(), corner.X()), std::min(min.Y(), corner.Y()));
+      max.Set(std::max(max.X(), corner.X()), std::max(max.Y(), corner.Y()));
+    }
+    this->staticMins.push_back(min);
+    this->staticMaxs.push_back(max);
+  }
+}
+
+/////////////////////////////////////////////////
+unsigned int PhysicsController::RobotContacts() const
+{
+  // Contacts are only recorded while someone subscribes to them, such as
+  // the PenaltyChecker
+  auto manager = this->world->Physics()->GetContactManager();
+  const auto &contacts = manager->GetContacts();
+
+  unsigned int count{0};
+  for (unsigned int i = 0; i < manager->GetContactCount(); ++i)
+  {
+    auto contact = contacts[i];
+    if (!contact->collision1 || !contact->collision2)
+      continue;
+
+    auto name1 = contact->collision1->GetModel()->GetName();
+    auto name2 = contact->collision2->GetModel()->GetName();
+
+    if (name1 != this->robotName && name2 != this->robotName)
+      continue;
+
+    if (name1 == this->groundName || name2 == this->groundName)
+      continue;
+
+    count++;
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////
+double PhysicsController::Nearest(const gazebo::physics::ModelPtr &_robot,
+    const double _limit) const
+{
+  auto box = _robot->BoundingBox();
+  ignition::math::Vector2d robotMin(box.Min().X(), box.Min().Y());
+  ignition::math::Vector2d robotMax(box.Max().X(), box.Max().Y());
+
+  double nearest{_limit};
+  for (size_t i = 0; i < this->staticMins.size(); ++i)
+  {
+    nearest = std::min(nearest, BoxDistance(robotMin, robotMax,
+        this->staticMins[i], this->staticMaxs[i]));
+  }
+
+  for (const auto &model : this->world->Models())
+  {
+    if (model->IsStatic() || model == _robot ||
+        model->GetName() == this->groundName)
+    {
+      continue;
+    }
+
+    // Actors' bounding boxes don't follow their skeleton
+    if (boost::dynamic_pointer_cast<gazebo::physics::Actor>(model))
+    {
+      auto pos = model->WorldPose().Pos();
+      ignition::math::Vector2d point(pos.X(), pos.Y());
+      nearest = std::min(nearest, std::max(0.0,
+          BoxDistance(robotMin, robotMax, point, point) - kActorRadius));
+      continue;
+    }
+
+    auto modelBox = model->BoundingBox();
+    nearest = std::min(nearest, BoxDistance(robotMin, robotMax,
+        ignition::math::Vector2d(modelBox.Min().X(), modelBox.Min().Y()),
+        ignition::math::Vector2d(modelBox.Max().X(), modelBox.Max().Y())));
+  }
+
+  return nearest;
+}
+
+/////////////////////////////////////////////////
+void PhysicsController::Apply(const int _iters, const double _step,
+    const std::string &_reason)
+{
+  auto physics = this->world->Physics();
+
+  if (_iters != this->iters)
+    physics->SetParam("iters", _iters);
+
+  if (std::abs(_step - this->step) > 1e-9)
+  {
+    physics->SetMaxStepSize(_step);
+
+    // Keep the real time factor, unless running as fast as possible
+    if (physics->GetRealTimeUpdateRate() > 0 && this->targetRtf > 0)
+      physics->SetRealTimeUpdateRate(this->targetRtf / _step);
+  }
+
+  gzmsg << "[ServiceSim] Adaptive physics at " << this->world->SimTime()
+        << " s: iterations " << this->iters << " -> " << _iters
+        << ", step " << this->step * 1000 << " -> " << _step * 1000
+        << " ms (" << _reason << ")" << std::endl;
+
+  this->iters = _iters;
+  this->step = _step;
+  this->changes++;
+}
+
+/////////////////////////////////////////////////
+void PhysicsController::Update()
+{
+  auto simTime = this->world->SimTime();
+
+  // Time went backwards, e.g. after a reset
+  if (simTime < this->lastCheck)
+  {
+    this->lastCheck = simTime;
+    this->lastActive = simTime;
+    this->lastWall = gazebo::common::Time::Zero;
+  }
+
+  auto simDelta = (simTime - this->lastCheck).Double();
+  if (simDelta < this->checkPeriod)
+    return;
+
+  this->lastCheck = simTime;
+
+  // Real time factor since the last check
+  auto wall = gazebo::common::Time::GetWallTime();
+  double rtf{-1.0};
+  if (this->lastWall != gazebo::common::Time::Zero)
+  {
+    auto wallDelta = (wall - this->lastWall).Double();
+    if (wallDelta > 0)
+      rtf = simDelta / wallDelta;
+  }
+  this->lastWall = wall;
+
+  // The robot may be inserted after the competition starts
+  auto robot = this->world->ModelByName(this->robotName);
+  if (!robot)
+    return;
+
+  this->UpdateStatic();
+
+  auto speed = robot->WorldLinearVel().Length();
+  auto contacts = this->RobotContacts();
+  auto limit = this->nearDistance + speed * this->lookahead;
+  auto nearest = this->Nearest(robot, limit);
+
+  if (contacts > 0 || nearest < limit)
+    this->lastActive = simTime;
+
+  bool precise = (simTime - this->lastActive).Double() < this->holdTime;
+
+  auto iters = precise ? this->maxIters : this->minIters;
+  auto step = this->step;
+  if (this->maxStep > this->minStep)
+  {
+    if (precise)
+      step = this->minStep;
+    else if (rtf >= 0 && rtf < this->targetRtf * 0.95)
+      step = std::min(this->maxStep, step * 1.25);
+  }
+
+  if (iters == this->iters && std::abs(step - this->step) < 1e-9)
+    return;
+
+  std::ostringstream reason;
+  reason << "contacts " << contacts << ", nearest ";
+  if (nearest < limit)
+    reason << nearest << " m";
+  else
+    reason << "> " << limit << " m";
+  reason << ", speed " << speed << " m/s, rtf ";
+  if (rtf >= 0)
+    reason << rtf;
+  else
+    reason << "unknown";
+
+  this->Apply(iters, step, reason.str());
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_PHYSICSCONTROLLER_HH_
+#define SERVICESIM_PHYSICSCONTROLLER_HH_
+
+#include <string>
+#include <vector>
+
+#include <ignition/math/Vector2.hh>
+#include <sdf/sdf.hh>
+#include <gazebo/common/Time.hh>
+#include <gazebo/physics/PhysicsTypes.hh>
+
+#include "ModelTracker.hh"
+
+namespace servicesim
+{
+  /// \brief Adapts the physics solver to what the robot is doing, so the
+  /// world runs with full precision only while the robot is touching or
+  /// near something.
+  ///
+  /// The robot is active while it has contacts with anything but the
+  /// ground, or while a static collision, actor or other dynamic model is
+  /// within <near_distance> of its bounding box. That distance grows with
+  /// the robot's speed by <lookahead> seconds of travel. Once inactive for
+  /// <hold_time>, the solver drops to <min_iters> iterations. While
+  /// active, it uses <max_iters>.
+  ///
+  /// If <max_step> is larger than <min_step>, the step size also adapts.
+  /// While inactive and running slower than <target_rtf>, the step grows
+  /// towards <max_step>. When active, it goes back to <min_step> at once.
+  /// The real time update rate is scaled with the step, so the target real
+  /// time factor is kept.
+  ///
+  /// Every change is logged with the values which triggered it.
+  ///
+  /// Parameters are read from the <adaptive_physics> element, together
+  /// with the <robot_name> and <ground_name> of the competition:
+  /// <update_rate>     Frequency in Hz of activity checks, defaults to 10.
+  /// <min_iters>       Solver iterations while inactive, defaults to 50.
+  /// <max_iters>       Solver iterations while active, defaults to the
+  ///                   world's.
+  /// <min_step>        Step size while active, defaults to the world's.
+  /// <max_step>        Largest step size while inactive, defaults to
+  ///                   <min_step>, which disables step adaptation.
+  /// <target_rtf>      Real time factor to keep, defaults to the world's.
+  /// <near_distance>   Distance in meters which counts as near, defaults
+  ///                   to 0.5.
+  /// <lookahead>       Seconds of travel added to <near_distance>,
+  ///                   defaults to 1.
+  /// <hold_time>       Seconds to stay active after activity ends,
+  ///                   defaults to 1.
+  class PhysicsController
+  {
+    /// \brief Constructor
+    /// \param[in] _sdf Competition SDF element.
+    /// \param[in] _world Pointer to the world.
+    public: PhysicsController(const sdf::ElementPtr &_sdf,
+        const gazebo::physics::WorldPtr &_world);
+
+    /// \brief Check activity and adapt the solver if needed. Call on every
+    /// world update.
+    public: void Update();
+
+    /// \brief Refresh the boxes of static collisions when models were
+    /// inserted or removed.
+    private: void UpdateStatic();
+
+    /// \brief Count contacts between the robot and anything but the ground.
+    /// \return Contact count.
+    private: unsigned int RobotContacts() const;
+
+    /// \brief Distance from the robot's bounding box to the closest
+    /// obstacle, up to a limit.
+    /// \param[in] _robot Robot model.
+    /// \param[in] _limit Farther obstacles aren't considered.
+    /// \return Distance, or _limit if nothing is closer.
+    private: double Nearest(const gazebo::physics::ModelPtr &_robot,
+        const double _limit) const;
+
+    /// \brief Apply solver settings, logging the change.
+    /// \param[in] _iters Solver iterations.
+    /// \param[in] _step Step size.
+    /// \param[in] _reason Values which triggered the change.
+    private: void Apply(const int _iters, const double _step,
+        const std::string &_reason);
+
+    /// \brief Pointer to the world
+    private: gazebo::physics::WorldPtr world;
+
+    /// \brief Robot name
+    private: std::string robotName;
+
+    /// \brief Ground name
+    private: std::string groundName;
+
+    /// \brief Minimum corner of each static collision's box on the plane
+    private: std::vector<ignition::math::Vector2d> staticMins;
+
+    /// \brief Maximum corner of each static collision's box on the plane
+    private: std::vector<ignition::math::Vector2d> staticMaxs;
+
+    /// \brief Tells when models were inserted or removed
+    private: ModelTracker models;
+
+    /// \brief Time between activity checks
+    private: double checkPeriod{0.1};
+
+    /// \brief Iterations while inactive
+    private: int minIters{50};
+
+    /// \brief Iterations while active
+    private: int maxIters{0};
+
+    /// \brief Step while active
+    private: double minStep{0.0};
+
+    /// \brief Largest step while inactive
+    private: double maxStep{0.0};
+
+    /// \brief Real time factor to keep
+    private: double targetRtf{1.0};
+
+    /// \brief Distance which counts as near
+    private: double nearDistance{0.5};
+
+    /// \brief Seconds of travel added to the near distance
+    private: double lookahead{1.0};
+
+    /// \brief Seconds to stay active after activity ends
+    private: double holdTime{1.0};
+
+    /// \brief Current iterations
+    private: int iters{0};
+
+    /// \brief Current step
+    private: double step{0.0};
+
+    /// \brief Sim time of the last activity
+    private: gazebo::common::Time lastActive;
+
+    /// \brief Sim time of the last check
+    private: gazebo::common::Time lastCheck;
+
+    /// \brief Wall time of the last check
+    private: gazebo::common::Time lastWall;
+
+    /// \brief Number of changes applied
+    private: unsigned int changes{0};
+  };
+}
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <ignition/math/Rand.hh>
+
+#include <gazebo/common/Console.hh>
+
+#include "LoadProfiler.hh"
+#include "RandomSeedPlugin.hh"
+#include "RandomStream.hh"
+
+using namespace servicesim;
+GZ_REGISTER_WORLD_PLUGIN(servicesim::RandomSeedPlugin)
+
+/////////////////////////////////////////////////
+void RandomSeedPlugin::Load(gazebo::physics::WorldPtr /*_world*/,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("RandomSeedPlugin::Load", "plugin");
+
+  if (!_sdf->HasElement("seed"))
+  {
+    gzerr << "Missing <seed>, random streams use seed "
+          << RandomStream::WorldSeed() << std::endl;
+    return;
+  }
+
+  auto seed = _sdf->Get<unsigned int>("seed");
+  RandomStream::SetWorldSeed(seed);
+  ignition::math::Rand::Seed(seed);
+
+  gzmsg << "[ServiceSim] World seed set to " << seed << std::endl;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_RANDOMSEEDPLUGIN_HH_
+#define SERVICESIM_RANDOMSEEDPLUGIN_HH_
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  /// \brief A world plugin which sets the seed all servicesim RandomStreams
+  /// are derived from, so runs of the same world are reproducible.
+  ///
+  /// The global ignition::math::Rand generator, which Gazebo's sensor noise
+  /// draws from, is seeded with the same value.
+  ///
+  /// The plugin has the following SDF description:
+  /// <seed>   World seed, such as the one the world was generated with.
+  class RandomSeedPlugin : public gazebo::WorldPlugin
+  {
+    // Documentation inherited
+    public: void Load(gazebo::physics::WorldPtr _world, sdf::ElementPtr _sdf)
+        override;
+  };
+}
+#endif
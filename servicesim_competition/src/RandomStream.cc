@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <cmath>
+
+#include "RandomStream.hh"
+
+using namespace servicesim;
+
+/// \brief Seed all streams are derived from
+static std::atomic<uint32_t> g_worldSeed{0};
+
+/// \brief FNV-1a hash, which unlike std::hash is the same on all platforms
+/// \param[in] _str String to hash.
+/// \return Hash.
+static uint64_t Hash(const std::string &_str)
+{
+  uint64_t hash{14695981039346656037ull};
+  for (auto c : _str)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/// \brief SplitMix64 finalizer, spreads nearby seeds apart
+/// \param[in] _x Value to mix.
+/// \return Mixed value.
+static uint64_t Mix(uint64_t _x)
+{
+  _x += 0x9e3779b97f4a7c15ull;
+  _x = (_x ^ (_x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  _x = (_x ^ (_x >> 27)) * 0x94d049bb133111ebull;
+  return _x ^ (_x >> 31);
+}
+
+/////////////////////////////////////////////////
+RandomStream::RandomStream(const std::string &_name)
+    : name(_name)
+{
+}
+
+/////////////////////////////////////////////////
+void RandomStream::SetName(const std::string &_name)
+{
+  this->name = _name;
+  this->seeded = false;
+  this->hasSpare = false;
+}
+
+/////////////////////////////////////////////////
+const std::string &RandomStream::Name() const
+{
+  return this->name;
+}
+
+/////////////////////////////////////////////////
+uint64_t RandomStream::Next()
+{
+  if (!this->seeded)
+  {
+    this->engine.seed(Mix(Hash(this->name) ^ Mix(g_worldSeed)));
+    this->seeded = true;
+  }
+  return this->engine();
+}
+
+/////////////////////////////////////////////////
+double RandomStream::DblUniform(const double _min, const double _max)
+{
+  // 53 random bits, the precision of a double, in [0, 1)
+  auto unit = (this->Next() >> 11) * (1.0 / 9007199254740992.0);
+  return _min + unit * (_max - _min);
+}
+
+/////////////////////////////////////////////////
+double RandomStream::DblNormal(const double _mean, const double _sigma)
+{
+  if (this->hasSpare)
+  {
+    this->hasSpare = false;
+    return _mean + _sigma * this->spare;
+  }
+
+  // Box-Muller, which gives two numbers per draw
+  double u1;
+  do
+  {
+    u1 = this->DblUniform();
+  }
+  while (u1 <= 0.0);
+  auto u2 = this->DblUniform();
+
+  auto radius = std::sqrt(-2.0 * std::log(u1));
+  auto angle = 2.0 * M_PI * u2;
+  this->spare = radius * std::sin(angle);
+  this->hasSpare = true;
+
+  return _mean + _sigma * radius * std::cos(angle);
+}
+
+/////////////////////////////////////////////////
+int RandomStream::IntUniform(const int _min, const int _max)
+{
+  if (_max <= _min)
+    return _min;
+
+  auto range = static_cast<uint64_t>(static_cast<int64_t>(_max) - _min) + 1;
+  return static_cast<int>(_min + static_cast<int64_t>(this->Next() % range));
+}
+
+/////////////////////////////////////////////////
+void RandomStream::SetWorldSeed(const uint32_t _seed)
+{
+  g_worldSeed = _seed;
+}
+
+/////////////////////////////////////////////////
+uint32_t RandomStream::WorldSeed()
+{
+  return g_worldSeed;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_RANDOMSTREAM_HH_
+#define SERVICESIM_RANDOMSTREAM_HH_
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace servicesim
+{
+  /// \brief A named stream of random numbers, independent from all other
+  /// streams and from the global ignition::math::Rand generator.
+  ///
+  /// Each stream is seeded from the world seed and its name, so the same
+  /// world always gives each plugin the same sequence, no matter what other
+  /// code draws in between. The world seed is set by the RandomSeedPlugin.
+  ///
+  /// Streams are seeded on their first draw, so they can be named while
+  /// plugins are loading, before the world seed is known. Numbers are
+  /// produced without the standard distributions, whose output differs
+  /// between standard libraries.
+  class RandomStream
+  {
+    /// \brief Constructor
+    /// \param[in] _name Stream name, unique within the world, such as
+    /// "FollowActorPlugin/actor_name".
+    public: explicit RandomStream(const std::string &_name = "");
+
+    /// \brief Set the stream's name, and start it over from its first
+    /// number on the next draw.
+    /// \param[in] _name Stream name.
+    public: void SetName(const std::string &_name);
+
+    /// \brief Get the stream's name.
+    /// \return Stream name.
+    public: const std::string &Name() const;
+
+    /// \brief Draw from a uniform distribution.
+    /// \param[in] _min Minimum value.
+    /// \param[in] _max Maximum value, excluded.
+    /// \return Random number.
+    public: double DblUniform(const double _min = 0.0,
+        const double _max = 1.0);
+
+    /// \brief Draw from a normal distribution.
+    /// \param[in] _mean Mean.
+    /// \param[in] _sigma Standard deviation.
+    /// \return Random number.
+    public: double DblNormal(const double _mean = 0.0,
+        const double _sigma = 1.0);
+
+    /// \brief Draw an integer from a uniform distribution.
+    /// \param[in] _min Minimum value.
+    /// \param[in] _max Maximum value, included.
+    /// \return Random number.
+    public: int IntUniform(const int _min, const int _max);
+
+    /// \brief Set the seed all streams are derived from. Streams which
+    /// already drew keep their sequence until SetName is called.
+    /// \param[in] _seed World seed.
+    public: static void SetWorldSeed(const uint32_t _seed);
+
+    /// \brief Get the seed all streams are derived from.
+    /// \return World seed, 0 unless set.
+    public: static uint32_t WorldSeed();
+
+    /// \brief Next 64 random bits, seeding the stream if needed.
+    /// \return Random bits.
+    private: uint64_t Next();
+
+    /// \brief Stream name
+    private: std::string name;
+
+    /// \brief Generator
+    private: std::mt19937_64 engine;
+
+    /// \brief True once the generator has been seeded
+    private: bool seeded{false};
+
+    /// \brief Second normal number from the last Box-Muller draw
+    private: double spare{0.0};
+
+    /// \brief True if spare hasn't been used yet
+    private: bool hasSpare{false};
+  };
+}
+#endif
@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/Model.hh>
+#include <gazebo/physics/World.hh>
+#include <gazebo/transport/TransportIface.hh>
+#include "LoadProfiler.hh"
+#include "RegionStreamingPlugin.hh"
+
+namespace servicesim
+{
+  /// \brief A static model which is streamed in and out of the world.
+  struct StreamedModel
+  {
+    /// \brief Model name
+    std::string name;
+
+    /// \brief Full SDF string used to insert the model
+    std::string sdf;
+
+    /// \brief True if the model has been inserted and not removed since
+    bool resident{false};
+  };
+
+  /// \brief A region holding streamed models.
+  struct Region
+  {
+    /// \brief Region name
+    std::string name;
+
+    /// \brief Minimum corner of the region's box on the XY plane
+    ignition::math::Vector2d min;
+
+    /// \brief Maximum corner of the region's box on the XY plane
+    ignition::math::Vector2d max;
+
+    /// \brief Models in this region
+    std::vector<StreamedModel> models;
+
+    /// \brief True if the region's models should be in the world
+    bool wanted{false};
+  };
+
+  /// \brief Private data class for the RegionStreamingPlugin class
+  class RegionStreamingPluginPrivate
+  {
+    /// \brief Event connections
+    public: std::vector<gazebo::event::ConnectionPtr> connections;
+
+    /// \brief Pointer to the world
+    public: gazebo::physics::WorldPtr world;
+
+    /// \brief Names of tracked entities
+    public: std::vector<std::string> entities;
+
+    /// \brief All regions
+    public: std::vector<Region> regions;
+
+    /// \brief Queued operations, as region and model indices
+    public: std::deque<std::pair<size_t, size_t>> queue;
+
+    /// \brief Distance within which models are inserted
+    public: double radius{8.0};
+
+    /// \brief Extra distance before models are removed
+    public: double hysteresis{2.0};
+
+    /// \brief Time between distance checks
+    public: double checkPeriod{0.5};
+
+    /// \brief Maximum operations per world update
+    public: unsigned int maxOperations{1};
+
+    /// \brief Time of the last distance check
+    public: gazebo::common::Time lastCheck;
+  };
+}
+
+using namespace servicesim;
+GZ_REGISTER_WORLD_PLUGIN(servicesim::RegionStreamingPlugin)
+
+/////////////////////////////////////////////////
+RegionStreamingPlugin::RegionStreamingPlugin()
+    : dataPtr(new RegionStreamingPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+void RegionStreamingPlugin::Load(gazebo::physics::WorldPtr _world,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("RegionStreamingPlugin::Load", "plugin");
+
+  this->dataPtr->world = _world;
+
+  if (_sdf->HasElement("radius"))
+    this->dataPtr->radius = _sdf->Get<double>("radius");
+
+  if (_sdf->HasElement("hysteresis"))
+    this->dataPtr->hysteresis = _sdf->Get<double>("hysteresis");
+
+  if (_sdf->HasElement("update_rate"))
+  {
+    auto rate = _sdf->Get<double>("update_rate");
+    if (rate > 0)
+      this->dataPtr->checkPeriod = 1.0 / rate;
+  }
+
+  if (_sdf->HasElement("max_operations"))
+  {
+    this->dataPtr->maxOperations =
+        std::max(1u, _sdf->Get<unsigned int>("max_operations"));
+  }
+
+  if (_sdf->HasElement("entity"))
+  {
+    auto entityElem = _sdf->GetElement("entity");
+    while (entityElem)
+    {
+      this->dataPtr->entities.push_back(entityElem->Get<std::string>());
+      entityElem = entityElem->GetNextElement("entity");
+    }
+  }
+
+  if (this->dataPtr->entities.empty())
+  {
+    gzerr << "No <entity> sdf elements found." << std::endl;
+    return;
+  }
+
+  if (!_sdf->HasElement("region"))
+  {
+    gzerr << "No <region> sdf elements found." << std::endl;
+    return;
+  }
+
+  unsigned int modelCount{0};
+  auto regionElem = _sdf->GetElement("region");
+  while (regionElem)
+  {
+    Region region;
+    region.name = regionElem->Get<std::string>("name");
+
+    auto min = regionElem->Get<ignition::math::Vector3d>("min");
+    auto max = regionElem->Get<ignition::math::Vector3d>("max");
+    region.min.Set(std::min(min.X(), max.X()), std::min(min.Y(), max.Y()));
+    region.max.Set(std::max(min.X(), max.X()), std::max(min.Y(), max.Y()));
+
+    if (regionElem->HasElement("model"))
+    {
+      auto modelElem = regionElem->GetElement("model");
+      while (modelElem)
+      {
+        StreamedModel model;
+        model.name = modelElem->Get<std::string>("name");
+        model.sdf = "<sdf version='" + std::string(SDF_VERSION) + "'>" +
+            modelElem->ToString("") + "</sdf>";
+        region.models.push_back(model);
+        modelElem = modelElem->GetNextElement("model");
+      }
+    }
+
+    modelCount += region.models.size();
+    this->dataPtr->regions.push_back(region);
+    regionElem = regionElem->GetNextElement("region");
+  }
+
+  this->dataPtr->connections.push_back(
+      gazebo::event::Events::ConnectWorldUpdateBegin(
+      std::bind(&RegionStreamingPlugin::OnUpdate, this)));
+
+  gzmsg << "[ServiceSim] Streaming " << modelCount << " models in "
+        << this->dataPtr->regions.size() << " regions" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void RegionStreamingPlugin::CheckRegions()
+{
+  // Entities may not have been inserted yet, such as the robot
+  std::vector<ignition::math::Vector2d> positions;
+  for (const auto &name : this->dataPtr->entities)
+  {
+    auto model = this->dataPtr->world->ModelByName(name);
+    if (!model)
+      continue;
+
+    auto pos = model->WorldPose().Pos();
+    positions.push_back(ignition::math::Vector2d(pos.X(), pos.Y()));
+  }
+
+  if (positions.empty())
+    return;
+
+  for (size_t r = 0; r < this->dataPtr->regions.size(); ++r)
+  {
+    auto &region = this->dataPtr->regions[r];
+
+    // Shortest distance from any entity to the region's box
+    double distance = std::numeric_limits<double>::max();
+    for (const auto &pos : positions)
+    {
+      auto dx = std::max({region.min.X() - pos.X(), 0.0,
+          pos.X() - region.max.X()});
+      auto dy = std::max({region.min.Y() - pos.Y(), 0.0,
+          pos.Y() - region.max.Y()});
+      distance = std::min(distance, std::hypot(dx, dy));
+    }
+
+    bool wanted = region.wanted;
+    if (!region.wanted && distance < this->dataPtr->radius)
+      wanted = true;
+    else if (region.wanted &&
+        distance > this->dataPtr->radius + this->dataPtr->hysteresis)
+    {
+      wanted = false;
+    }
+
+    if (wanted == region.wanted)
+      continue;
+
+    region.wanted = wanted;
+    for (size_t m = 0; m < region.models.size(); ++m)
+      this->dataPtr->queue.push_back(std::make_pair(r, m));
+  }
+}
+
+/////////////////////////////////////////////////
+void RegionStreamingPlugin::ProcessQueue()
+{
+  unsigned int operations{0};
+  while (!this->dataPtr->queue.empty() &&
+      operations < this->dataPtr->maxOperations)
+  {
+    auto op = this->dataPtr->queue.front();
+    this->dataPtr->queue.pop_front();
+
+    auto &region = this->dataPtr->regions[op.first];
+    auto &model = region.models[op.second];
+
+    // The region may have changed its mind since this was queued
+    if (model.resident == region.wanted)
+      continue;
+
+    if (region.wanted)
+    {
+      this->dataPtr->world->InsertModelString(model.sdf);
+    }
+    else
+    {
+      gazebo::transport::requestNoReply(this->dataPtr->world->Name(),
+          "entity_delete", model.name);
+    }
+
+    model.resident = region.wanted;
+    operations++;
+  }
+}
+
+/////////////////////////////////////////////////
+void RegionStreamingPlugin::OnUpdate()
+{
+  auto simTime = this->dataPtr->world->SimTime();
+
+  // Time went backwards, e.g. after a reset
+  if (simTime < this->dataPtr->lastCheck)
+    this->dataPtr->lastCheck = simTime;
+
+  if ((simTime - this->dataPtr->lastCheck).Double() >=
+      this->dataPtr->checkPeriod)
+  {
+    this->CheckRegions();
+    this->dataPtr->lastCheck = simTime;
+  }
+
+  this->ProcessQueue();
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_REGIONSTREAMINGPLUGIN_HH_
+#define SERVICESIM_REGIONSTREAMINGPLUGIN_HH_
+
+#include <memory>
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class RegionStreamingPluginPrivate;
+
+  /// \brief A world plugin which streams static models in and out of the
+  /// world according to how close the tracked entities are to the region
+  /// holding them, so large worlds only keep nearby furniture in memory.
+  ///
+  /// Regions are axis-aligned boxes on the XY plane. A region's models are
+  /// inserted when any tracked entity comes within <radius> of its box, and
+  /// removed once all of them are farther than <radius> + <hysteresis>.
+  /// Insertions and removals are queued and at most <max_operations> are
+  /// carried out per world update, so they don't all land on the same step.
+  ///
+  /// The plugin has the following SDF description:
+  /// <entity>           Name of a model to track, such as the robot or the
+  ///                    guest. More than one <entity> can be defined.
+  /// <radius>           Distance in meters from a region's box within which
+  ///                    its models are inserted. Defaults to 8.
+  /// <hysteresis>       Extra distance in meters before models are removed
+  ///                    again. Defaults to 2.
+  /// <update_rate>      Frequency in Hz at which distances are checked.
+  ///                    Defaults to 2.
+  /// <max_operations>   Maximum insertions or removals per world update.
+  ///                    Defaults to 1.
+  /// <region>           SDF element with name, min and max attributes,
+  ///                    the latter being the minimum and maximum corners
+  ///                    of the region's box, such as min="0 0 0". More
+  ///                    than one <region> can be defined.
+  ///   <model>          Full SDF of a static model to stream. More than one
+  ///                    <model> can be defined.
+  class RegionStreamingPlugin : public gazebo::WorldPlugin
+  {
+    /// \brief Constructor
+    public: RegionStreamingPlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::WorldPtr _world, sdf::ElementPtr _sdf)
+        override;
+
+    /// \brief Check distances and queue insertions and removals.
+    private: void CheckRegions();
+
+    /// \brief Carry out queued insertions and removals.
+    private: void ProcessQueue();
+
+    /// \brief Main loop
+    private: void OnUpdate();
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<RegionStreamingPluginPrivate> dataPtr;
+  };
+}
+#endif
@@ -0,0 +1,417 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/sensors/CameraSensor.hh>
+#include <gazebo/sensors/Sensor.hh>
+
+#include "RenderScheduler.hh"
+
+namespace servicesim
+{
+  /// \brief Number of periods a camera may wait for its frame before it
+  /// stops counting against the budget
+  static const double kInFlightTimeout = 2.0;
+
+  /// \brief A camera managed by the scheduler
+  struct ScheduledCamera
+  {
+    /// \brief Camera sensor
+    gazebo::sensors::SensorPtr sensor;
+
+    /// \brief Connection to the sensor's updates
+    gazebo::event::ConnectionPtr updateConnection;
+
+    /// \brief Time between frames
+    double period{0.0};
+
+    /// \brief Offset of the first frame, as a fraction of the period
+    double phase{0.0};
+
+    /// \brief Sim time the next frame is due, negative until scheduled
+    double nextDue{-1.0};
+
+    /// \brief True if the camera should render at all
+    bool wanted{true};
+
+    /// \brief Number of pixels, used to split the cost of a render pass
+    /// between the cameras rendered in it
+    double pixels{1.0};
+
+    /// \brief True while activated and waiting for its frame
+    bool inFlight{false};
+
+    /// \brief Sim time it was last activated
+    double activated{0.0};
+
+    /// \brief True if the current frame has been deferred
+    bool deferred{false};
+
+    /// \brief Estimated render time in milliseconds
+    double estimate{0.0};
+
+    /// \brief Frames since the last report
+    unsigned int frames{0};
+
+    /// \brief Deferred frames since the last report
+    unsigned int deferredFrames{0};
+
+    /// \brief Frames given up on since the last report, because the camera
+    /// was deactivated by someone else while waiting for them
+    unsigned int lostFrames{0};
+
+    /// \brief Render time since the last report, in milliseconds
+    double total{0.0};
+
+    /// \brief Longest render time since the last report, in milliseconds
+    double max{0.0};
+  };
+
+  /// \brief CPU time used by the calling thread.
+  /// \return Time in milliseconds.
+  static double ThreadCpuTime()
+  {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec * 1e3 + time.tv_nsec * 1e-6;
+  }
+
+  /// \brief Private data class for the RenderScheduler class
+  class RenderSchedulerPrivate
+  {
+    /// \brief Called when cameras start rendering
+    public: void OnRender();
+
+    /// \brief Called when cameras are done rendering, before they're
+    /// read back and updated
+    public: void OnPostRender();
+
+    /// \brief Called when a camera has been updated
+    /// \param[in] _index Camera index.
+    public: void OnSensorUpdated(const size_t _index);
+
+    /// \brief Protects all members, cameras are updated on the rendering
+    /// thread and scheduled on the physics thread
+    public: std::mutex mutex;
+
+    /// \brief Managed cameras
+    public: std::vector<ScheduledCamera> cameras;
+
+    /// \brief Connection to the render pass start
+    public: gazebo::event::ConnectionPtr renderConnection;
+
+    /// \brief Connection to the render pass end
+    public: gazebo::event::ConnectionPtr postRenderConnection;
+
+    /// \brief Estimated render time budget per render pass in milliseconds
+    public: double budget{0.0};
+
+    /// \brief Sim time between reports
+    public: double reportPeriod{10.0};
+
+    /// \brief Sim time of the last report
+    public: double lastReport{0.0};
+
+    /// \brief Rendering thread CPU time of the last render pass start, pass
+    /// end or camera update, in milliseconds
+    public: double mark{0.0};
+
+    /// \brief CPU time of the last render pass, in milliseconds
+    public: double passCost{0.0};
+
+    /// \brief Pixels of the cameras in flight during the last render pass
+    public: double passPixels{0.0};
+  };
+}
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+void RenderSchedulerPrivate::OnRender()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->mark = ThreadCpuTime();
+}
+
+/////////////////////////////////////////////////
+void RenderSchedulerPrivate::OnPostRender()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  auto now = ThreadCpuTime();
+  this->passCost = now - this->mark;
+  this->mark = now;
+
+  this->passPixels = 0.0;
+  for (const auto &camera : this->cameras)
+  {
+    if (camera.inFlight)
+      this->passPixels += camera.pixels;
+  }
+}
+
+/////////////////////////////////////////////////
+void RenderSchedulerPrivate::OnSensorUpdated(const size_t _index)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  // The camera's own read back since the pass or the previous camera's
+  // update, plus its share of the pass by pixel count
+  auto now = ThreadCpuTime();
+  auto readBack = now - this->mark;
+  this->mark = now;
+
+  auto &camera = this->cameras[_index];
+
+  // One frame per activation. This also takes back cameras which something
+  // else activated, such as their ROS plugin on load.
+  camera.sensor->SetActive(false);
+
+  if (!camera.inFlight)
+    return;
+  camera.inFlight = false;
+
+  double ms = readBack;
+  if (this->passPixels > 0.0)
+    ms += this->passCost * camera.pixels / this->passPixels;
+
+  camera.frames++;
+  camera.total += ms;
+  camera.max = std::max(camera.max, ms);
+  camera.estimate = camera.estimate > 0.0 ?
+      0.8 * camera.estimate + 0.2 * ms : ms;
+
+  // Keep the phase, but never less than a period after the frame which was
+  // just rendered, so the camera's ROS plugin doesn't throttle the next one
+  auto rendered = camera.sensor->LastMeasurementTime().Double();
+  camera.nextDue = std::max(camera.nextDue, rendered) + camera.period;
+}
+
+/////////////////////////////////////////////////
+RenderScheduler::RenderScheduler()
+    : dataPtr(new RenderSchedulerPrivate)
+{
+  this->dataPtr->renderConnection =
+      gazebo::event::Events::ConnectRender(
+      std::bind(&RenderSchedulerPrivate::OnRender, this->dataPtr.get()));
+  this->dataPtr->postRenderConnection =
+      gazebo::event::Events::ConnectPostRender(
+      std::bind(&RenderSchedulerPrivate::OnPostRender, this->dataPtr.get()));
+}
+
+/////////////////////////////////////////////////
+RenderScheduler::~RenderScheduler()
+{
+  this->dataPtr->renderConnection.reset();
+  this->dataPtr->postRenderConnection.reset();
+  for (auto &camera : this->dataPtr->cameras)
+    camera.updateConnection.reset();
+}
+
+/////////////////////////////////////////////////
+void RenderScheduler::SetBudget(const double _budget)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->budget = std::max(0.0, _budget);
+}
+
+/////////////////////////////////////////////////
+void RenderScheduler::SetReportPeriod(const double _period)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->reportPeriod = std::max(0.0, _period);
+}
+
+/////////////////////////////////////////////////
+void RenderScheduler::Add(const gazebo::sensors::SensorPtr &_sensor,
+    const double _rate)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  auto index = this->dataPtr->cameras.size();
+
+  ScheduledCamera camera;
+  camera.sensor = _sensor;
+
+  auto rate = _rate > 0 ? _rate : _sensor->UpdateRate();
+  camera.period = rate > 0 ? 1.0 / rate : 0.0;
+
+  // Golden ratio offsets spread any number of cameras over the period
+  camera.phase = std::fmod(index * 0.6180339887, 1.0);
+
+  auto cameraSensor =
+      std::dynamic_pointer_cast<gazebo::sensors::CameraSensor>(_sensor);
+  if (cameraSensor)
+  {
+    camera.pixels = std::max(1.0,
+        static_cast<double>(cameraSensor->ImageWidth()) *
+        cameraSensor->ImageHeight());
+  }
+
+  // The scheduler decides when to render, so render as soon as activated
+  _sensor->SetUpdateRate(0);
+  _sensor->SetActive(false);
+
+  camera.updateConnection = _sensor->ConnectUpdated(
+      std::bind(&RenderSchedulerPrivate::OnSensorUpdated,
+      this->dataPtr.get(), index));
+
+  this->dataPtr->cameras.push_back(camera);
+
+  gzmsg << "[ServiceSim] Scheduling renders of camera [" << _sensor->Name()
+        << "] at " << rate << " Hz" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void RenderScheduler::SetWanted(const std::string &_name, const bool _wanted)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  for (auto &camera : this->dataPtr->cameras)
+  {
+    if (camera.sensor->Name() != _name)
+      continue;
+
+    camera.wanted = _wanted;
+
+    // Start again from the current time once wanted again
+    if (!_wanted)
+      camera.nextDue = -1.0;
+  }
+}
+
+/////////////////////////////////////////////////
+void RenderScheduler::Update(const gazebo::common::Time &_simTime)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  auto simTime = _simTime.Double();
+
+  // Time went backwards, e.g. after a reset
+  if (simTime < this->dataPtr->lastReport)
+  {
+    this->dataPtr->lastReport = simTime;
+    for (auto &camera : this->dataPtr->cameras)
+      camera.nextDue = -1.0;
+  }
+
+  // Due cameras, most overdue first
+  std::vector<ScheduledCamera *> due;
+  double inFlightCost{0.0};
+  for (auto &camera : this->dataPtr->cameras)
+  {
+    if (camera.inFlight)
+    {
+      // Deactivated by someone else, such as its ROS plugin once everyone
+      // unsubscribed. Its frame will never come, so schedule it again.
+      if (!camera.sensor->IsActive())
+      {
+        camera.inFlight = false;
+        camera.nextDue = -1.0;
+        camera.lostFrames++;
+      }
+      else
+      {
+        // Waiting for longer than expected, such as when rendering can't
+        // keep up with sim time. Keep waiting, but stop holding back others.
+        if (simTime - camera.activated <= kInFlightTimeout * camera.period)
+          inFlightCost += camera.estimate;
+        continue;
+      }
+    }
+    // Activated by someone else, such as its ROS plugin when someone
+    // subscribes. Only the scheduler activates scheduled cameras.
+    else if (camera.sensor->IsActive())
+    {
+      camera.sensor->SetActive(false);
+    }
+
+    if (!camera.wanted)
+      continue;
+
+    if (camera.nextDue < 0)
+      camera.nextDue = simTime + camera.phase * camera.period;
+
+    if (simTime >= camera.nextDue)
+      due.push_back(&camera);
+  }
+
+  std::sort(due.begin(), due.end(),
+      [](const ScheduledCamera *_a, const ScheduledCamera *_b)
+      {
+        return _a->nextDue < _b->nextDue;
+      });
+
+  for (auto camera : due)
+  {
+    // Something is rendering already and this wouldn't fit
+    if (this->dataPtr->budget > 0 && inFlightCost > 0 &&
+        inFlightCost + camera->estimate > this->dataPtr->budget)
+    {
+      if (!camera->deferred)
+        camera->deferredFrames++;
+      camera->deferred = true;
+      continue;
+    }
+
+    camera->deferred = false;
+    camera->inFlight = true;
+    camera->activated = simTime;
+    camera->sensor->SetActive(true);
+    inFlightCost += camera->estimate;
+  }
+
+  // Report
+  if (this->dataPtr->reportPeriod <= 0 ||
+      simTime - this->dataPtr->lastReport < this->dataPtr->reportPeriod)
+  {
+    return;
+  }
+
+  auto elapsed = simTime - this->dataPtr->lastReport;
+  this->dataPtr->lastReport = simTime;
+
+  std::ostringstream report;
+  report << std::fixed << std::setprecision(2);
+  report << "[ServiceSim] Camera render times over the last " << elapsed
+         << " s of sim time:" << std::endl;
+  for (auto &camera : this->dataPtr->cameras)
+  {
+    report << "  " << camera.sensor->Name() << ": " << camera.frames
+           << " frames (" << camera.frames / elapsed << " Hz), "
+           << (camera.frames > 0 ? camera.total / camera.frames : 0.0)
+           << " ms average, " << camera.max << " ms max, "
+           << camera.total << " ms total, " << camera.deferredFrames
+           << " deferred, " << camera.lostFrames << " lost" << std::endl;
+
+    camera.frames = 0;
+    camera.deferredFrames = 0;
+    camera.lostFrames = 0;
+    camera.total = 0.0;
+    camera.max = 0.0;
+  }
+  gzmsg << report.str();
+}
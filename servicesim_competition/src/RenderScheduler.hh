@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_RENDERSCHEDULER_HH_
+#define SERVICESIM_RENDERSCHEDULER_HH_
+
+#include <memory>
+#include <string>
+
+#include <gazebo/common/Time.hh>
+#include <gazebo/sensors/SensorTypes.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class RenderSchedulerPrivate;
+
+  /// \brief Decides when each camera renders, so frames from different
+  /// cameras are spread over time instead of all landing on the same render
+  /// pass.
+  ///
+  /// Cameras added to the scheduler are kept inactive and activated for a
+  /// single frame when due. Their first frames are offset from each other
+  /// by a fraction of their period, and cameras which are due at the same
+  /// time are activated most overdue first. If a budget is given, cameras
+  /// are only activated together while the sum of their estimated render
+  /// times fits in it, others are deferred to a later pass. Frames are
+  /// stamped by the camera with the sim time they were actually rendered.
+  ///
+  /// The scheduler is the only one activating its cameras. Cameras which
+  /// something else activates, such as their ROS plugin when someone
+  /// subscribes, are deactivated again on the next update. A camera which is
+  /// deactivated by someone else while waiting for its frame is scheduled
+  /// again, and one which waits for more than two periods stops counting
+  /// against the budget, so neither holds back the others. Consecutive
+  /// frames are at least a period apart, so the ROS plugins can keep
+  /// throttling to the same rate.
+  ///
+  /// Render time is the rendering thread's CPU time, so time it spends
+  /// preempted or waiting on other threads isn't counted. Each camera is
+  /// charged its own read back and update, plus a share of the render pass
+  /// it was drawn in, split by pixel count between the scheduled cameras in
+  /// it. Other sensors rendered in the same pass, such as a GPU lidar, are
+  /// included in that share. Totals are reported periodically.
+  class RenderScheduler
+  {
+    /// \brief Constructor
+    public: RenderScheduler();
+
+    /// \brief Destructor
+    public: ~RenderScheduler();
+
+    /// \brief Set the budget.
+    /// \param[in] _budget Milliseconds of estimated render time per render
+    /// pass. Zero for no limit.
+    public: void SetBudget(const double _budget);
+
+    /// \brief Set how often render times are reported.
+    /// \param[in] _period Sim time in seconds between reports, zero to never
+    /// report.
+    public: void SetReportPeriod(const double _period);
+
+    /// \brief Take over a camera's updates.
+    /// \param[in] _sensor Camera sensor.
+    /// \param[in] _rate Target frame rate in Hz. If zero, the sensor's
+    /// update rate is used.
+    public: void Add(const gazebo::sensors::SensorPtr &_sensor,
+        const double _rate = 0.0);
+
+    /// \brief Set whether a camera should render at all, such as whenever
+    /// its topics have subscribers.
+    /// \param[in] _name Sensor name.
+    /// \param[in] _wanted True to render.
+    public: void SetWanted(const std::string &_name, const bool _wanted);
+
+    /// \brief Activate cameras which are due. Call on every world update.
+    /// \param[in] _simTime Current sim time.
+    public: void Update(const gazebo::common::Time &_simTime);
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<RenderSchedulerPrivate> dataPtr;
+  };
+}
+#endif
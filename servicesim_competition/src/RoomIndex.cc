@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "RoomIndex.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+void RoomIndex::Build(const Rooms &_rooms, const double _cellSize)
+{
+  this->names.clear();
+  this->mins.clear();
+  this->maxs.clear();
+  this->cells.clear();
+  this->columns = 0;
+  this->rows = 0;
+  this->cellSize = _cellSize > 0 ? _cellSize : 1.0;
+
+  if (_rooms.empty())
+    return;
+
+  // Normalize boxes and find the grid bounds
+  auto lowest = std::numeric_limits<double>::lowest();
+  auto highest = std::numeric_limits<double>::max();
+  ignition::math::Vector2d gridMin(highest, highest);
+  ignition::math::Vector2d gridMax(lowest, lowest);
+  for (const auto &room : _rooms)
+  {
+    const auto &a = room.second.first;
+    const auto &b = room.second.second;
+
+    ignition::math::Vector2d min(std::min(a.X(), b.X()),
+                                 std::min(a.Y(), b.Y()));
+    ignition::math::Vector2d max(std::max(a.X(), b.X()),
+                                 std::max(a.Y(), b.Y()));
+
+    this->names.push_back(room.first);
+    this->mins.push_back(min);
+    this->maxs.push_back(max);
+
+    gridMin.Set(std::min(gridMin.X(), min.X()), std::min(gridMin.Y(), min.Y()));
+    gridMax.Set(std::max(gridMax.X(), max.X()), std::max(gridMax.Y(), max.Y()));
+  }
+
+  this->origin = gridMin;
+  this->columns = std::max<int64_t>(1,
+      std::ceil((gridMax.X() - gridMin.X()) / this->cellSize));
+  this->rows = std::max<int64_t>(1,
+      std::ceil((gridMax.Y() - gridMin.Y()) / this->cellSize));
+  this->cells.resize(this->columns * this->rows);
+
+  // Smallest boxes first, so the first hit on a query is the most specific
+  std::vector<uint32_t> order(this->names.size());
+  for (uint32_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(),
+      [this](const uint32_t _a, const uint32_t _b)
+      {
+        auto sizeA = this->maxs[_a] - this->mins[_a];
+        auto sizeB = this->maxs[_b] - this->mins[_b];
+        return sizeA.X() * sizeA.Y() < sizeB.X() * sizeB.Y();
+      });
+
+  // Add each room to all cells its box overlaps
+  for (auto r : order)
+  {
+    auto c0 = static_cast<int64_t>(
+        std::floor((this->mins[r].X() - this->origin.X()) / this->cellSize));
+    auto c1 = static_cast<int64_t>(
+        std::floor((this->maxs[r].X() - this->origin.X()) / this->cellSize));
+    auto r0 = static_cast<int64_t>(
+        std::floor((this->mins[r].Y() - this->origin.Y()) / this->cellSize));
+    auto r1 = static_cast<int64_t>(
+        std::floor((this->maxs[r].Y() - this->origin.Y()) / this->cellSize));
+
+    // Boxes on the grid's maximum edge belong to the last cell
+    c1 = std::min(c1, this->columns - 1);
+    r1 = std::min(r1, this->rows - 1);
+
+    for (auto row = r0; row <= r1; ++row)
+    {
+      for (auto col = c0; col <= c1; ++col)
+        this->cells[row * this->columns + col].push_back(r);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+int64_t RoomIndex::Cell(const ignition::math::Vector3d &_point) const
+{
+  if (this->cells.empty())
+    return -1;
+
+  auto col = static_cast<int64_t>(
+      std::floor((_point.X() - this->origin.X()) / this->cellSize));
+  auto row = static_cast<int64_t>(
+      std::floor((_point.Y() - this->origin.Y()) / this->cellSize));
+
+  // Points on the grid's maximum edge belong to the last cell
+  if (col == this->columns)
+    col--;
+  if (row == this->rows)
+    row--;
+
+  if (col < 0 || row < 0 || col >= this->columns || row >= this->rows)
+    return -1;
+
+  return row * this->columns + col;
+}
+
+/////////////////////////////////////////////////
+bool RoomIndex::Contains(const uint32_t _room,
+    const ignition::math::Vector3d &_point) const
+{
+  return _point.X() >= this->mins[_room].X() &&
+         _point.X() <= this->maxs[_room].X() &&
+         _point.Y() >= this->mins[_room].Y() &&
+         _point.Y() <= this->maxs[_room].Y();
+}
+
+/////////////////////////////////////////////////
+std::string RoomIndex::RoomAt(const ignition::math::Vector3d &_point) const
+{
+  auto cell = this->Cell(_point);
+  if (cell < 0)
+    return "";
+
+  for (auto r : this->cells[cell])
+  {
+    if (this->Contains(r, _point))
+      return this->names[r];
+  }
+
+  return "";
+}
+
+/////////////////////////////////////////////////
+std::vector<std::string> RoomIndex::RoomsAt(
+    const ignition::math::Vector3d &_point) const
+{
+  std::vector<std::string> result;
+
+  auto cell = this->Cell(_point);
+  if (cell < 0)
+    return result;
+
+  for (auto r : this->cells[cell])
+  {
+    if (this->Contains(r, _point))
+      result.push_back(this->names[r]);
+  }
+
+  return result;
+}
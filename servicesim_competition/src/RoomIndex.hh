@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_ROOMINDEX_HH_
+#define SERVICESIM_ROOMINDEX_HH_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
+
+namespace servicesim
+{
+  /// \brief Uniform grid over the XY plane used to find which room
+  /// boxes contain a point without testing all of them.
+  ///
+  /// Each cell keeps the rooms whose boxes overlap it, ordered from the
+  /// smallest to the largest box, so the first box containing the point is
+  /// the most specific one.
+  class RoomIndex
+  {
+    /// \brief Rooms keyed by name, as pairs of minimum and maximum corners
+    public: using Rooms = std::map<std::string,
+        std::pair<ignition::math::Vector3d, ignition::math::Vector3d>>;
+
+    /// \brief Build the index, replacing any previous one.
+    /// \param[in] _rooms Room boxes. Only X and Y are used.
+    /// \param[in] _cellSize Length in meters of a grid cell's side.
+    public: void Build(const Rooms &_rooms, const double _cellSize = 1.0);
+
+    /// \brief Get the smallest room containing a point.
+    /// \param[in] _point Point in world coordinates, Z is ignored.
+    /// \return Room name, or empty if the point isn't in any room.
+    public: std::string RoomAt(const ignition::math::Vector3d &_point) const;
+
+    /// \brief Get all rooms containing a point.
+    /// \param[in] _point Point in world coordinates, Z is ignored.
+    /// \return Room names, from the smallest room to the largest.
+    public: std::vector<std::string> RoomsAt(
+        const ignition::math::Vector3d &_point) const;
+
+    /// \brief Get the cell index holding a point.
+    /// \param[in] _point Point in world coordinates.
+    /// \return Index into cells, or -1 if outside the grid.
+    private: int64_t Cell(const ignition::math::Vector3d &_point) const;
+
+    /// \brief Check whether a room's box contains a point.
+    /// \param[in] _room Index into names.
+    /// \param[in] _point Point in world coordinates.
+    /// \return True if contained, boundaries included.
+    private: bool Contains(const uint32_t _room,
+        const ignition::math::Vector3d &_point) const;
+
+    /// \brief Room names
+    private: std::vector<std::string> names;
+
+    /// \brief Minimum corner of each room's box
+    private: std::vector<ignition::math::Vector2d> mins;
+
+    /// \brief Maximum corner of each room's box
+    private: std::vector<ignition::math::Vector2d> maxs;
+
+    /// \brief Rooms overlapping each cell, row by row
+    private: std::vector<std::vector<uint32_t>> cells;
+
+    /// \brief Minimum corner of the grid
+    private: ignition::math::Vector2d origin;
+
+    /// \brief Cell side length
+    private: double cellSize{1.0};
+
+    /// \brief Number of cells along X
+    private: int64_t columns{0};
+
+    /// \brief Number of cells along Y
+    private: int64_t rows{0};
+  };
+}
+#endif
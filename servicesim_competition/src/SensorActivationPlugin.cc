@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/Model.hh>
+#include <gazebo/physics/World.hh>
+#include <gazebo/sensors/Sensor.hh>
+#include <gazebo/sensors/SensorsIface.hh>
+
+#include <ros/callback_queue.h>
+#include <ros/publication.h>
+#include <ros/ros.h>
+#include <ros/topic_manager.h>
+
+#include "LoadProfiler.hh"
+#include "RenderScheduler.hh"
+#include "SensorActivationPlugin.hh"
+
+namespace servicesim
+{
+  /// \brief A sensor managed by the plugin
+  struct ManagedSensor
+  {
+    /// \brief Sensor name
+    std::string name;
+
+    /// \brief Topics published for the sensor
+    std::vector<std::string> topics;
+
+    /// \brief Pointer to the sensor, null until it has been created
+    gazebo::sensors::SensorPtr sensor{nullptr};
+
+    /// \brief True if the render scheduler decides when it renders
+    bool scheduled{false};
+
+    /// \brief Frame rate for the render scheduler, zero to use the sensor's
+    double rate{0.0};
+
+    /// \brief Active state last set by the plugin
+    bool active{true};
+
+    /// \brief True if subscribers to its topics changed since they were
+    /// last counted
+    bool dirty{true};
+  };
+
+  /// \brief An advertised topic of a managed sensor, whose subscribers are
+  /// followed through connect and disconnect callbacks
+  struct WatchedTopic
+  {
+    /// \brief Full topic name
+    std::string name;
+
+    /// \brief Index of the sensor in the managed sensors
+    size_t sensor{0};
+
+    /// \brief Publication the callbacks were added to, which expires if the
+    /// topic is unadvertised
+    ros::PublicationWPtr publication;
+
+    /// \brief Callbacks added to the publication
+    ros::SubscriberCallbacksPtr callbacks;
+  };
+
+  /// \brief Private data class for the SensorActivationPlugin class
+  class SensorActivationPluginPrivate
+  {
+    /// \brief Add callbacks to advertised topics of managed sensors which
+    /// aren't watched yet.
+    public: void Discover();
+
+    /// \brief Pointer to the world
+    public: gazebo::physics::WorldPtr world;
+
+    /// \brief Connection to world update
+    public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+    /// \brief Managed sensors
+    public: std::vector<ManagedSensor> sensors;
+
+    /// \brief Topics being watched
+    public: std::vector<WatchedTopic> watched;
+
+    /// \brief Queue for connect and disconnect callbacks, which are run on
+    /// the world update, so sensors are only touched from there
+    public: ros::CallbackQueue queue;
+
+    /// \brief Staggers renders of scheduled cameras
+    public: RenderScheduler scheduler;
+
+    /// \brief Topics advertised within this process, reused across checks
+    public: std::vector<std::string> advertised;
+
+    /// \brief Time between looking for newly advertised topics
+    public: double updatePeriod{1.0};
+
+    /// \brief Time of the last look for newly advertised topics
+    public: gazebo::common::Time lastUpdate;
+  };
+}
+
+using namespace servicesim;
+GZ_REGISTER_MODEL_PLUGIN(servicesim::SensorActivationPlugin)
+
+/////////////////////////////////////////////////
+void SensorActivationPluginPrivate::Discover()
+{
+  this->advertised.clear();
+  ros::this_node::getAdvertisedTopics(this->advertised);
+
+  auto topicManager = ros::TopicManager::instance();
+
+  for (const auto &topic : this->advertised)
+  {
+    for (size_t s = 0; s < this->sensors.size(); ++s)
+    {
+      // Topics and anything under them, such as image_raw/compressed
+      bool matches{false};
+      for (const auto &prefix : this->sensors[s].topics)
+      {
+        if (topic.compare(0, prefix.size(), prefix) == 0 &&
+            (topic.size() == prefix.size() || topic[prefix.size()] == '/'))
+        {
+          matches = true;
+          break;
+        }
+      }
+      if (!matches)
+        continue;
+
+      auto publication = topicManager->lookupPublication(topic);
+      if (!publication)
+        break;
+
+      auto it = std::find_if(this->watched.begin(), this->watched.end(),
+          [&topic](const WatchedTopic &_watched)
+          {
+            return _watched.name == topic;
+          });
+
+      // Already watching this publication
+      if (it != this->watched.end() && it->publication.lock() == publication)
+        break;
+
+      // Callbacks are also queued for subscribers which are already there
+      auto changed = [this, s](const ros::SingleSubscriberPublisher &)
+      {
+        this->sensors[s].dirty = true;
+      };
+
+      WatchedTopic watched;
+      watched.name = topic;
+      watched.sensor = s;
+      watched.publication = publication;
+      watched.callbacks.reset(new ros::SubscriberCallbacks(changed, changed,
+          ros::VoidConstPtr(), &this->queue));
+      publication->addCallbacks(watched.callbacks);
+
+      if (it != this->watched.end())
+        *it = watched;
+      else
+        this->watched.push_back(watched);
+
+      this->sensors[s].dirty = true;
+      break;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+SensorActivationPlugin::SensorActivationPlugin()
+    : dataPtr(new SensorActivationPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+SensorActivationPlugin::~SensorActivationPlugin()
+{
+  this->dataPtr->updateConnection.reset();
+
+  // Publications keep a pointer to the queue
+  for (auto &watched : this->dataPtr->watched)
+  {
+    auto publication = watched.publication.lock();
+    if (publication)
+      publication->removeCallbacks(watched.callbacks);
+  }
+}
+
+/////////////////////////////////////////////////
+void SensorActivationPlugin::Load(gazebo::physics::ModelPtr _model,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("SensorActivationPlugin::Load", "plugin",
+      _model->GetName());
+
+  this->dataPtr->world = _model->GetWorld();
+
+  // ROS transport
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM("A ROS node for Gazebo has not been initialized,"
+        << "unable to load plugin. Load the Gazebo system plugin "
+        << "'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  if (_sdf->HasElement("updateRate"))
+  {
+    auto rate = _sdf->Get<double>("updateRate");
+    if (rate > 0)
+      this->dataPtr->updatePeriod = 1.0 / rate;
+  }
+
+  if (_sdf->HasElement("renderBudget"))
+    this->dataPtr->scheduler.SetBudget(_sdf->Get<double>("renderBudget"));
+
+  if (_sdf->HasElement("reportPeriod"))
+  {
+    this->dataPtr->scheduler.SetReportPeriod(
+        _sdf->Get<double>("reportPeriod"));
+  }
+
+  if (!_sdf->HasElement("sensor"))
+  {
+    gzerr << "No <sensor> sdf elements found." << std::endl;
+    return;
+  }
+
+  auto sensorElem = _sdf->GetElement("sensor");
+  while (sensorElem)
+  {
+    ManagedSensor sensor;
+    sensor.name = sensorElem->Get<std::string>("name");
+
+    if (sensorElem->HasElement("scheduled"))
+      sensor.scheduled = sensorElem->Get<bool>("scheduled");
+
+    if (sensorElem->HasElement("rate"))
+      sensor.rate = sensorElem->Get<double>("rate");
+
+    bool skip{false};
+    if (sensorElem->HasElement("unlessParam"))
+    {
+      ros::param::param<bool>(sensorElem->Get<std::string>("unlessParam"),
+          skip, false);
+    }
+
+    if (sensorElem->HasElement("topic"))
+    {
+      auto topicElem = sensorElem->GetElement("topic");
+      while (topicElem)
+      {
+        sensor.topics.push_back(topicElem->Get<std::string>());
+        topicElem = topicElem->GetNextElement("topic");
+      }
+    }
+
+    if (skip)
+    {
+      gzmsg << "[ServiceSim] Not managing sensor [" << sensor.name << "]"
+            << std::endl;
+    }
+    else if (sensor.topics.empty())
+    {
+      gzerr << "Sensor [" << sensor.name << "] has no <topic>, skipping."
+            << std::endl;
+    }
+    else
+    {
+      this->dataPtr->sensors.push_back(sensor);
+    }
+
+    sensorElem = sensorElem->GetNextElement("sensor");
+  }
+
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateBegin(
+      std::bind(&SensorActivationPlugin::OnUpdate, this));
+
+  gzmsg << "[ServiceSim] Activating " << this->dataPtr->sensors.size()
+        << " sensors on demand" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void SensorActivationPlugin::OnUpdate()
+{
+  auto simTime = this->dataPtr->world->SimTime();
+
+  // Scheduled cameras are checked on every update
+  this->dataPtr->scheduler.Update(simTime);
+
+  // Time went backwards, e.g. after a reset
+  if (simTime < this->dataPtr->lastUpdate)
+    this->dataPtr->lastUpdate = simTime;
+
+  bool discover = (simTime - this->dataPtr->lastUpdate).Double() >=
+      this->dataPtr->updatePeriod;
+
+  // Sensors are created after model plugins are loaded
+  for (auto &managed : this->dataPtr->sensors)
+  {
+    if (managed.sensor)
+      continue;
+
+    managed.sensor = gazebo::sensors::get_sensor(managed.name);
+    if (!managed.sensor)
+      continue;
+
+    if (managed.scheduled)
+    {
+      this->dataPtr->scheduler.Add(managed.sensor, managed.rate);
+      managed.active = true;
+    }
+    else
+    {
+      managed.active = managed.sensor->IsActive();
+    }
+    managed.dirty = true;
+
+    // Its ROS plugin has just advertised its topics
+    discover = true;
+  }
+
+  if (discover)
+  {
+    this->dataPtr->lastUpdate = simTime;
+    this->dataPtr->Discover();
+  }
+
+  // Run connect and disconnect callbacks, which mark sensors dirty
+  this->dataPtr->queue.callAvailable();
+
+  for (size_t s = 0; s < this->dataPtr->sensors.size(); ++s)
+  {
+    auto &managed = this->dataPtr->sensors[s];
+    if (!managed.sensor || !managed.dirty)
+      continue;
+    managed.dirty = false;
+
+    size_t subscribers{0};
+    for (const auto &watched : this->dataPtr->watched)
+    {
+      if (watched.sensor != s)
+        continue;
+
+      auto publication = watched.publication.lock();
+      if (publication)
+        subscribers += publication->getNumSubscribers();
+    }
+
+    // Only act on changes. Camera ROS plugins also activate their sensor
+    // when someone connects and deactivate it once everyone left, which
+    // agrees with this. Scheduled cameras are left to the scheduler, which
+    // takes back cameras activated by someone else.
+    bool active = subscribers > 0;
+    if (active == managed.active)
+      continue;
+
+    if (managed.scheduled)
+      this->dataPtr->scheduler.SetWanted(managed.name, active);
+    else
+      managed.sensor->SetActive(active);
+    managed.active = active;
+
+    gzmsg << "[ServiceSim] " << (active ? "Activated" : "Deactivated")
+          << " sensor [" << managed.name << "] at "
+          << simTime.FormattedString(gazebo::common::Time::HOURS,
+             gazebo::common::Time::MILLISECONDS) << std::endl;
+  }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_SENSORACTIVATIONPLUGIN_HH_
+#define SERVICESIM_SENSORACTIVATIONPLUGIN_HH_
+
+#include <memory>
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class SensorActivationPluginPrivate;
+
+  /// \brief A model plugin which deactivates sensors while nobody subscribes
+  /// to their ROS topics, so cameras and lidars aren't rendered for nothing.
+  ///
+  /// Subscribers are followed on the publishers advertised within the
+  /// Gazebo process, such as those of gazebo_ros_camera, through their
+  /// connect and disconnect callbacks. A sensor is active while any of its
+  /// topics, or any topic under them such as image transport's compressed
+  /// images, has subscribers. Sensors are only switched when that changes,
+  /// on the world update following the callback. Newly advertised topics are
+  /// looked for at <updateRate>.
+  ///
+  /// Cameras marked as scheduled are handed to a RenderScheduler instead,
+  /// which staggers their frames and keeps render passes within a budget.
+  ///
+  /// The plugin has the following SDF description:
+  /// <updateRate>      Frequency in Hz at which newly advertised topics are
+  ///                   looked for. Defaults to 1.
+  /// <renderBudget>    Estimated render time in milliseconds allowed per
+  ///                   render pass for scheduled cameras. Defaults to 0,
+  ///                   which staggers frames without a limit.
+  /// <reportPeriod>    Sim time in seconds between reports of scheduled
+  ///                   cameras' render times. Defaults to 10, 0 disables.
+  /// <sensor>          SDF element with the sensor's name in a name
+  ///                   attribute. More than one <sensor> can be defined.
+  ///   <topic>         Full name of a topic published for the sensor. More
+  ///                   than one <topic> can be defined.
+  ///   <scheduled>     True to let the render scheduler decide when the
+  ///                   camera renders. Defaults to false.
+  ///   <rate>          Frame rate in Hz for the render scheduler. Defaults
+  ///                   to the sensor's update rate.
+  ///   <unlessParam>   Optional ROS parameter, the sensor is left alone if
+  ///                   it is true. Used for sensors another plugin replaces,
+  ///                   such as the lidar when the CPU lidar is active.
+  class SensorActivationPlugin : public gazebo::ModelPlugin
+  {
+    /// \brief Constructor
+    public: SensorActivationPlugin();
+
+    /// \brief Destructor
+    public: ~SensorActivationPlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::ModelPtr _model, sdf::ElementPtr _sdf)
+        override;
+
+    /// \brief Main loop
+    private: void OnUpdate();
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<SensorActivationPluginPrivate> dataPtr;
+  };
+}
+#endif
@@ -0,0 +1,987 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Rand.hh>
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
+#include <ignition/msgs/uint32.pb.h>
+#include <ignition/transport/Node.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/SystemPaths.hh>
+#include <gazebo/common/Time.hh>
+
+#include <geometry_msgs/TransformStamped.h>
+#include <nav_msgs/Odometry.h>
+#include <rosgraph_msgs/Clock.h>
+#include <servicesim_competition/ActorNames.h>
+#include <tf2_ros/transform_broadcaster.h>
+
+#include "Checkpoint.hh"
+#include "Competition.hh"
+#include "FollowBehavior.hh"
+#include "KinematicBase.hh"
+#include "OccupancyRasterizer.hh"
+#include "RandomStream.hh"
+#include "Simulator2d.hh"
+#include "StaticGeometry.hh"
+#include "TrajectoryLibrary.hh"
+
+namespace servicesim
+{
+  /// \brief An actor walking on the plane.
+  struct Actor2d
+  {
+    /// \brief Actor name
+    std::string name;
+
+    /// \brief Position, keeping the actor's height
+    ignition::math::Vector3d pos;
+
+    /// \brief Walking direction, without the +90 degrees of actor poses
+    double yaw{0.0};
+
+    /// \brief Waypoints, null if the actor stands still
+    std::shared_ptr<const Trajectory> trajectory{nullptr};
+
+    /// \brief Index of the current target waypoint
+    unsigned int currentTarget{0};
+
+    /// \brief Walking velocity in m/s
+    double velocity{0.8};
+
+    /// \brief Distance at which a waypoint is reached
+    double targetRadius{0.5};
+
+    /// \brief Distance within which obstacles in front stop the actor
+    double obstacleMargin{0.5};
+
+    /// \brief Models, besides other actors, which stop the actor
+    std::vector<std::string> obstacles;
+  };
+
+  /// \brief Private data class for the Simulator2d class
+  class Simulator2dPrivate
+  {
+    /// \brief Parsed world, kept alive for elements held by checkpoints
+    public: sdf::SDFPtr sdf;
+
+    /// \brief Checkpoints, scoring and the /servicesim interface
+    public: Competition competition;
+
+    /// \brief Current sim time
+    public: gazebo::common::Time simTime;
+
+    /// \brief Protects simTime, which checkpoints read through their clock
+    public: mutable std::mutex timeMutex;
+
+    /// \brief Largest physics step of the world, contacts are published
+    /// once per physics step in Gazebo
+    public: double maxStepSize{0.001};
+
+    /// \brief Position of the map's minimum corner
+    public: ignition::math::Vector2d mapOrigin;
+
+    /// \brief Map cell side length
+    public: double resolution{0.05};
+
+    /// \brief Number of map columns
+    public: unsigned int mapWidth{0};
+
+    /// \brief Number of map rows
+    public: unsigned int mapHeight{0};
+
+    /// \brief Map cells, row by row
+    public: std::vector<int8_t> cells;
+
+    /// \brief Robot name
+    public: std::string robotName{"servicebot"};
+
+    /// \brief Substring of the names of humans
+    public: std::string humanName{"human"};
+
+    /// \brief Moves the robot
+    public: KinematicBase base;
+
+    /// \brief Radius of the robot's body, as in servicebot.urdf
+    public: double robotRadius{0.25};
+
+    /// \brief Radius of the robot's inflation_people collision
+    public: double peopleInflation{0.75};
+
+    /// \brief Radius of the robot's inflation_obj collision
+    public: double objInflation{0.35};
+
+    /// \brief Radius of an actor's body
+    public: double actorRadius{0.25};
+
+    /// \brief Depth the robot tried to move into an object on this step
+    public: double blockedDepth{0.0};
+
+    /// \brief All actors
+    public: std::vector<Actor2d> actors;
+
+    /// \brief Actor indices by name
+    public: std::map<std::string, size_t> actorIndices;
+
+    /// \brief Index of the guest in actors, actors.size() if there's none
+    public: size_t guest{0};
+
+    /// \brief Guest's follow behavior
+    public: FollowBehavior follow;
+
+    /// \brief True while the guest follows the robot
+    public: bool following{false};
+
+    /// \brief Flag to drift when requested via ROS
+    public: bool driftFlag{false};
+
+    /// \brief Ignition transport node
+    public: ignition::transport::Node ignNode;
+
+    /// \brief Publishes the guest's drift notifications
+    public: ignition::transport::Node::Publisher driftIgnPub;
+
+    /// \brief Publishes the guest's follow target
+    public: ignition::transport::Node::Publisher followingIgnPub;
+
+    /// \brief Penalty weight for human contact, per meter of depth
+    public: double weightHumanContact{0.0};
+
+    /// \brief Penalty weight for object contact, per meter of depth
+    public: double weightObjContact{0.0};
+
+    /// \brief Penalty weight for getting close to humans
+    public: double weightHumanApproximation{0.0};
+
+    /// \brief Penalty weight for getting close to objects
+    public: double weightObjApproximation{0.0};
+
+    /// \brief Total penalty
+    public: double penalty{0.0};
+
+    /// \brief Node for the robot's topics
+    public: std::unique_ptr<ros::NodeHandle> rosNode;
+
+    /// \brief Velocity command subscriber
+    public: ros::Subscriber commandSub;
+
+    /// \brief Odometry publisher
+    public: ros::Publisher odomPub;
+
+    /// \brief RFID publisher
+    public: ros::Publisher rfidPub;
+
+    /// \brief Clock publisher
+    public: ros::Publisher clockPub;
+
+    /// \brief Drift cheat service
+    public: ros::ServiceServer driftService;
+
+    /// \brief Broadcasts the odometry transform
+    public: std::unique_ptr<tf2_ros::TransformBroadcaster> tfBroadcaster;
+
+    /// \brief Odometry message reused across publications
+    public: nav_msgs::Odometry odomMsg;
+
+    /// \brief Time between odometry publications, as in servicebot.urdf
+    public: double odomPeriod{0.02};
+
+    /// \brief Time between RFID readings, as in servicebot.urdf
+    public: double rfidPeriod{0.1};
+
+    /// \brief RFID range, as in servicebot.urdf
+    public: double rfidThreshold{2.0};
+
+    /// \brief Time of the last odometry publication
+    public: gazebo::common::Time lastOdom;
+
+    /// \brief Time of the last RFID reading
+    public: gazebo::common::Time lastRfid;
+  };
+}
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+Simulator2d::Simulator2d()
+    : dataPtr(new Simulator2dPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+Simulator2d::~Simulator2d()
+{
+  Checkpoint::SetClock(nullptr);
+}
+
+/////////////////////////////////////////////////
+bool Simulator2d::Load(const std::string &_path, const uint32_t _seed)
+{
+  // Resolve model:// and file:// URIs the same way gzserver does, from
+  // GAZEBO_MODEL_PATH and GAZEBO_RESOURCE_PATH
+  sdf::setFindCallback([](const std::string &_uri)
+      {
+        return gazebo::common::SystemPaths::Instance()->FindFileURI(_uri);
+      });
+
+  this->dataPtr->sdf.reset(new sdf::SDF());
+  sdf::init(this->dataPtr->sdf);
+  if (!sdf::readFile(_path, this->dataPtr->sdf) ||
+      !this->dataPtr->sdf->Root()->HasElement("world"))
+  {
+    gzerr << "Failed to read world from [" << _path << "]" << std::endl;
+    return false;
+  }
+  auto world = this->dataPtr->sdf->Root()->GetElement("world");
+
+  if (world->HasElement("physics"))
+  {
+    this->dataPtr->maxStepSize =
+        world->GetElement("physics")->Get<double>("max_step_size");
+  }
+
+  // World plugins which matter without Gazebo
+  sdf::ElementPtr competitionElem;
+  auto pluginElem = world->HasElement("plugin") ?
+      world->GetElement("plugin") : nullptr;
+  while (pluginElem)
+  {
+    auto filename = pluginElem->Get<std::string>("filename");
+    if (filename == "libRandomSeedPlugin.so" &&
+        pluginElem->HasElement("seed"))
+    {
+      auto seed = pluginElem->Get<unsigned int>("seed");
+      RandomStream::SetWorldSeed(seed);
+      ignition::math::Rand::Seed(seed);
+    }
+    else if (filename == "libTrajectoryLibraryPlugin.so" &&
+        pluginElem->HasElement("trajectory"))
+    {
+      auto trajectoryElem = pluginElem->GetElement("trajectory");
+      while (trajectoryElem)
+      {
+        std::vector<ignition::math::Pose3d> waypoints;
+        if (trajectoryElem->HasElement("waypoint"))
+        {
+          auto waypointElem = trajectoryElem->GetElement("waypoint");
+          while (waypointElem)
+          {
+            waypoints.push_back(waypointElem->Get<ignition::math::Pose3d>());
+            waypointElem = waypointElem->GetNextElement("waypoint");
+          }
+        }
+        TrajectoryLibrary::Instance().Add(
+            trajectoryElem->Get<std::string>("name"), waypoints);
+        trajectoryElem = trajectoryElem->GetNextElement("trajectory");
+      }
+    }
+    else if (filename == "libCompetitionPlugin.so")
+    {
+      competitionElem = pluginElem;
+    }
+    pluginElem = pluginElem->GetNextElement("plugin");
+  }
+
+  if (_seed != 0)
+  {
+    RandomStream::SetWorldSeed(_seed);
+    ignition::math::Rand::Seed(_seed);
+  }
+
+  if (!competitionElem)
+  {
+    gzerr << "World [" << _path << "] has no CompetitionPlugin" << std::endl;
+    return false;
+  }
+
+  // Names and penalty weights, as read by the PenaltyChecker
+  if (competitionElem->HasElement("robot_name"))
+  {
+    this->dataPtr->robotName =
+        competitionElem->Get<std::string>("robot_name");
+  }
+
+  if (competitionElem->HasElement("human_name"))
+  {
+    this->dataPtr->humanName =
+        competitionElem->Get<std::string>("human_name");
+  }
+
+  std::string groundName{"floor"};
+  if (competitionElem->HasElement("ground_name"))
+    groundName = competitionElem->Get<std::string>("ground_name");
+
+  if (competitionElem->HasElement("weight"))
+  {
+    auto weightElem = competitionElem->GetElement("weight");
+    this->dataPtr->weightHumanContact =
+        weightElem->Get<double>("human_contact");
+    this->dataPtr->weightObjContact = weightElem->Get<double>("obj_contact");
+    this->dataPtr->weightHumanApproximation =
+        weightElem->Get<double>("human_approximation");
+    this->dataPtr->weightObjApproximation =
+        weightElem->Get<double>("obj_approximation");
+  }
+  else
+  {
+    gzerr << "Missing top-level <weight> element, no penalties will be "
+          << "counted" << std::endl;
+  }
+
+  this->BuildMap(world, groundName);
+  this->LoadActors(world);
+
+  // Competition, with checkpoints reading the simulator's time
+  Checkpoint::SetClock([this]()
+      {
+        std::lock_guard<std::mutex> lock(this->dataPtr->timeMutex);
+        return this->dataPtr->simTime;
+      });
+
+  auto locator = [this](const std::string &_name,
+      ignition::math::Vector3d &_pos)
+      {
+        if (_name == this->dataPtr->robotName)
+        {
+          _pos = this->dataPtr->base.Pose().Pos();
+          return true;
+        }
+
+        auto it = this->dataPtr->actorIndices.find(_name);
+        if (it == this->dataPtr->actorIndices.end())
+          return false;
+
+        _pos = this->dataPtr->actors[it->second].pos;
+        return true;
+      };
+
+  auto placer = [this](const std::string &_name,
+      const ignition::math::Pose3d &_pose)
+      {
+        if (_name == this->dataPtr->robotName)
+        {
+          this->dataPtr->base.Teleport(_pose);
+          return true;
+        }
+
+        auto it = this->dataPtr->actorIndices.find(_name);
+        if (it == this->dataPtr->actorIndices.end())
+          return false;
+
+        auto &actor = this->dataPtr->actors[it->second];
+        actor.pos = _pose.Pos();
+        actor.yaw = _pose.Rot().Yaw() - IGN_PI_2;
+        return true;
+      };
+
+  if (!this->dataPtr->competition.Load(competitionElem, locator, placer))
+    return false;
+
+  // The robot rests on the floor
+  auto startPose = this->dataPtr->competition.RobotStartPose();
+  startPose.Pos().Z(0);
+  sdf::ElementPtr baseElem(new sdf::Element());
+  this->dataPtr->base.Load(baseElem);
+  this->dataPtr->base.Reset(startPose);
+
+  // ROS interface, the same as in Gazebo
+  if (!this->dataPtr->competition.Advertise())
+    return false;
+
+  this->dataPtr->rosNode.reset(new ros::NodeHandle(this->dataPtr->robotName));
+
+  this->dataPtr->commandSub = this->dataPtr->rosNode->subscribe("cmd_vel",
+      1, &Simulator2d::OnCommand, this);
+  this->dataPtr->odomPub =
+      this->dataPtr->rosNode->advertise<nav_msgs::Odometry>("odom", 1);
+  this->dataPtr->rfidPub = this->dataPtr->rosNode->advertise<
+      servicesim_competition::ActorNames>("rfid", 1);
+  this->dataPtr->clockPub =
+      this->dataPtr->rosNode->advertise<rosgraph_msgs::Clock>("/clock", 1);
+  this->dataPtr->driftService = this->dataPtr->rosNode->advertiseService(
+      "/servicesim/drift", &Simulator2d::OnDriftRosService, this);
+  this->dataPtr->tfBroadcaster.reset(new tf2_ros::TransformBroadcaster());
+
+  this->dataPtr->odomMsg.header.frame_id = "odom";
+  this->dataPtr->odomMsg.child_frame_id = "base_footprint";
+
+  gzmsg << "[ServiceSim] 2D world loaded from [" << _path << "] with "
+        << this->dataPtr->actors.size() << " actors, seed "
+        << RandomStream::WorldSeed() << std::endl;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::BuildMap(const sdf::ElementPtr &_world,
+    const std::string &_ground)
+{
+  // The same height band as the OccupancyMapPlugin's defaults
+  const double minHeight{0.1};
+  const double maxHeight{1.5};
+
+  OccupancyRasterizer rasterizer;
+  for (const auto &footprint : staticFootprints(_world, _ground))
+  {
+    if (footprint.zMax < minHeight || footprint.zMin > maxHeight)
+      continue;
+
+    rasterizer.AddPolygon(footprint.corners);
+  }
+
+  ignition::math::Vector2d min;
+  ignition::math::Vector2d max;
+  if (!rasterizer.Bounds(min, max))
+  {
+    gzwarn << "No static collisions within the height band, the map is "
+           << "empty" << std::endl;
+    return;
+  }
+
+  // Leave a free border around the world
+  min -= ignition::math::Vector2d(1, 1);
+  max += ignition::math::Vector2d(1, 1);
+
+  auto res = this->dataPtr->resolution;
+  this->dataPtr->mapOrigin = min;
+  this->dataPtr->mapWidth =
+      static_cast<unsigned int>(std::ceil((max.X() - min.X()) / res));
+  this->dataPtr->mapHeight =
+      static_cast<unsigned int>(std::ceil((max.Y() - min.Y()) / res));
+
+  rasterizer.Rasterize(min, res, this->dataPtr->mapWidth,
+      this->dataPtr->mapHeight,
+      std::max(1u, std::thread::hardware_concurrency()),
+      this->dataPtr->cells);
+
+  gzmsg << "[ServiceSim] Rasterized " << rasterizer.PolygonCount()
+        << " static collisions into a " << this->dataPtr->mapWidth << " x "
+        << this->dataPtr->mapHeight << " map" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::LoadActors(const sdf::ElementPtr &_world)
+{
+  auto guestName = this->dataPtr->competition.GuestName();
+
+  auto actorElem = _world->HasElement("actor") ?
+      _world->GetElement("actor") : nullptr;
+  while (actorElem)
+  {
+    Actor2d actor;
+    actor.name = actorElem->Get<std::string>("name");
+
+    // Actors are oriented Y-up and Z-front
+    auto pose = actorElem->Get<ignition::math::Pose3d>("pose");
+    actor.pos = pose.Pos();
+    actor.yaw = pose.Rot().Yaw() - IGN_PI_2;
+
+    auto pluginElem = actorElem->HasElement("plugin") ?
+        actorElem->GetElement("plugin") : nullptr;
+    while (pluginElem)
+    {
+      auto filename = pluginElem->Get<std::string>("filename");
+      if (filename == "libTrajectoryActorPlugin.so")
+      {
+        if (pluginElem->HasElement("velocity"))
+          actor.velocity = pluginElem->Get<double>("velocity");
+
+        if (pluginElem->HasElement("wander") &&
+            pluginElem->Get<bool>("wander"))
+        {
+          gzwarn << "Actor [" << actor.name << "] wanders around the "
+                 << "navigation graph, which the 2D simulator doesn't build, "
+                 << "it will stand still" << std::endl;
+        }
+        else if (pluginElem->HasElement("trajectory"))
+        {
+          actor.trajectory = TrajectoryLibrary::Instance().Get(
+              pluginElem->Get<std::string>("trajectory"));
+        }
+        else if (pluginElem->HasElement("target"))
+        {
+          std::vector<ignition::math::Pose3d> targets;
+          auto targetElem = pluginElem->GetElement("target");
+          while (targetElem)
+          {
+            targets.push_back(targetElem->Get<ignition::math::Pose3d>());
+            targetElem = targetElem->GetNextElement("target");
+          }
+          actor.trajectory = std::make_shared<const Trajectory>(targets);
+        }
+
+        if (actor.trajectory)
+        {
+          unsigned int offset{0};
+          if (pluginElem->HasElement("offset"))
+            offset = pluginElem->Get<unsigned int>("offset");
+          actor.currentTarget = offset % actor.trajectory->Size();
+        }
+
+        if (pluginElem->HasElement("target_radius"))
+          actor.targetRadius = pluginElem->Get<double>("target_radius");
+
+        if (pluginElem->HasElement("obstacle_margin"))
+          actor.obstacleMargin = pluginElem->Get<double>("obstacle_margin");
+
+        if (pluginElem->HasElement("obstacle"))
+        {
+          auto obstacleElem = pluginElem->GetElement("obstacle");
+          while (obstacleElem)
+          {
+            actor.obstacles.push_back(obstacleElem->Get<std::string>());
+            obstacleElem = obstacleElem->GetNextElement("obstacle");
+          }
+        }
+      }
+      else if (filename == "libFollowActorPlugin.so" &&
+          actor.name == guestName)
+      {
+        this->dataPtr->follow.Load(pluginElem, actor.name);
+
+        std::string ns;
+        if (pluginElem->HasElement("namespace"))
+          ns = "/" + pluginElem->Get<std::string>("namespace");
+        ns += "/" + actor.name;
+
+        this->dataPtr->ignNode.Advertise(ns + "/follow",
+            &Simulator2d::OnFollow, this);
+        this->dataPtr->ignNode.Advertise(ns + "/unfollow",
+            &Simulator2d::OnUnfollow, this);
+        this->dataPtr->driftIgnPub =
+            this->dataPtr->ignNode.Advertise<ignition::msgs::UInt32>(
+            ns + "/drift");
+        this->dataPtr->followingIgnPub =
+            this->dataPtr->ignNode.Advertise<ignition::msgs::StringMsg>(
+            ns + "/following");
+      }
+      pluginElem = pluginElem->GetNextElement("plugin");
+    }
+
+    this->dataPtr->actorIndices[actor.name] = this->dataPtr->actors.size();
+    this->dataPtr->actors.push_back(actor);
+    actorElem = actorElem->GetNextElement("actor");
+  }
+
+  auto it = this->dataPtr->actorIndices.find(guestName);
+  if (it == this->dataPtr->actorIndices.end())
+  {
+    gzerr << "Guest [" << guestName << "] not found among the actors"
+          << std::endl;
+    this->dataPtr->guest = this->dataPtr->actors.size();
+  }
+  else
+  {
+    this->dataPtr->guest = it->second;
+  }
+}
+
+/////////////////////////////////////////////////
+double Simulator2d::Clearance(const double _x, const double _y,
+    const double _radius) const
+{
+  if (this->dataPtr->cells.empty())
+    return _radius;
+
+  auto res = this->dataPtr->resolution;
+  auto col = static_cast<int64_t>(
+      std::floor((_x - this->dataPtr->mapOrigin.X()) / res));
+  auto row = static_cast<int64_t>(
+      std::floor((_y - this->dataPtr->mapOrigin.Y()) / res));
+  auto reach = static_cast<int64_t>(std::ceil(_radius / res));
+
+  double clearance{_radius};
+  for (auto r = std::max<int64_t>(row - reach, 0);
+      r <= std::min<int64_t>(row + reach, this->dataPtr->mapHeight - 1); ++r)
+  {
+    for (auto c = std::max<int64_t>(col - reach, 0);
+        c <= std::min<int64_t>(col + reach, this->dataPtr->mapWidth - 1); ++c)
+    {
+      if (this->dataPtr->cells[r * this->dataPtr->mapWidth + c] !=
+          OccupancyRasterizer::kOccupied)
+      {
+        continue;
+      }
+
+      // Distance to the cell's square
+      auto cx = this->dataPtr->mapOrigin.X() + (c + 0.5) * res;
+      auto cy = this->dataPtr->mapOrigin.Y() + (r + 0.5) * res;
+      auto dx = std::max(std::abs(_x - cx) - res * 0.5, 0.0);
+      auto dy = std::max(std::abs(_y - cy) - res * 0.5, 0.0);
+      clearance = std::min(clearance, std::hypot(dx, dy));
+    }
+  }
+  return clearance;
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::Step(const double _dt)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->timeMutex);
+    this->dataPtr->simTime += gazebo::common::Time(_dt);
+  }
+
+  this->UpdateRobot(_dt);
+  this->UpdateActors(_dt);
+  this->UpdatePenalties(_dt);
+
+  this->dataPtr->competition.Update(this->dataPtr->simTime,
+      this->dataPtr->penalty);
+
+  this->Publish();
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::UpdateRobot(const double _dt)
+{
+  auto &base = this->dataPtr->base;
+  auto radius = this->dataPtr->robotRadius;
+
+  auto before = base.Pose().Pos();
+  auto clearanceBefore = this->Clearance(before.X(), before.Y(), radius);
+
+  base.Update(this->dataPtr->simTime.Double(), _dt);
+
+  // Objects are static, so the robot can't move into them. It may still
+  // move out of them if it starts inside one.
+  this->dataPtr->blockedDepth = 0.0;
+  auto after = base.Pose().Pos();
+  auto clearanceAfter = this->Clearance(after.X(), after.Y(), radius);
+  if (clearanceAfter < radius && clearanceAfter < clearanceBefore)
+  {
+    this->dataPtr->blockedDepth = radius - clearanceAfter;
+    base.Stop(before.X(), before.Y());
+  }
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::UpdateActors(const double _dt)
+{
+  auto &actors = this->dataPtr->actors;
+  auto robotPos = this->dataPtr->base.Pose().Pos();
+
+  for (size_t i = 0; i < actors.size(); ++i)
+  {
+    auto &actor = actors[i];
+    if (!actor.trajectory)
+      continue;
+
+    // Don't move if there's an obstacle in front, same as the
+    // TrajectoryActorPlugin, which treats all actors as obstacles
+    ignition::math::Vector3d heading(std::cos(actor.yaw),
+        std::sin(actor.yaw), 0);
+    auto blocked = [&](const ignition::math::Vector3d &_pos)
+        {
+          auto diff = _pos - actor.pos;
+          auto front = diff.Dot(heading);
+          auto side = heading.X() * diff.Y() - heading.Y() * diff.X();
+          return diff.Length() < actor.obstacleMargin &&
+              std::abs(side) < actor.obstacleMargin * 0.4 && front > 0;
+        };
+
+    bool obstacle = std::find(actor.obstacles.begin(), actor.obstacles.end(),
+        this->dataPtr->robotName) != actor.obstacles.end() &&
+        blocked(robotPos);
+    for (size_t j = 0; j < actors.size() && !obstacle; ++j)
+      obstacle = j != i && blocked(actors[j].pos);
+
+    if (obstacle)
+      continue;
+
+    // Move on to the next waypoint once close to the current one
+    auto target = actor.trajectory->Waypoint(actor.currentTarget).Pos();
+    auto posDiff = target - actor.pos;
+    posDiff.Z(0);
+    if (posDiff.Length() <= actor.targetRadius)
+    {
+      actor.currentTarget = (actor.currentTarget + 1) %
+          actor.trajectory->Size();
+      target = actor.trajectory->Waypoint(actor.currentTarget).Pos();
+    }
+
+    // Corners are turned instantly instead of following a spline
+    auto dir = (target - actor.pos).Normalize();
+    actor.pos += dir * actor.velocity * _dt;
+    actor.yaw = std::atan2(dir.Y(), dir.X());
+  }
+
+  // Guest
+  if (!this->dataPtr->following)
+    return;
+
+  auto &guest = actors[this->dataPtr->guest];
+
+  double yaw;
+  FollowBehavior::Drift drift;
+  bool moved = this->dataPtr->follow.Update(this->dataPtr->simTime.Double(),
+      _dt, robotPos, this->dataPtr->driftFlag, guest.pos, yaw, drift);
+
+  if (drift != FollowBehavior::NONE)
+  {
+    if (drift == FollowBehavior::TOO_FAR)
+    {
+      gzwarn << "Target [" << this->dataPtr->robotName
+             << "] too far, actor [" << guest.name << "] stopped following"
+             << std::endl;
+    }
+    else if (!this->dataPtr->driftFlag)
+    {
+      gzwarn << "Actor [" << guest.name
+             << "] drifting due to scheduled time: "
+             << this->dataPtr->follow.DriftTime() << std::endl;
+    }
+    else
+    {
+      gzwarn << "Actor [" << guest.name << "] drifted as requested! (cheat)"
+             << std::endl;
+      this->dataPtr->driftFlag = false;
+    }
+
+    this->dataPtr->following = false;
+
+    ignition::msgs::StringMsg followingMsg;
+    this->dataPtr->followingIgnPub.Publish(followingMsg);
+
+    ignition::msgs::UInt32 msg;
+    msg.set_data(drift);
+    this->dataPtr->driftIgnPub.Publish(msg);
+  }
+
+  if (moved)
+    guest.yaw = yaw;
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::UpdatePenalties(const double _dt)
+{
+  auto pos = this->dataPtr->base.Pose().Pos();
+
+  // Gazebo counts contacts once per physics step
+  auto steps = _dt / this->dataPtr->maxStepSize;
+
+  // Humans, as circles against the body and the people inflation
+  for (const auto &actor : this->dataPtr->actors)
+  {
+    if (actor.name.find(this->dataPtr->humanName) == std::string::npos)
+      continue;
+
+    auto distance = std::hypot(actor.pos.X() - pos.X(),
+        actor.pos.Y() - pos.Y());
+
+    auto contact = this->dataPtr->robotRadius + this->dataPtr->actorRadius -
+        distance;
+    if (contact > 0)
+    {
+      this->dataPtr->penalty += this->dataPtr->weightHumanContact * contact *
+          steps;
+    }
+
+    auto approximation = this->dataPtr->peopleInflation +
+        this->dataPtr->actorRadius - distance;
+    if (approximation > 0)
+    {
+      this->dataPtr->penalty += this->dataPtr->weightHumanApproximation *
+          approximation * steps;
+    }
+  }
+
+  // Objects, against the map
+  auto clearance = this->Clearance(pos.X(), pos.Y(),
+      this->dataPtr->objInflation);
+
+  auto contact = std::max(this->dataPtr->robotRadius - clearance,
+      this->dataPtr->blockedDepth);
+  if (contact > 0)
+  {
+    this->dataPtr->penalty += this->dataPtr->weightObjContact * contact *
+        steps;
+  }
+
+  auto approximation = this->dataPtr->objInflation - clearance;
+  if (approximation > 0)
+  {
+    this->dataPtr->penalty += this->dataPtr->weightObjApproximation *
+        approximation * steps;
+  }
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::Publish()
+{
+  auto simTime = this->dataPtr->simTime;
+  ros::Time stamp(simTime.sec, simTime.nsec);
+
+  rosgraph_msgs::Clock clock;
+  clock.clock = stamp;
+  this->dataPtr->clockPub.publish(clock);
+
+  // Odometry and its transform
+  if ((simTime - this->dataPtr->lastOdom).Double() >=
+      this->dataPtr->odomPeriod)
+  {
+    this->dataPtr->lastOdom = simTime;
+
+    auto &msg = this->dataPtr->odomMsg;
+    msg.header.stamp = stamp;
+    this->dataPtr->base.Odometry(msg);
+    this->dataPtr->odomPub.publish(msg);
+
+    geometry_msgs::TransformStamped transform;
+    transform.header = msg.header;
+    transform.child_frame_id = msg.child_frame_id;
+    transform.transform.translation.x = msg.pose.pose.position.x;
+    transform.transform.translation.y = msg.pose.pose.position.y;
+    transform.transform.rotation = msg.pose.pose.orientation;
+    this->dataPtr->tfBroadcaster->sendTransform(transform);
+  }
+
+  // Actors within RFID range, as the VicinityPlugin
+  if ((simTime - this->dataPtr->lastRfid).Double() >=
+      this->dataPtr->rfidPeriod)
+  {
+    this->dataPtr->lastRfid = simTime;
+
+    auto pos = this->dataPtr->base.Pose().Pos();
+    servicesim_competition::ActorNames msg;
+    for (const auto &actor : this->dataPtr->actors)
+    {
+      if (std::hypot(actor.pos.X() - pos.X(), actor.pos.Y() - pos.Y()) <=
+          this->dataPtr->rfidThreshold)
+      {
+        msg.actor_names.push_back(actor.name);
+      }
+    }
+    if (!msg.actor_names.empty())
+      this->dataPtr->rfidPub.publish(msg);
+  }
+}
+
+/////////////////////////////////////////////////
+double Simulator2d::SimTime() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->timeMutex);
+  return this->dataPtr->simTime.Double();
+}
+
+/////////////////////////////////////////////////
+double Simulator2d::Score() const
+{
+  return this->dataPtr->competition.Score(this->dataPtr->penalty);
+}
+
+/////////////////////////////////////////////////
+bool Simulator2d::Complete() const
+{
+  return this->dataPtr->competition.Complete();
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::OnCommand(const geometry_msgs::Twist::ConstPtr &_msg)
+{
+  this->dataPtr->base.SetCommand(_msg->linear.x, _msg->angular.z,
+      this->SimTime());
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::OnFollow(const ignition::msgs::StringMsg &_req,
+    ignition::msgs::Boolean &_res, bool &_result)
+{
+  _res.set_data(false);
+  _result = false;
+
+  if (this->dataPtr->guest >= this->dataPtr->actors.size())
+    return;
+
+  // The robot is the only model in the 2D world
+  if (_req.data() != this->dataPtr->robotName)
+  {
+    gzwarn << "Failed to find model: [" << _req.data() << "]" << std::endl;
+    return;
+  }
+
+  const auto &guest = this->dataPtr->actors[this->dataPtr->guest];
+  if (!this->dataPtr->follow.InPickUpRadius(guest.pos,
+      this->dataPtr->base.Pose().Pos()))
+  {
+    gzwarn << "Target [" << _req.data() << "] too far from actor ["
+           << guest.name << "]" << std::endl;
+    return;
+  }
+
+  gzmsg << "Actor [" << guest.name << "] is following target ["
+        << _req.data() << "]" << std::endl;
+
+  if (!this->dataPtr->following)
+  {
+    this->dataPtr->following = true;
+    this->dataPtr->followingIgnPub.Publish(_req);
+  }
+
+  _res.set_data(true);
+  _result = true;
+}
+
+/////////////////////////////////////////////////
+void Simulator2d::OnUnfollow(ignition::msgs::Boolean &_res, bool &_result)
+{
+  if (!this->dataPtr->following)
+  {
+    _res.set_data(false);
+    _result = false;
+    return;
+  }
+
+  gzmsg << "Actor [" << this->dataPtr->actors[this->dataPtr->guest].name
+        << "] stopped following target [" << this->dataPtr->robotName << "]"
+        << std::endl;
+
+  this->dataPtr->following = false;
+
+  ignition::msgs::StringMsg followingMsg;
+  this->dataPtr->followingIgnPub.Publish(followingMsg);
+
+  // Publish drift notification
+  // 3: user requested
+  ignition::msgs::UInt32 msg;
+  msg.set_data(FollowBehavior::REQUESTED);
+  this->dataPtr->driftIgnPub.Publish(msg);
+
+  _res.set_data(true);
+  _result = true;
+}
+
+/////////////////////////////////////////////////
+bool Simulator2d::OnDriftRosService(
+    servicesim_competition::Drift::Request &/*_req*/,
+    servicesim_competition::Drift::Response &_res)
+{
+  _res.drift = true;
+  this->dataPtr->driftFlag = true;
+  return true;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_SIMULATOR2D_HH_
+#define SERVICESIM_SIMULATOR2D_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <geometry_msgs/Twist.h>
+#include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/stringmsg.pb.h>
+#include <ros/ros.h>
+#include <sdf/sdf.hh>
+#include <servicesim_competition/Drift.h>
+
+namespace servicesim
+{
+  class Simulator2dPrivate;
+
+  /// \brief Runs the competition of a servicesim world on a 2D map, without
+  /// Gazebo's server, physics, rendering or sensors, so tasks can be run
+  /// and scored many times faster than real time.
+  ///
+  /// The checkpoints, scoring, rooms, drift schedule and follow behavior
+  /// are the same classes the Gazebo plugins use. The map holds the
+  /// footprints of the world's static collisions, the robot is a circle
+  /// moved by the kinematic base, trajectory actors walk their waypoints
+  /// and the guest follows the robot. The robot's ROS interface is the one
+  /// of the kinematic base and the RFID reader: cmd_vel, odom, the odometry
+  /// transform and rfid, under the robot's namespace.
+  class Simulator2d
+  {
+    /// \brief Constructor
+    public: Simulator2d();
+
+    /// \brief Destructor
+    public: ~Simulator2d();
+
+    /// \brief Load a world file, build the map and advertise the ROS and
+    /// Ignition interfaces. ROS must have been initialized.
+    /// \param[in] _path Path to the .world file.
+    /// \param[in] _seed Seed for all random streams, zero to use the
+    /// world's RandomSeedPlugin.
+    /// \return False if the world couldn't be loaded.
+    public: bool Load(const std::string &_path, const uint32_t _seed);
+
+    /// \brief Advance the simulation by one step.
+    /// \param[in] _dt Step size in seconds.
+    public: void Step(const double _dt);
+
+    /// \brief Current sim time.
+    /// \return Time in seconds.
+    public: double SimTime() const;
+
+    /// \brief Current score, including penalties.
+    /// \return Score.
+    public: double Score() const;
+
+    /// \brief Whether all checkpoints have been completed.
+    /// \return True once complete.
+    public: bool Complete() const;
+
+    /// \brief Build the occupancy grid from the world's static collisions.
+    /// \param[in] _world The <world> element.
+    /// \param[in] _ground Name of the ground model, which is skipped.
+    private: void BuildMap(const sdf::ElementPtr &_world,
+        const std::string &_ground);
+
+    /// \brief Load the actors and the plugins which move them.
+    /// \param[in] _world The <world> element.
+    private: void LoadActors(const sdf::ElementPtr &_world);
+
+    /// \brief Distance from a point to the nearest occupied cell.
+    /// \param[in] _x X position.
+    /// \param[in] _y Y position.
+    /// \param[in] _radius Largest distance searched.
+    /// \return Distance, or _radius if there are no occupied cells closer.
+    private: double Clearance(const double _x, const double _y,
+        const double _radius) const;
+
+    /// \brief Move the robot and check it against the map.
+    /// \param[in] _dt Step size.
+    private: void UpdateRobot(const double _dt);
+
+    /// \brief Move the actors.
+    /// \param[in] _dt Step size.
+    private: void UpdateActors(const double _dt);
+
+    /// \brief Add penalties for the robot being close to or touching
+    /// humans and objects.
+    /// \param[in] _dt Step size.
+    private: void UpdatePenalties(const double _dt);
+
+    /// \brief Publish the clock, odometry and RFID readings.
+    private: void Publish();
+
+    /// \brief Callback for velocity commands.
+    /// \param[in] _msg Command.
+    private: void OnCommand(const geometry_msgs::Twist::ConstPtr &_msg);
+
+    /// \brief Callback for the guest's follow service.
+    /// \param[in] _req Name of the model to follow.
+    /// \param[out] _res True if the guest started following.
+    /// \param[out] _result Same as _res.
+    private: void OnFollow(const ignition::msgs::StringMsg &_req,
+        ignition::msgs::Boolean &_res, bool &_result);
+
+    /// \brief Callback for the guest's unfollow service.
+    /// \param[out] _res True if the guest was following.
+    /// \param[out] _result Same as _res.
+    private: void OnUnfollow(ignition::msgs::Boolean &_res, bool &_result);
+
+    /// \brief Callback for the drift cheat service.
+    /// \param[in] _req Empty request.
+    /// \param[out] _res Response.
+    /// \return True.
+    private: bool OnDriftRosService(
+        servicesim_competition::Drift::Request &_req,
+        servicesim_competition::Drift::Response &_res);
+
+    /// \internal
+    private: std::unique_ptr<Simulator2dPrivate> dataPtr;
+  };
+}
+#endif
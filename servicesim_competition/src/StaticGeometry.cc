@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Box.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Mesh.hh>
+#include <gazebo/common/MeshManager.hh>
+#include <gazebo/common/SystemPaths.hh>
+#include <gazebo/physics/physics.hh>
+
+#include "StaticGeometry.hh"
+
+/// \brief Footprint of a collision.
+/// \param[in] _type BOX_SHAPE, CYLINDER_SHAPE, or anything else to use the
+/// bounding box. Meshes are handled by AddMeshFootprints instead.
+/// \param[in] _size Box size, or cylinder radius on X.
+/// \param[in] _pose Collision pose in the world.
+/// \param[in] _box Collision bounding box in the world.
+/// \return The footprint.
+static servicesim::StaticFootprint Footprint(
+    const gazebo::physics::Base::EntityType _type,
+    const ignition::math::Vector3d &_size,
+    const ignition::math::Pose3d &_pose, const ignition::math::Box &_box)
+{
+  servicesim::StaticFootprint footprint;
+  footprint.zMin = _box.Min().Z();
+  footprint.zMax = _box.Max().Z();
+
+  bool upright = std::abs(_pose.Rot().Roll()) < 1e-3 &&
+                 std::abs(_pose.Rot().Pitch()) < 1e-3;
+
+  // Upright boxes keep their orientation on the plane
+  if (_type == gazebo::physics::Base::BOX_SHAPE && upright)
+  {
+    auto half = _size * 0.5;
+    std::vector<ignition::math::Vector3d> corners{
+        {-half.X(), -half.Y(), 0}, {half.X(), -half.Y(), 0},
+        {half.X(), half.Y(), 0}, {-half.X(), half.Y(), 0}};
+    for (const auto &corner : corners)
+    {
+      auto point = _pose.Pos() + _pose.Rot().RotateVector(corner);
+      footprint.corners.push_back(
+          ignition::math::Vector2d(point.X(), point.Y()));
+    }
+  }
+  // Upright cylinders become polygons
+  else if (_type == gazebo::physics::Base::CYLINDER_SHAPE && upright)
+  {
+    const unsigned int sides{12};
+    auto radius = _size.X();
+    for (unsigned int i = 0; i < sides; ++i)
+    {
+      auto angle = 2 * IGN_PI * i / sides;
+      footprint.corners.push_back(ignition::math::Vector2d(
+          _pose.Pos().X() + radius * std::cos(angle),
+          _pose.Pos().Y() + radius * std::sin(angle)));
+    }
+  }
+  // Everything else, such as spheres, uses its bounding box
+  else
+  {
+    auto min = _box.Min();
+    auto max = _box.Max();
+    footprint.corners.push_back(ignition::math::Vector2d(min.X(), min.Y()));
+    footprint.corners.push_back(ignition::math::Vector2d(max.X(), min.Y()));
+    footprint.corners.push_back(ignition::math::Vector2d(max.X(), max.Y()));
+    footprint.corners.push_back(ignition::math::Vector2d(min.X(), max.Y()));
+  }
+
+  return footprint;
+}
+
+/// \brief Bounding box in the world of a shape's local bounding box.
+/// \param[in] _pose Shape pose in the world.
+/// \param[in] _min Local minimum corner.
+/// \param[in] _max Local maximum corner.
+/// \return World bounding box.
+static ignition::math::Box WorldBox(const ignition::math::Pose3d &_pose,
+    const ignition::math::Vector3d &_min,
+    const ignition::math::Vector3d &_max)
+{
+  ignition::math::Vector3d min(IGN_DBL_MAX, IGN_DBL_MAX, IGN_DBL_MAX);
+  ignition::math::Vector3d max(-IGN_DBL_MAX, -IGN_DBL_MAX, -IGN_DBL_MAX);
+  for (unsigned int i = 0; i < 8; ++i)
+  {
+    ignition::math::Vector3d corner(
+        (i & 1) ? _max.X() : _min.X(),
+        (i & 2) ? _max.Y() : _min.Y(),
+        (i & 4) ? _max.Z() : _min.Z());
+    auto point = _pose.CoordPositionAdd(corner);
+    min.Min(point);
+    max.Max(point);
+  }
+  return ignition::math::Box(min, max);
+}
+
+/// \brief Add one footprint per triangle of a mesh collision, each with its
+/// own height range, so openings such as doorways stay free below the parts
+/// of the mesh spanning them. All sub-meshes are used.
+/// \param[in] _mesh The <mesh> element.
+/// \param[in] _pose Collision pose in the world.
+/// \param[out] _footprints Footprints to add to.
+/// \return False if the mesh couldn't be loaded.
+static bool AddMeshFootprints(const sdf::ElementPtr &_mesh,
+    const ignition::math::Pose3d &_pose,
+    std::vector<servicesim::StaticFootprint> &_footprints)
+{
+  auto uri = _mesh->Get<std::string>("uri");
+  auto path = gazebo::common::SystemPaths::Instance()->FindFileURI(uri);
+  auto mesh = path.empty() ? nullptr :
+      gazebo::common::MeshManager::Instance()->Load(path);
+  if (!mesh)
+    return false;
+
+  auto scale = _mesh->Get<ignition::math::Vector3d>("scale");
+  for (unsigned int s = 0; s < mesh->GetSubMeshCount(); ++s)
+  {
+    auto subMesh = mesh->GetSubMesh(s);
+    if (subMesh->GetPrimitiveType() != gazebo::common::SubMesh::TRIANGLES)
+      continue;
+
+    for (unsigned int i = 0; i + 2 < subMesh->GetIndexCount(); i += 3)
+    {
+      servicesim::StaticFootprint footprint;
+      footprint.zMin = IGN_DBL_MAX;
+      footprint.zMax = -IGN_DBL_MAX;
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        auto point = _pose.CoordPositionAdd(
+            subMesh->Vertex(subMesh->GetIndex(i + k)) * scale);
+        footprint.corners.push_back(
+            ignition::math::Vector2d(point.X(), point.Y()));
+        footprint.zMin = std::min(footprint.zMin, point.Z());
+        footprint.zMax = std::max(footprint.zMax, point.Z());
+      }
+      _footprints.push_back(footprint);
+    }
+  }
+  return true;
+}
+
+/// \brief Add the footprints of a model described in SDF and of its nested
+/// models.
+/// \param[in] _model The <model> element.
+/// \param[in] _parentPose Pose of the parent model in the world.
+/// \param[in] _parentStatic True if the parent model is static.
+/// \param[in] _exclude Name of a model to skip.
+/// \param[out] _footprints Footprints to add to.
+static void AddModelFootprints(const sdf::ElementPtr &_model,
+    const ignition::math::Pose3d &_parentPose, const bool _parentStatic,
+    const std::string &_exclude,
+    std::vector<servicesim::StaticFootprint> &_footprints)
+{
+  if (_model->Get<std::string>("name") == _exclude)
+    return;
+
+  auto modelPose = _model->Get<ignition::math::Pose3d>("pose") + _parentPose;
+  bool isStatic = _parentStatic || _model->Get<bool>("static");
+
+  auto nested = _model->HasElement("model") ? _model->GetElement("model") :
+      nullptr;
+  while (nested)
+  {
+    AddModelFootprints(nested, modelPose, isStatic, _exclude, _footprints);
+    nested = nested->GetNextElement("model");
+  }
+
+  if (!isStatic)
+    return;
+
+  auto link = _model->HasElement("link") ? _model->GetElement("link") :
+      nullptr;
+  while (link)
+  {
+    auto linkPose = link->Get<ignition::math::Pose3d>("pose") + modelPose;
+
+    auto collision = link->HasElement("collision") ?
+        link->GetElement("collision") : nullptr;
+    while (collision)
+    {
+      auto pose = collision->Get<ignition::math::Pose3d>("pose") + linkPose;
+      auto geometry = collision->GetElement("geometry");
+
+      gazebo::physics::Base::EntityType type{gazebo::physics::Base::BASE};
+      ignition::math::Vector3d size;
+      ignition::math::Vector3d min;
+      ignition::math::Vector3d max;
+      bool valid{true};
+      if (geometry->HasElement("box"))
+      {
+        type = gazebo::physics::Base::BOX_SHAPE;
+        size = geometry->GetElement("box")->Get<ignition::math::Vector3d>(
+            "size");
+        max = size * 0.5;
+        min = -max;
+      }
+      else if (geometry->HasElement("cylinder"))
+      {
+        type = gazebo::physics::Base::CYLINDER_SHAPE;
+        auto cylinder = geometry->GetElement("cylinder");
+        size.X(cylinder->Get<double>("radius"));
+        max.Set(size.X(), size.X(), cylinder->Get<double>("length") * 0.5);
+        min = -max;
+      }
+      else if (geometry->HasElement("sphere"))
+      {
+        auto radius = geometry->GetElement("sphere")->Get<double>("radius");
+        max.Set(radius, radius, radius);
+        min = -max;
+      }
+      else if (geometry->HasElement("mesh"))
+      {
+        auto meshElem = geometry->GetElement("mesh");
+        if (!AddMeshFootprints(meshElem, pose, _footprints))
+        {
+          gzwarn << "Failed to load mesh [" << meshElem->Get<std::string>("uri")
+                 << "], skipping it" << std::endl;
+        }
+        valid = false;
+      }
+      // Ground planes are infinite and below everything anyway
+      else
+      {
+        valid = false;
+      }
+
+      if (valid)
+      {
+        _footprints.push_back(Footprint(type, size, pose,
+            WorldBox(pose, min, max)));
+      }
+
+      collision = collision->GetNextElement("collision");
+    }
+    link = link->GetNextElement("link");
+  }
+}
+
+//////////////////////////////////////////////////
+std::vector<servicesim::StaticFootprint> servicesim::staticFootprints(
+    const gazebo::physics::WorldPtr &_world,
+    const gazebo::physics::ModelPtr &_exclude)
+{
+  std::vector<StaticFootprint> footprints;
+
+  for (const auto &model : _world->Models())
+  {
+    if (!model->IsStatic() || model == _exclude)
+      continue;
+
+    for (const auto &link : model->GetLinks())
+    {
+      for (const auto &collision : link->GetCollisions())
+      {
+        // Ground planes are infinite and below everything anyway
+        if (collision->HasType(gazebo::physics::Base::PLANE_SHAPE))
+          continue;
+
+        auto box = collision->BoundingBox();
+        auto pose = collision->WorldPose();
+
+        // Meshes are split into triangles, falling back to the bounding box
+        // if they can't be loaded
+        if (collision->HasType(gazebo::physics::Base::MESH_SHAPE))
+        {
+          auto geometry = collision->GetSDF()->GetElement("geometry");
+          if (geometry->HasElement("mesh") && AddMeshFootprints(
+              geometry->GetElement("mesh"), pose, footprints))
+          {
+            continue;
+          }
+        }
+
+        auto boxShape = boost::dynamic_pointer_cast<gazebo::physics::BoxShape>(
+            collision->GetShape());
+        auto cylinderShape =
+            boost::dynamic_pointer_cast<gazebo::physics::CylinderShape>(
+            collision->GetShape());
+
+        gazebo::physics::Base::EntityType type{gazebo::physics::Base::BASE};
+        ignition::math::Vector3d size;
+        if (boxShape)
+        {
+          type = gazebo::physics::Base::BOX_SHAPE;
+          size = boxShape->Size();
+        }
+        else if (cylinderShape)
+        {
+          type = gazebo::physics::Base::CYLINDER_SHAPE;
+          size.X(cylinderShape->GetRadius());
+        }
+
+        footprints.push_back(Footprint(type, size, pose, box));
+      }
+    }
+  }
+
+  return footprints;
+}
+
+//////////////////////////////////////////////////
+std::vector<servicesim::StaticFootprint> servicesim::staticFootprints(
+    const sdf::ElementPtr &_world, const std::string &_exclude)
+{
+  std::vector<StaticFootprint> footprints;
+
+  auto model = _world->HasElement("model") ? _world->GetElement("model") :
+      nullptr;
+  while (model)
+  {
+    AddModelFootprints(model, ignition::math::Pose3d::Zero, false, _exclude,
+        footprints);
+    model = model->GetNextElement("model");
+  }
+
+  return footprints;
+}
+
+//////////////////////////////////////////////////
+void servicesim::flattenFootprints(
+    const std::vector<StaticFootprint> &_footprints,
+    LidarRaycaster &_raycaster)
+{
+  _raycaster.ClearStatic();
+
+  for (const auto &footprint : _footprints)
+  {
+    const auto &corners = footprint.corners;
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+      const auto &a = corners[i];
+      const auto &b = corners[(i + 1) % corners.size()];
+      _raycaster.AddStaticSegment(a.X(), a.Y(), b.X(), b.Y(),
+          footprint.zMin, footprint.zMax);
+    }
+  }
+
+  _raycaster.BuildStatic();
+}
+
+//////////////////////////////////////////////////
+void servicesim::flattenStaticModels(const gazebo::physics::WorldPtr &_world,
+    const gazebo::physics::ModelPtr &_exclude, LidarRaycaster &_raycaster)
+{
+  flattenFootprints(staticFootprints(_world, _exclude), _raycaster);
+}
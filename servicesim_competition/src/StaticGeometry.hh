@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_STATICGEOMETRY_HH_
+#define SERVICESIM_STATICGEOMETRY_HH_
+
+#include <string>
+#include <vector>
+
+#include <ignition/math/Vector2.hh>
+#include <sdf/sdf.hh>
+#include <gazebo/physics/PhysicsTypes.hh>
+
+#include "LidarRaycaster.hh"
+
+namespace servicesim
+{
+  /// \brief Footprint of a static collision, or of one triangle of a mesh
+  /// collision, on the XY plane.
+  struct StaticFootprint
+  {
+    /// \brief Corners of a convex polygon, in order. Triangles of vertical
+    /// faces are degenerate, with collinear corners.
+    std::vector<ignition::math::Vector2d> corners;
+
+    /// \brief Lowest height of the collision
+    double zMin{0.0};
+
+    /// \brief Highest height of the collision
+    double zMax{0.0};
+  };
+
+  /// \brief Get the footprints of the collisions of all static models in
+  /// the world. Upright boxes keep their orientation, upright cylinders
+  /// become polygons, meshes give one footprint per triangle and everything
+  /// else uses its axis-aligned bounding box. Ground planes are skipped.
+  ///
+  /// Since each triangle keeps its own height range, filtering footprints
+  /// by height leaves openings such as doorways free below a door frame.
+  /// \param[in] _world World holding the models.
+  /// \param[in] _exclude Model to skip, such as the one a sensor is on.
+  /// May be null.
+  /// \return All footprints.
+  std::vector<StaticFootprint> staticFootprints(
+      const gazebo::physics::WorldPtr &_world,
+      const gazebo::physics::ModelPtr &_exclude);
+
+  /// \brief Get the footprints of the collisions of all static models in a
+  /// world description, with the same shapes as above, for tools which
+  /// don't load the world into Gazebo. Meshes are loaded to get their
+  /// triangles.
+  /// \param[in] _world The <world> element.
+  /// \param[in] _exclude Name of a model to skip, such as the ground. May
+  /// be empty.
+  /// \return All footprints.
+  std::vector<StaticFootprint> staticFootprints(
+      const sdf::ElementPtr &_world, const std::string &_exclude);
+
+  /// \brief Add the edges of footprints to a raycaster's static geometry,
+  /// as 2D segments which keep their height range.
+  ///
+  /// The raycaster's static geometry is cleared first and built at the end.
+  /// \param[in] _footprints Footprints, such as from staticFootprints.
+  /// \param[out] _raycaster Raycaster to fill.
+  void flattenFootprints(const std::vector<StaticFootprint> &_footprints,
+      LidarRaycaster &_raycaster);
+
+  /// \brief Flatten the collisions of all static models in the world into
+  /// 2D segments which keep their height range, and add them to a
+  /// raycaster's static geometry. The segments are the edges of
+  /// staticFootprints.
+  ///
+  /// The raycaster's static geometry is cleared first and built at the end.
+  /// \param[in] _world World holding the models.
+  /// \param[in] _exclude Model to skip, such as the one the sensor is on.
+  /// May be null.
+  /// \param[out] _raycaster Raycaster to fill.
+  void flattenStaticModels(const gazebo::physics::WorldPtr &_world,
+      const gazebo::physics::ModelPtr &_exclude, LidarRaycaster &_raycaster);
+}
+#endif
@@ -15,7 +15,11 @@
  *
 */
 
+#include <cmath>
 #include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
@@ -25,7 +29,11 @@
 #include <gazebo/common/KeyFrame.hh>
 #include <gazebo/physics/physics.hh>
 
+#include "LoadProfiler.hh"
+#include "NavGraph.hh"
+#include "RandomStream.hh"
 #include "TrajectoryActorPlugin.hh"
+#include "TrajectoryLibrary.hh"
 
 using namespace gazebo;
 using namespace servicesim;
@@ -42,12 +50,34 @@ class servicesim::TrajectoryActorPluginPrivate
   /// \brief List of connections such as WorldUpdateBegin
   public: std::vector<event::ConnectionPtr> connections;
 
-  /// \brief List of targets
-  public: std::vector<ignition::math::Pose3d> targets;
+  /// \brief Targets, possibly shared with other actors
+  public: std::shared_ptr<const Trajectory> trajectory{nullptr};
+
+  /// \brief Index of the first target
+  public: unsigned int offset{0};
 
   /// \brief Current target index
   public: unsigned int currentTarget{0};
 
+  /// \brief True to walk between random places of the world's navigation
+  /// graph instead of following a trajectory
+  public: bool wander{false};
+
+  /// \brief Navigation graph, once built
+  public: std::shared_ptr<const NavGraph> graph{nullptr};
+
+  /// \brief Graph node being walked to, kNone until placed on the graph
+  public: uint16_t node{NavGraph::kNone};
+
+  /// \brief Graph node walked from
+  public: uint16_t previousNode{NavGraph::kNone};
+
+  /// \brief Graph node of the current destination
+  public: uint16_t destination{NavGraph::kNone};
+
+  /// \brief Picks destinations
+  public: RandomStream random;
+
   /// \brief Radius in meters around target pose where we consider it was
   /// reached.
   public: double targetRadius{0.5};
@@ -85,6 +115,8 @@ TrajectoryActorPlugin::TrajectoryActorPlugin()
 /////////////////////////////////////////////////
 void TrajectoryActorPlugin::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
 {
+  LoadTimer timer("TrajectoryActorPlugin::Load", "plugin", _model->GetName());
+
   this->dataPtr->actor = boost::dynamic_pointer_cast<physics::Actor>(_model);
 
   this->dataPtr->connections.push_back(event::Events::ConnectWorldUpdateBegin(
@@ -98,12 +130,51 @@ void TrajectoryActorPlugin::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
   if (_sdf->HasElement("velocity"))
     this->dataPtr->velocity = _sdf->Get<double>("velocity");
 
-  // Read in the target poses
-  auto targetElem = _sdf->GetElement("target");
-  while (targetElem)
+  // Read in the targets, either shared from the world's trajectory library
+  // or given as poses, unless wandering around the navigation graph
+  if (_sdf->HasElement("wander"))
+    this->dataPtr->wander = _sdf->Get<bool>("wander");
+
+  if (this->dataPtr->wander)
+  {
+    this->dataPtr->random.SetName("TrajectoryActorPlugin/" +
+        _model->GetName());
+  }
+  else if (_sdf->HasElement("trajectory"))
+  {
+    auto name = _sdf->Get<std::string>("trajectory");
+    this->dataPtr->trajectory = TrajectoryLibrary::Instance().Get(name);
+    if (!this->dataPtr->trajectory)
+    {
+      gzerr << "Trajectory [" << name << "] not found in the library, actor ["
+            << _model->GetName() << "] won't move." << std::endl;
+    }
+  }
+  else if (_sdf->HasElement("target"))
+  {
+    std::vector<ignition::math::Pose3d> targets;
+    auto targetElem = _sdf->GetElement("target");
+    while (targetElem)
+    {
+      targets.push_back(targetElem->Get<ignition::math::Pose3d>());
+      targetElem = targetElem->GetNextElement("target");
+    }
+    this->dataPtr->trajectory = std::make_shared<const Trajectory>(targets);
+  }
+  else
+  {
+    gzerr << "No <wander>, <trajectory> or <target> sdf elements found."
+          << std::endl;
+  }
+
+  // Read in the index of the first target
+  if (_sdf->HasElement("offset"))
+    this->dataPtr->offset = _sdf->Get<unsigned int>("offset");
+
+  if (this->dataPtr->trajectory)
   {
-    this->dataPtr->targets.push_back(targetElem->Get<ignition::math::Pose3d>());
-    targetElem = targetElem->GetNextElement("target");
+    this->dataPtr->currentTarget =
+        this->dataPtr->offset % this->dataPtr->trajectory->Size();
   }
 
   // Read in the target mradius
@@ -155,7 +226,12 @@ void TrajectoryActorPlugin::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
 /////////////////////////////////////////////////
 void TrajectoryActorPlugin::Reset()
 {
-  this->dataPtr->currentTarget = 0;
+  this->dataPtr->node = NavGraph::kNone;
+  if (this->dataPtr->trajectory)
+  {
+    this->dataPtr->currentTarget =
+        this->dataPtr->offset % this->dataPtr->trajectory->Size();
+  }
   this->dataPtr->cornerAnimation = nullptr;
   this->dataPtr->lastUpdate = common::Time::Zero;
 }
@@ -217,7 +293,7 @@ void TrajectoryActorPlugin::UpdateTarget()
   auto actorPos = this->dataPtr->actor->WorldPose().Pos();
 
   // Current target
-  auto target = this->dataPtr->targets[this->dataPtr->currentTarget].Pos();
+  auto target = this->Target();
 
   // 2D distance to target
   auto posDiff = target - actorPos;
@@ -230,14 +306,124 @@ void TrajectoryActorPlugin::UpdateTarget()
     return;
 
   // Move on to next target
+  if (this->dataPtr->wander)
+  {
+    if (this->dataPtr->node == this->dataPtr->destination)
+      this->PickDestination();
+
+    this->dataPtr->previousNode = this->dataPtr->node;
+    auto next = this->dataPtr->graph->NextHop(this->dataPtr->node,
+        this->dataPtr->destination);
+    if (next != NavGraph::kNone)
+      this->dataPtr->node = next;
+    return;
+  }
+
   this->dataPtr->currentTarget++;
-  if (this->dataPtr->currentTarget > this->dataPtr->targets.size() - 1)
+  if (this->dataPtr->currentTarget > this->dataPtr->trajectory->Size() - 1)
     this->dataPtr->currentTarget = 0;
 }
 
+/////////////////////////////////////////////////
+bool TrajectoryActorPlugin::PlaceOnGraph()
+{
+  if (this->dataPtr->node != NavGraph::kNone)
+    return true;
+
+  // The graph is built on the first world update
+  if (!this->dataPtr->graph)
+    this->dataPtr->graph = TrajectoryLibrary::Instance().Graph();
+
+  if (!this->dataPtr->graph)
+    return false;
+
+  this->dataPtr->node = this->dataPtr->graph->Nearest(
+      this->dataPtr->actor->WorldPose().Pos());
+  this->dataPtr->previousNode = this->dataPtr->node;
+  this->PickDestination();
+
+  return this->dataPtr->node != NavGraph::kNone;
+}
+
+/////////////////////////////////////////////////
+void TrajectoryActorPlugin::PickDestination()
+{
+  const auto &graph = this->dataPtr->graph;
+
+  std::vector<size_t> candidates;
+  for (auto destination : graph->Destinations())
+  {
+    if (destination != this->dataPtr->node &&
+        !std::isinf(graph->Distance(this->dataPtr->node, destination)))
+    {
+      candidates.push_back(destination);
+    }
+  }
+
+  // Nowhere to go, stay
+  if (candidates.empty())
+  {
+    this->dataPtr->destination = this->dataPtr->node;
+    return;
+  }
+
+  this->dataPtr->destination = static_cast<uint16_t>(candidates[
+      this->dataPtr->random.IntUniform(0, candidates.size() - 1)]);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d TrajectoryActorPlugin::Target() const
+{
+  if (!this->dataPtr->wander)
+  {
+    return this->dataPtr->trajectory->Waypoint(
+        this->dataPtr->currentTarget).Pos();
+  }
+
+  // Graph nodes may be at any height, the actor stays at its own
+  auto target = this->dataPtr->graph->Position(this->dataPtr->node);
+  target.Z(this->dataPtr->actor->WorldPose().Pos().Z());
+  return target;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d TrajectoryActorPlugin::PreviousTarget() const
+{
+  if (!this->dataPtr->wander)
+  {
+    return this->dataPtr->trajectory->Waypoint(
+        this->dataPtr->currentTarget + this->dataPtr->trajectory->Size() - 1)
+        .Pos();
+  }
+
+  auto target = this->dataPtr->graph->Position(this->dataPtr->previousNode);
+  target.Z(this->dataPtr->actor->WorldPose().Pos().Z());
+  return target;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d TrajectoryActorPlugin::SegmentDirection() const
+{
+  if (!this->dataPtr->wander)
+  {
+    return this->dataPtr->trajectory->Direction(
+        this->dataPtr->currentTarget + this->dataPtr->trajectory->Size() - 1);
+  }
+
+  auto dir = this->Target() - this->PreviousTarget();
+  dir.Z(0);
+  return dir.Length() > 0 ? dir.Normalize() : dir;
+}
+
 /////////////////////////////////////////////////
 void TrajectoryActorPlugin::OnUpdate(const common::UpdateInfo &_info)
 {
+  if (this->dataPtr->wander ? !this->PlaceOnGraph() :
+      !this->dataPtr->trajectory)
+  {
+    return;
+  }
+
   // Time delta
   double dt = (_info.simTime - this->dataPtr->lastUpdate).Double();
 
@@ -257,10 +443,10 @@ void TrajectoryActorPlugin::OnUpdate(const common::UpdateInfo &_info)
   auto actorPose = this->dataPtr->actor->WorldPose();
 
   // Current target
-  auto targetPose = this->dataPtr->targets[this->dataPtr->currentTarget];
+  auto targetPos = this->Target();
 
   // Direction to target
-  auto dir = (targetPose.Pos() - actorPose.Pos()).Normalize();
+  auto dir = (targetPos - actorPose.Pos()).Normalize();
 
   // TODO: generalize for actors facing other directions
   auto currentYaw = actorPose.Rot().Yaw();
@@ -276,15 +462,10 @@ void TrajectoryActorPlugin::OnUpdate(const common::UpdateInfo &_info)
     if (!this->dataPtr->cornerAnimation)
     {
       // Previous target (we assume we just reached it)
-      int previousTarget = this->dataPtr->currentTarget - 1;
-      if (previousTarget < 0)
-        previousTarget = this->dataPtr->targets.size() - 1;
-
-      auto prevTargetPos = this->dataPtr->targets[previousTarget].Pos();
+      auto prevTargetPos = this->PreviousTarget();
 
       // Direction from previous target to current target
-      auto prevDir = (targetPose.Pos() - prevTargetPos).Normalize() *
-          this->dataPtr->targetRadius;
+      auto prevDir = this->SegmentDirection() * this->dataPtr->targetRadius;
 
       // Curve end point
       auto endPt = prevTargetPos + prevDir;
@@ -18,6 +18,7 @@
 #ifndef SERVICESIM_PLUGINS_WANDERINGACTORPLUGIN_HH_
 #define SERVICESIM_PLUGINS_WANDERINGACTORPLUGIN_HH_
 
+#include <ignition/math/Vector3.hh>
 #include <gazebo/common/Plugin.hh>
 #include "gazebo/util/system.hh"
 
@@ -50,6 +51,27 @@ namespace servicesim
     /// \brief Update target
     private: void UpdateTarget();
 
+    /// \brief In wander mode, place the actor on the navigation graph once
+    /// the world's graph has been built.
+    /// \return True if the actor is on the graph.
+    private: bool PlaceOnGraph();
+
+    /// \brief Pick a random named place reachable from the current node.
+    private: void PickDestination();
+
+    /// \brief Position of the current target.
+    /// \return Target position.
+    private: ignition::math::Vector3d Target() const;
+
+    /// \brief Position of the target which was just reached.
+    /// \return Previous target position.
+    private: ignition::math::Vector3d PreviousTarget() const;
+
+    /// \brief Unit direction from the previous target to the current one,
+    /// on the XY plane.
+    /// \return Direction.
+    private: ignition::math::Vector3d SegmentDirection() const;
+
     /// \internal
     private: TrajectoryActorPluginPrivate *dataPtr;
   };
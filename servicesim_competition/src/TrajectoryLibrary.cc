@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "TrajectoryLibrary.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+Trajectory::Trajectory(const std::vector<ignition::math::Pose3d> &_waypoints)
+    : waypoints(_waypoints)
+{
+  for (size_t i = 0; i < this->waypoints.size(); ++i)
+  {
+    auto diff = this->Waypoint(i + 1).Pos() - this->Waypoint(i).Pos();
+    diff.Z(0);
+
+    auto length = diff.Length();
+    this->lengths.push_back(length);
+    this->directions.push_back(length > 0 ? diff / length :
+        ignition::math::Vector3d::Zero);
+    this->length += length;
+  }
+}
+
+/////////////////////////////////////////////////
+size_t Trajectory::Size() const
+{
+  return this->waypoints.size();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Pose3d &Trajectory::Waypoint(const size_t _index) const
+{
+  return this->waypoints[_index % this->waypoints.size()];
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Vector3d &Trajectory::Direction(const size_t _index)
+    const
+{
+  return this->directions[_index % this->directions.size()];
+}
+
+/////////////////////////////////////////////////
+double Trajectory::SegmentLength(const size_t _index) const
+{
+  return this->lengths[_index % this->lengths.size()];
+}
+
+/////////////////////////////////////////////////
+double Trajectory::Length() const
+{
+  return this->length;
+}
+
+/////////////////////////////////////////////////
+TrajectoryLibrary &TrajectoryLibrary::Instance()
+{
+  static TrajectoryLibrary instance;
+  return instance;
+}
+
+/////////////////////////////////////////////////
+bool TrajectoryLibrary::Add(const std::string &_name,
+    const std::vector<ignition::math::Pose3d> &_waypoints)
+{
+  if (_waypoints.empty())
+    return false;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->trajectories.find(_name) != this->trajectories.end())
+    return false;
+
+  this->trajectories[_name] = std::make_shared<const Trajectory>(_waypoints);
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<const Trajectory> TrajectoryLibrary::Get(
+    const std::string &_name) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto it = this->trajectories.find(_name);
+  if (it == this->trajectories.end())
+    return nullptr;
+  return it->second;
+}
+
+/////////////////////////////////////////////////
+size_t TrajectoryLibrary::Count() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->trajectories.size();
+}
+
+/////////////////////////////////////////////////
+void TrajectoryLibrary::SetGraph(const std::shared_ptr<const NavGraph> &_graph)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->graph = _graph;
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<const NavGraph> TrajectoryLibrary::Graph() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->graph;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_TRAJECTORYLIBRARY_HH_
+#define SERVICESIM_TRAJECTORYLIBRARY_HH_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "NavGraph.hh"
+
+namespace servicesim
+{
+  /// \brief A closed path through waypoints, with the geometry of its
+  /// segments computed once.
+  ///
+  /// Indices wrap around, so a path can be followed from any offset.
+  class Trajectory
+  {
+    /// \brief Constructor
+    /// \param[in] _waypoints Waypoint poses, the last one leads back to the
+    /// first.
+    public: explicit Trajectory(
+        const std::vector<ignition::math::Pose3d> &_waypoints);
+
+    /// \brief Number of waypoints.
+    /// \return Waypoint count.
+    public: size_t Size() const;
+
+    /// \brief Get a waypoint.
+    /// \param[in] _index Waypoint index, wrapped around.
+    /// \return Waypoint pose.
+    public: const ignition::math::Pose3d &Waypoint(const size_t _index) const;
+
+    /// \brief Direction of the segment from a waypoint to the next one.
+    /// \param[in] _index Waypoint index, wrapped around.
+    /// \return Unit vector on the XY plane, zero for empty segments.
+    public: const ignition::math::Vector3d &Direction(const size_t _index)
+        const;
+
+    /// \brief Length of the segment from a waypoint to the next one.
+    /// \param[in] _index Waypoint index, wrapped around.
+    /// \return Length on the XY plane in meters.
+    public: double SegmentLength(const size_t _index) const;
+
+    /// \brief Length of the whole closed path.
+    /// \return Length on the XY plane in meters.
+    public: double Length() const;
+
+    /// \brief Waypoints
+    private: std::vector<ignition::math::Pose3d> waypoints;
+
+    /// \brief Direction from each waypoint to the next
+    private: std::vector<ignition::math::Vector3d> directions;
+
+    /// \brief Length from each waypoint to the next
+    private: std::vector<double> lengths;
+
+    /// \brief Total length
+    private: double length{0.0};
+  };
+
+  /// \brief Trajectories and the navigation graph, defined once per world
+  /// and shared by all actors using them, filled by the
+  /// TrajectoryLibraryPlugin.
+  class TrajectoryLibrary
+  {
+    /// \brief Get the library shared by all plugins.
+    /// \return The library.
+    public: static TrajectoryLibrary &Instance();
+
+    /// \brief Add a trajectory.
+    /// \param[in] _name Unique name.
+    /// \param[in] _waypoints Waypoint poses.
+    /// \return False if the name is taken or there are no waypoints.
+    public: bool Add(const std::string &_name,
+        const std::vector<ignition::math::Pose3d> &_waypoints);
+
+    /// \brief Get a trajectory.
+    /// \param[in] _name Trajectory name.
+    /// \return The trajectory, null if not found.
+    public: std::shared_ptr<const Trajectory> Get(const std::string &_name)
+        const;
+
+    /// \brief Number of trajectories.
+    /// \return Trajectory count.
+    public: size_t Count() const;
+
+    /// \brief Set the navigation graph.
+    /// \param[in] _graph Graph with its routes built.
+    public: void SetGraph(const std::shared_ptr<const NavGraph> &_graph);
+
+    /// \brief Get the navigation graph.
+    /// \return The graph, null until it has been built.
+    public: std::shared_ptr<const NavGraph> Graph() const;
+
+    /// \brief Constructor, use Instance() instead.
+    private: TrajectoryLibrary() = default;
+
+    /// \brief Protects trajectories and graph
+    private: mutable std::mutex mutex;
+
+    /// \brief Trajectories by name
+    private: std::map<std::string, std::shared_ptr<const Trajectory>>
+        trajectories;
+
+    /// \brief Navigation graph
+    private: std::shared_ptr<const NavGraph> graph{nullptr};
+  };
+}
+#endif
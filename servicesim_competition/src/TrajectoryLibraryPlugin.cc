@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/World.hh>
+
+#include "LidarRaycaster.hh"
+#include "LoadProfiler.hh"
+#include "NavGraph.hh"
+#include "StaticGeometry.hh"
+#include "TrajectoryLibrary.hh"
+#include "TrajectoryLibraryPlugin.hh"
+
+/////////////////////////////////////////////////
+class servicesim::TrajectoryLibraryPluginPrivate
+{
+  /// \brief Pointer to the world
+  public: gazebo::physics::WorldPtr world;
+
+  /// \brief Connection to world update, until the graph is built
+  public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+  /// \brief Waypoints of each trajectory, for the graph
+  public: std::vector<std::vector<ignition::math::Pose3d>> trajectories;
+
+  /// \brief Extra graph nodes
+  public: std::vector<ignition::math::Vector3d> waypoints;
+
+  /// \brief Graph destinations, with their names
+  public: std::vector<std::pair<std::string, ignition::math::Vector3d>>
+      places;
+
+  /// \brief Distance within which nodes are connected if the way is clear
+  public: double linkDistance{3.0};
+
+  /// \brief Half the width of the way which must be clear
+  public: double clearance{0.25};
+
+  /// \brief Height at which the way is checked
+  public: double height{0.5};
+};
+
+using namespace servicesim;
+GZ_REGISTER_WORLD_PLUGIN(servicesim::TrajectoryLibraryPlugin)
+
+/////////////////////////////////////////////////
+TrajectoryLibraryPlugin::TrajectoryLibraryPlugin()
+    : dataPtr(new TrajectoryLibraryPluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+void TrajectoryLibraryPlugin::Load(gazebo::physics::WorldPtr _world,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("TrajectoryLibraryPlugin::Load", "plugin");
+
+  this->dataPtr->world = _world;
+
+  if (!_sdf->HasElement("trajectory"))
+  {
+    gzerr << "No <trajectory> sdf elements found." << std::endl;
+    return;
+  }
+
+  unsigned int count{0};
+  unsigned int waypointCount{0};
+  auto trajectoryElem = _sdf->GetElement("trajectory");
+  while (trajectoryElem)
+  {
+    auto name = trajectoryElem->Get<std::string>("name");
+
+    std::vector<ignition::math::Pose3d> waypoints;
+    if (trajectoryElem->HasElement("waypoint"))
+    {
+      auto waypointElem = trajectoryElem->GetElement("waypoint");
+      while (waypointElem)
+      {
+        waypoints.push_back(waypointElem->Get<ignition::math::Pose3d>());
+        waypointElem = waypointElem->GetNextElement("waypoint");
+      }
+    }
+
+    if (waypoints.empty())
+    {
+      gzerr << "Trajectory [" << name << "] has no waypoints." << std::endl;
+    }
+    else if (!TrajectoryLibrary::Instance().Add(name, waypoints))
+    {
+      gzerr << "Trajectory [" << name << "] is defined more than once."
+            << std::endl;
+    }
+    else
+    {
+      count++;
+      waypointCount += waypoints.size();
+      this->dataPtr->trajectories.push_back(waypoints);
+    }
+
+    trajectoryElem = trajectoryElem->GetNextElement("trajectory");
+  }
+
+  gzmsg << "[ServiceSim] Trajectory library loaded with " << count
+        << " trajectories and " << waypointCount << " waypoints"
+        << std::endl;
+
+  if (!_sdf->HasElement("nav_graph"))
+    return;
+
+  auto graphElem = _sdf->GetElement("nav_graph");
+
+  if (graphElem->HasElement("link_distance"))
+    this->dataPtr->linkDistance = graphElem->Get<double>("link_distance");
+
+  if (graphElem->HasElement("clearance"))
+    this->dataPtr->clearance = graphElem->Get<double>("clearance");
+
+  if (graphElem->HasElement("height"))
+    this->dataPtr->height = graphElem->Get<double>("height");
+
+  if (graphElem->HasElement("waypoint"))
+  {
+    auto waypointElem = graphElem->GetElement("waypoint");
+    while (waypointElem)
+    {
+      this->dataPtr->waypoints.push_back(
+          waypointElem->Get<ignition::math::Vector3d>());
+      waypointElem = waypointElem->GetNextElement("waypoint");
+    }
+  }
+
+  if (graphElem->HasElement("place"))
+  {
+    auto placeElem = graphElem->GetElement("place");
+    while (placeElem)
+    {
+      this->dataPtr->places.push_back({placeElem->Get<std::string>("name"),
+          placeElem->Get<ignition::math::Vector3d>()});
+      placeElem = placeElem->GetNextElement("place");
+    }
+  }
+
+  // Static models' collisions are only in place once the world updates
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateBegin(
+      std::bind(&TrajectoryLibraryPlugin::BuildGraph, this));
+}
+
+/////////////////////////////////////////////////
+void TrajectoryLibraryPlugin::BuildGraph()
+{
+  this->dataPtr->updateConnection.reset();
+
+  LoadTimer timer("TrajectoryLibraryPlugin::BuildGraph", "plugin");
+  auto start = std::chrono::steady_clock::now();
+
+  auto graph = std::make_shared<NavGraph>();
+
+  // Trajectories are walkable as they are
+  for (const auto &trajectory : this->dataPtr->trajectories)
+  {
+    auto first = graph->NodeCount();
+    for (const auto &waypoint : trajectory)
+      graph->AddNode(waypoint.Pos());
+
+    for (size_t i = 0; i < trajectory.size(); ++i)
+      graph->AddEdge(first + i, first + (i + 1) % trajectory.size());
+  }
+
+  for (const auto &waypoint : this->dataPtr->waypoints)
+    graph->AddNode(waypoint);
+
+  for (const auto &place : this->dataPtr->places)
+    graph->AddNode(place.second, place.first);
+
+  // Connect nearby nodes when a body fits straight between them
+  LidarRaycaster raycaster;
+  flattenStaticModels(this->dataPtr->world, nullptr, raycaster);
+
+  graph->ConnectNearby(this->dataPtr->linkDistance,
+      [&](const ignition::math::Vector3d &_a,
+      const ignition::math::Vector3d &_b)
+      {
+        return raycaster.WayClear(_a.X(), _a.Y(), _b.X(), _b.Y(),
+            this->dataPtr->height, this->dataPtr->clearance);
+      });
+
+  auto nodeCount = graph->NodeCount();
+  if (!graph->Build())
+  {
+    gzerr << "Navigation graph has too many nodes [" << nodeCount << "]"
+          << std::endl;
+    return;
+  }
+
+  // Report destinations which can't be reached from the first node, which
+  // usually means a closed door or a place too far from everything else
+  unsigned int reachable{0};
+  for (auto destination : graph->Destinations())
+  {
+    if (!std::isinf(graph->Distance(0, destination)))
+      reachable++;
+  }
+
+  TrajectoryLibrary::Instance().SetGraph(graph);
+
+  auto elapsed = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+  gzmsg << "[ServiceSim] Navigation graph built with " << nodeCount
+        << " nodes and " << graph->EdgeCount() << " edges, "
+        << reachable << " of " << graph->Destinations().size()
+        << " places reachable, in " << elapsed << " ms" << std::endl;
+}
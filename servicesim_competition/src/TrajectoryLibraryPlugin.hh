@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_TRAJECTORYLIBRARYPLUGIN_HH_
+#define SERVICESIM_TRAJECTORYLIBRARYPLUGIN_HH_
+
+#include <memory>
+
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  // forward declarations
+  class TrajectoryLibraryPluginPrivate;
+
+  /// \brief A world plugin which defines trajectories once for the whole
+  /// world. Actors refer to them by name from the TrajectoryActorPlugin,
+  /// and all actors on the same trajectory share it in memory.
+  ///
+  /// World plugins are loaded before model plugins, so trajectories are
+  /// available to all actors in the world file.
+  ///
+  /// Optionally, it also builds a navigation graph which actors can use to
+  /// walk between random places. Its nodes are all trajectory waypoints,
+  /// connected along their trajectories, plus extra waypoints and places.
+  /// Nodes closer than <link_distance> are also connected if a body as wide
+  /// as twice the <clearance> can walk straight between them without
+  /// hitting static collisions. The graph is built on the first world
+  /// update, once static models are in place, and routes between all pairs
+  /// of nodes are computed then.
+  ///
+  /// The plugin has the following SDF description:
+  /// <trajectory>        SDF element with a unique name attribute. More
+  ///                     than one <trajectory> can be defined.
+  ///   <waypoint>        Pose of a waypoint. The last waypoint leads back
+  ///                     to the first.
+  /// <nav_graph>         Optional, builds the navigation graph.
+  ///   <link_distance>   Distance in meters within which nodes are
+  ///                     connected if the way is clear. Defaults to 3.
+  ///   <clearance>       Half the width in meters of the way which must be
+  ///                     clear. Defaults to 0.25.
+  ///   <height>          Height in meters at which the way is checked.
+  ///                     Defaults to 0.5.
+  ///   <waypoint>        Position of an extra node, such as either side of
+  ///                     a door. More than one can be defined.
+  ///   <place>           Position of a destination, with a name attribute.
+  ///                     More than one can be defined.
+  class TrajectoryLibraryPlugin : public gazebo::WorldPlugin
+  {
+    /// \brief Constructor
+    public: TrajectoryLibraryPlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::WorldPtr _world, sdf::ElementPtr _sdf)
+        override;
+
+    /// \brief Build the navigation graph.
+    private: void BuildGraph();
+
+    /// \brief Pointer to private data
+    private: std::unique_ptr<TrajectoryLibraryPluginPrivate> dataPtr;
+  };
+}
+#endif
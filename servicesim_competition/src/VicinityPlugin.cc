@@ -15,6 +15,7 @@
  *
 */
 
+#include "LoadProfiler.hh"
 #include "VicinityPlugin.hh"
 
 using namespace servicesim;
@@ -35,6 +36,8 @@ VicinityPlugin::~VicinityPlugin()
 //////////////////////////////////////////////////
 void VicinityPlugin::Load(gazebo::physics::ModelPtr _parent, sdf::ElementPtr _sdf)
 {
+  LoadTimer timer("VicinityPlugin::Load", "plugin", _parent->GetName());
+
   this->rosnode_ = new ros::NodeHandle("/" + _parent->GetName());
 
   this->model_ = _parent;
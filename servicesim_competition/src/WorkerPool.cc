@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "WorkerPool.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+WorkerPool::WorkerPool(const unsigned int _threads)
+{
+  for (unsigned int i = 0; i < _threads; ++i)
+    this->threads.emplace_back(&WorkerPool::Work, this);
+}
+
+/////////////////////////////////////////////////
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stop = true;
+  }
+  this->wake.notify_all();
+
+  for (auto &thread : this->threads)
+    thread.join();
+}
+
+/////////////////////////////////////////////////
+unsigned int WorkerPool::ThreadCount() const
+{
+  return this->threads.size();
+}
+
+/////////////////////////////////////////////////
+void WorkerPool::Run(const unsigned int _chunks,
+    const std::function<void(const unsigned int)> &_task)
+{
+  std::lock_guard<std::mutex> runLock(this->runMutex);
+
+  // Nothing to share
+  if (this->threads.empty() || _chunks <= 1)
+  {
+    for (unsigned int i = 0; i < _chunks; ++i)
+      _task(i);
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(this->mutex);
+  this->task = &_task;
+  this->chunks = _chunks;
+  this->next = 0;
+  this->remaining = _chunks;
+  this->generation++;
+  this->wake.notify_all();
+
+  // The calling thread takes chunks too, then waits for the others
+  this->RunChunks(lock);
+  this->done.wait(lock, [this] { return this->remaining == 0; });
+  this->task = nullptr;
+}
+
+/////////////////////////////////////////////////
+void WorkerPool::Work()
+{
+  uint64_t seen{0};
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true)
+  {
+    this->wake.wait(lock, [this, &seen]
+        { return this->stop || this->generation != seen; });
+    if (this->stop)
+      return;
+
+    seen = this->generation;
+    this->RunChunks(lock);
+  }
+}
+
+/////////////////////////////////////////////////
+void WorkerPool::RunChunks(std::unique_lock<std::mutex> &_lock)
+{
+  while (this->next < this->chunks)
+  {
+    auto chunk = this->next++;
+    auto task = this->task;
+
+    _lock.unlock();
+    (*task)(chunk);
+    _lock.lock();
+
+    if (--this->remaining == 0)
+      this->done.notify_all();
+  }
+}
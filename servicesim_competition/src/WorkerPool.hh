@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_WORKERPOOL_HH_
+#define SERVICESIM_WORKERPOOL_HH_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace servicesim
+{
+  /// \brief A fixed set of threads which is kept around between jobs, so
+  /// work which is split every update, such as a lidar scan, doesn't pay
+  /// for creating and joining threads each time.
+  ///
+  /// A job is a number of chunks, which are handed out one at a time to the
+  /// pool's threads and to the thread calling Run.
+  class WorkerPool
+  {
+    /// \brief Constructor
+    /// \param[in] _threads Number of threads to keep, besides the one
+    /// calling Run. With 0, jobs run entirely on the calling thread.
+    public: explicit WorkerPool(const unsigned int _threads);
+
+    /// \brief Destructor, stops and joins all threads.
+    public: ~WorkerPool();
+
+    /// \brief Number of threads kept, besides the calling one.
+    /// \return Thread count.
+    public: unsigned int ThreadCount() const;
+
+    /// \brief Run a job and wait for it to finish. Concurrent calls are
+    /// run one after the other.
+    /// \param[in] _chunks Number of chunks.
+    /// \param[in] _task Function called once per chunk, with the chunk's
+    /// index. It may be called from any thread, including the caller's.
+    public: void Run(const unsigned int _chunks,
+        const std::function<void(const unsigned int)> &_task);
+
+    /// \brief Main loop of the pool's threads.
+    private: void Work();
+
+    /// \brief Run chunks of the current job until none are left.
+    /// \param[in] _lock Lock on mutex, held on entry and exit.
+    private: void RunChunks(std::unique_lock<std::mutex> &_lock);
+
+    /// \brief Pool threads
+    private: std::vector<std::thread> threads;
+
+    /// \brief Protects the job state below
+    private: std::mutex mutex;
+
+    /// \brief Serializes calls to Run
+    private: std::mutex runMutex;
+
+    /// \brief Notifies pool threads of a new job or of stopping
+    private: std::condition_variable wake;
+
+    /// \brief Notifies the caller of Run that all chunks are done
+    private: std::condition_variable done;
+
+    /// \brief Task of the current job
+    private: const std::function<void(const unsigned int)> *task{nullptr};
+
+    /// \brief Number of chunks in the current job
+    private: unsigned int chunks{0};
+
+    /// \brief Next chunk to hand out
+    private: unsigned int next{0};
+
+    /// \brief Chunks not finished yet
+    private: unsigned int remaining{0};
+
+    /// \brief Incremented for each job, so threads can tell a new one apart
+    private: uint64_t generation{0};
+
+    /// \brief True when threads should exit
+    private: bool stop{false};
+  };
+}
+#endif
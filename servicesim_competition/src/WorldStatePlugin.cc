@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include <ignition/transport/Node.hh>
+
+#include <gazebo/common/Console.hh>
+#include <gazebo/common/Events.hh>
+#include <gazebo/physics/Actor.hh>
+#include <gazebo/physics/Model.hh>
+#include <gazebo/physics/World.hh>
+
+#include <ros/ros.h>
+#include <servicesim_competition/WorldState.h>
+
+#include "Conversions.hh"
+#include "LoadProfiler.hh"
+#include "ModelTracker.hh"
+#include "WorldStatePlugin.hh"
+
+/////////////////////////////////////////////////
+class servicesim::WorldStatePluginPrivate
+{
+  /// \brief Pointer to the world
+  public: gazebo::physics::WorldPtr world;
+
+  /// \brief Connection to world update
+  public: gazebo::event::ConnectionPtr updateConnection{nullptr};
+
+  /// \brief ROS node handle
+  public: std::unique_ptr<ros::NodeHandle> rosNode{nullptr};
+
+  /// \brief Publishes world state messages
+  public: ros::Publisher rosPub;
+
+  /// \brief Ignition transport node
+  public: ignition::transport::Node ignNode;
+
+  /// \brief Message reused across publications
+  public: servicesim_competition::WorldState msg;
+
+  /// \brief Robot name
+  public: std::string robotName;
+
+  /// \brief Guest name
+  public: std::string guestName;
+
+  /// \brief Name of the model the guest is following, empty if none
+  public: std::string guestTarget;
+
+  /// \brief Protects guestTarget
+  public: std::mutex mutex;
+
+  /// \brief Entities being published, in message order
+  public: std::vector<gazebo::physics::ModelPtr> entities;
+
+  /// \brief Whether each entity is an actor
+  public: std::vector<bool> isActor;
+
+  /// \brief Entity names, in message order
+  public: std::vector<std::string> names;
+
+  /// \brief Current entity poses
+  public: std::vector<ignition::math::Pose3d> poses;
+
+  /// \brief Entity poses on the previous publication
+  public: std::vector<ignition::math::Pose3d> lastPoses;
+
+  /// \brief Entity linear velocities
+  public: std::vector<ignition::math::Vector3d> linear;
+
+  /// \brief Entity angular velocities
+  public: std::vector<ignition::math::Vector3d> angular;
+
+  /// \brief Tells when models were inserted or removed
+  public: ModelTracker models;
+
+  /// \brief Incremented every time the list of entities changes
+  public: uint32_t namesVersion{0};
+
+  /// \brief True if names should be sent on the next publication
+  public: std::atomic<bool> sendNames{true};
+
+  /// \brief Time between publications
+  public: double updatePeriod{0.1};
+
+  /// \brief Time of the last publication
+  public: gazebo::common::Time lastUpdate;
+};
+
+using namespace servicesim;
+GZ_REGISTER_WORLD_PLUGIN(servicesim::WorldStatePlugin)
+
+/////////////////////////////////////////////////
+WorldStatePlugin::WorldStatePlugin()
+    : dataPtr(new WorldStatePluginPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+void WorldStatePlugin::Load(gazebo::physics::WorldPtr _world,
+    sdf::ElementPtr _sdf)
+{
+  LoadTimer timer("WorldStatePlugin::Load", "plugin");
+
+  this->dataPtr->world = _world;
+
+  std::string topic{"/servicesim/world_state"};
+  if (_sdf->HasElement("topic"))
+    topic = _sdf->Get<std::string>("topic");
+
+  if (_sdf->HasElement("update_rate"))
+  {
+    auto rate = _sdf->Get<double>("update_rate");
+    if (rate > 0)
+      this->dataPtr->updatePeriod = 1.0 / rate;
+  }
+
+  if (_sdf->HasElement("robot_name"))
+    this->dataPtr->robotName = _sdf->Get<std::string>("robot_name");
+
+  std::string ns{"servicesim"};
+  if (_sdf->HasElement("namespace"))
+    ns = _sdf->Get<std::string>("namespace");
+
+  // Follow state of the guest
+  if (_sdf->HasElement("guest_name"))
+  {
+    this->dataPtr->guestName = _sdf->Get<std::string>("guest_name");
+    this->dataPtr->ignNode.Subscribe(
+        "/" + ns + "/" + this->dataPtr->guestName + "/following",
+        &WorldStatePlugin::OnFollowing, this);
+  }
+
+  // ROS transport
+  if (!ros::isInitialized())
+  {
+    ROS_FATAL_STREAM("A ROS node for Gazebo has not been initialized,"
+        << "unable to load plugin. Load the Gazebo system plugin "
+        << "'libgazebo_ros_api_plugin.so' in the gazebo_ros package)");
+    return;
+  }
+
+  this->dataPtr->rosNode.reset(new ros::NodeHandle());
+
+  // Names are only sent when they change, so make sure new subscribers get
+  // them on their first message
+  ros::SubscriberStatusCallback onConnect =
+      [this](const ros::SingleSubscriberPublisher &)
+      {
+        this->dataPtr->sendNames = true;
+      };
+
+  this->dataPtr->rosPub =
+      this->dataPtr->rosNode->advertise<servicesim_competition::WorldState>(
+      topic, 1, onConnect);
+
+  // Publish after physics has been updated
+  this->dataPtr->updateConnection =
+      gazebo::event::Events::ConnectWorldUpdateEnd(
+      std::bind(&WorldStatePlugin::OnUpdate, this));
+
+  gzmsg << "[ServiceSim] World state plugin loaded, publishing on ["
+        << topic << "]" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void WorldStatePlugin::UpdateEntities()
+{
+  auto world = this->dataPtr->world;
+
+  // Only go through models when some have been inserted or removed
+  if (!this->dataPtr->models.Changed(world))
+    return;
+
+  this->dataPtr->entities.clear();
+  this->dataPtr->isActor.clear();
+  this->dataPtr->names.clear();
+  this->dataPtr->lastPoses.clear();
+
+  for (unsigned int i = 0; i < world->ModelCount(); ++i)
+  {
+    auto model = world->ModelByIndex(i);
+    auto actor = boost::dynamic_pointer_cast<gazebo::physics::Actor>(model);
+
+    if (!actor && model->GetName() != this->dataPtr->robotName)
+      continue;
+
+    this->dataPtr->entities.push_back(model);
+    this->dataPtr->isActor.push_back(actor != nullptr);
+    this->dataPtr->names.push_back(model->GetName());
+    this->dataPtr->lastPoses.push_back(model->WorldPose());
+  }
+
+  auto count = this->dataPtr->entities.size();
+  this->dataPtr->poses.resize(count);
+  this->dataPtr->linear.resize(count);
+  this->dataPtr->angular.resize(count);
+
+  this->dataPtr->namesVersion++;
+  this->dataPtr->sendNames = true;
+}
+
+/////////////////////////////////////////////////
+void WorldStatePlugin::OnFollowing(const ignition::msgs::StringMsg &_msg)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->guestTarget = _msg.data();
+}
+
+/////////////////////////////////////////////////
+void WorldStatePlugin::OnUpdate()
+{
+  if (!this->dataPtr->rosNode)
+    return;
+
+  auto simTime = this->dataPtr->world->SimTime();
+  auto dt = (simTime - this->dataPtr->lastUpdate).Double();
+
+  // Time went backwards, e.g. after a reset
+  if (dt < 0)
+  {
+    this->dataPtr->lastUpdate = simTime;
+    return;
+  }
+
+  if (dt < this->dataPtr->updatePeriod)
+    return;
+
+  this->dataPtr->lastUpdate = simTime;
+
+  this->UpdateEntities();
+
+  // Fill state in a single pass
+  for (size_t i = 0; i < this->dataPtr->entities.size(); ++i)
+  {
+    auto model = this->dataPtr->entities[i];
+    auto pose = model->WorldPose();
+    this->dataPtr->poses[i] = pose;
+
+    // Actors are moved kinematically and don't report velocities, so
+    // estimate them from the previous pose
+    if (this->dataPtr->isActor[i])
+    {
+      auto &last = this->dataPtr->lastPoses[i];
+      this->dataPtr->linear[i] = (pose.Pos() - last.Pos()) / dt;
+
+      ignition::math::Angle yaw(pose.Rot().Yaw() - last.Rot().Yaw());
+      yaw.Normalize();
+      this->dataPtr->angular[i].Set(0, 0, yaw.Radian() / dt);
+    }
+    else
+    {
+      this->dataPtr->linear[i] = model->WorldLinearVel();
+      this->dataPtr->angular[i] = model->WorldAngularVel();
+    }
+
+    this->dataPtr->lastPoses[i] = pose;
+  }
+
+  // Poses are still tracked above so velocities are valid once someone
+  // subscribes
+  if (this->dataPtr->rosPub.getNumSubscribers() == 0)
+    return;
+
+  auto &msg = this->dataPtr->msg;
+  msg.stamp.sec = simTime.sec;
+  msg.stamp.nsec = simTime.nsec;
+  msg.names_version = this->dataPtr->namesVersion;
+
+  convert(this->dataPtr->poses, msg.poses);
+  convert(this->dataPtr->linear, this->dataPtr->angular, msg.velocities);
+
+  // Guest
+  msg.guest_index = -1;
+  msg.guest_following = false;
+  msg.guest_target_index = -1;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    for (size_t i = 0; i < this->dataPtr->names.size(); ++i)
+    {
+      const auto &name = this->dataPtr->names[i];
+      if (name == this->dataPtr->guestName)
+        msg.guest_index = i;
+      else if (!this->dataPtr->guestTarget.empty() &&
+          name == this->dataPtr->guestTarget)
+      {
+        msg.guest_target_index = i;
+      }
+    }
+    msg.guest_following = !this->dataPtr->guestTarget.empty();
+  }
+
+  // Names are only sent when they change or a new subscriber connects
+  if (this->dataPtr->sendNames.exchange(false))
+    msg.names = this->dataPtr->names;
+
+  this->dataPtr->rosPub.publish(msg);
+
+  // Keep the capacity for the next time names are sent
+  msg.names.clear();
+}
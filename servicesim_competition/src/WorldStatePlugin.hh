@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SERVICESIM_WORLDSTATEPLUGIN_HH_
+#define SERVICESIM_WORLDSTATEPLUGIN_HH_
+
+#include <memory>
+
+#include <ignition/msgs/stringmsg.pb.h>
+#include <gazebo/common/Plugin.hh>
+
+namespace servicesim
+{
+  class WorldStatePluginPrivate;
+
+  /// \brief Publishes the ground-truth state of all actors and the robot in
+  /// a single servicesim_competition/WorldState ROS message, so tools don't
+  /// need to query each model separately.
+  ///
+  /// SDF params:
+  ///   * <topic> ROS topic, defaults to /servicesim/world_state
+  ///   * <update_rate> Publish frequency in Hz, defaults to 10
+  ///   * <robot_name> Name of the robot model
+  ///   * <guest_name> Name of the guest actor
+  ///   * <namespace> Namespace used by the guest's FollowActorPlugin,
+  ///                 defaults to servicesim
+  class WorldStatePlugin : public gazebo::WorldPlugin
+  {
+    /// \brief Constructor
+    public: WorldStatePlugin();
+
+    // Documentation inherited
+    public: void Load(gazebo::physics::WorldPtr _world, sdf::ElementPtr _sdf)
+        override;
+
+    /// \brief Update the list of entities if models were inserted or
+    /// removed.
+    private: void UpdateEntities();
+
+    /// \brief Callback when the guest's follow target changes.
+    /// \param[in] _msg Target name, empty if not following.
+    private: void OnFollowing(const ignition::msgs::StringMsg &_msg);
+
+    /// \brief Called at the end of every world iteration
+    private: void OnUpdate();
+
+    /// \internal
+    private: std::unique_ptr<WorldStatePluginPrivate> dataPtr;
+  };
+}
+#endif
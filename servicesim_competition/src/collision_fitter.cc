@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Fits simple collision shapes to the visual meshes of servicesim models and
+// reports how much cheaper their collisions would be.
+//
+// Usage: collision_fitter [options] <model.sdf>...
+//   --tolerance <fraction>  Volume allowed in excess of each link's convex
+//                           hull, defaults to 0.25
+//   --max-boxes <count>     Largest number of boxes a link is split into,
+//                           defaults to 4
+//   --overlay               Write a collision-only model.collision.sdf, and
+//                           any hull meshes, next to each model.sdf
+//
+// The fitted <collision> blocks are printed to stdout and the report to
+// stderr. Pair costs count one per primitive and one per mesh triangle, a
+// rough measure of what ODE does when colliding a shape against a
+// primitive.
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include <sdf/sdf.hh>
+
+#include <gazebo/common/Mesh.hh>
+#include <gazebo/common/MeshManager.hh>
+#include <gazebo/common/SystemPaths.hh>
+
+#include "CollisionFitter.hh"
+
+using namespace servicesim;
+
+/// \brief Add the triangles of a mesh, transformed into the link frame.
+/// \param[in] _uri Mesh URI.
+/// \param[in] _scale Mesh scale.
+/// \param[in] _pose Pose of the geometry in the link frame.
+/// \param[in] _fitter Fitter to add triangles to, null to only count them.
+/// \param[out] _triangles Incremented by the number of triangles.
+/// \return False if the mesh couldn't be loaded.
+static bool AddMesh(const std::string &_uri,
+    const ignition::math::Vector3d &_scale,
+    const ignition::math::Pose3d &_pose, CollisionFitter *_fitter,
+    size_t &_triangles)
+{
+  auto path = gazebo::common::SystemPaths::Instance()->FindFileURI(_uri);
+  auto mesh = path.empty() ? nullptr :
+      gazebo::common::MeshManager::Instance()->Load(path);
+  if (!mesh)
+  {
+    std::cerr << "Failed to load mesh [" << _uri << "]" << std::endl;
+    return false;
+  }
+
+  for (unsigned int s = 0; s < mesh->GetSubMeshCount(); ++s)
+  {
+    auto subMesh = mesh->GetSubMesh(s);
+    if (subMesh->GetPrimitiveType() != gazebo::common::SubMesh::TRIANGLES)
+      continue;
+
+    for (unsigned int i = 0; i + 2 < subMesh->GetIndexCount(); i += 3)
+    {
+      ignition::math::Vector3d v[3];
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        v[k] = _pose.CoordPositionAdd(
+            subMesh->Vertex(subMesh->GetIndex(i + k)) * _scale);
+      }
+
+      if (_fitter)
+        _fitter->AddTriangle(v[0], v[1], v[2]);
+      _triangles++;
+    }
+  }
+  return true;
+}
+
+/// \brief Write a hull as an OBJ file.
+/// \param[in] _shape Hull shape.
+/// \param[in] _path File path.
+/// \return True if written.
+static bool WriteHull(const FittedShape &_shape, const std::string &_path)
+{
+  std::ofstream file(_path);
+  if (!file.is_open())
+    return false;
+
+  file << std::setprecision(6);
+  for (const auto &v : _shape.vertices)
+    file << "v " << v.X() << " " << v.Y() << " " << v.Z() << std::endl;
+  for (const auto &t : _shape.triangles)
+  {
+    file << "f " << t[0] + 1 << " " << t[1] + 1 << " " << t[2] + 1
+         << std::endl;
+  }
+  return true;
+}
+
+/// \brief SDF for a fitted shape.
+/// \param[in] _shape Shape.
+/// \param[in] _name Collision name.
+/// \param[in] _hullUri URI of the hull mesh, used if the shape is a hull.
+/// \param[in] _indent Indentation.
+/// \return <collision> block.
+static std::string CollisionSdf(const FittedShape &_shape,
+    const std::string &_name, const std::string &_hullUri,
+    const std::string &_indent)
+{
+  std::ostringstream out;
+  out << std::setprecision(6);
+  out << _indent << "<collision name=\"" << _name << "\">" << std::endl;
+
+  if (_shape.type != FittedShape::HULL)
+  {
+    out << _indent << "  <pose>" << _shape.center.X() << " "
+        << _shape.center.Y() << " " << _shape.center.Z() << " 0 0 "
+        << _shape.yaw << "</pose>" << std::endl;
+  }
+
+  out << _indent << "  <geometry>" << std::endl;
+  switch (_shape.type)
+  {
+    case FittedShape::BOX:
+      out << _indent << "    <box>" << std::endl
+          << _indent << "      <size>" << _shape.size.X() << " "
+          << _shape.size.Y() << " " << _shape.size.Z() << "</size>"
+          << std::endl
+          << _indent << "    </box>" << std::endl;
+      break;
+    case FittedShape::CYLINDER:
+      out << _indent << "    <cylinder>" << std::endl
+          << _indent << "      <radius>" << _shape.size.X() << "</radius>"
+          << std::endl
+          << _indent << "      <length>" << _shape.size.Z() << "</length>"
+          << std::endl
+          << _indent << "    </cylinder>" << std::endl;
+      break;
+    case FittedShape::HULL:
+      out << _indent << "    <mesh>" << std::endl
+          << _indent << "      <uri>" << _hullUri << "</uri>" << std::endl
+          << _indent << "    </mesh>" << std::endl;
+      break;
+  }
+  out << _indent << "  </geometry>" << std::endl;
+  out << _indent << "</collision>" << std::endl;
+  return out.str();
+}
+
+/// \brief Per-model results.
+struct ModelReport
+{
+  /// \brief Model name
+  std::string name;
+
+  /// \brief Pair cost of the current collisions
+  size_t costBefore{0};
+
+  /// \brief Pair cost of the fitted collisions
+  size_t costAfter{0};
+
+  /// \brief Number of fitted shapes
+  size_t shapes{0};
+
+  /// \brief Largest excess volume over a link's hull, as a fraction
+  double maxExcess{0.0};
+
+  /// \brief True if all links were fitted within tolerance
+  bool withinTolerance{true};
+};
+
+/// \brief Fit a model.
+/// \param[in] _path Path to model.sdf.
+/// \param[in] _tolerance Excess volume tolerance.
+/// \param[in] _maxBoxes Largest number of boxes per link.
+/// \param[in] _overlay True to write the overlay and hull meshes.
+/// \param[out] _report Results.
+/// \return False if the model couldn't be read.
+static bool FitModel(const std::string &_path, const double _tolerance,
+    const unsigned int _maxBoxes, const bool _overlay, ModelReport &_report)
+{
+  sdf::SDFPtr sdfFile(new sdf::SDF());
+  sdf::init(sdfFile);
+  if (!sdf::readFile(_path, sdfFile) ||
+      !sdfFile->Root()->HasElement("model"))
+  {
+    std::cerr << "Failed to read model from [" << _path << "]" << std::endl;
+    return false;
+  }
+
+  // Resolve model:// URIs next to this model
+  auto modelDir = _path.substr(0, _path.find_last_of('/') + 1);
+  if (modelDir.empty())
+    modelDir = "./";
+  gazebo::common::SystemPaths::Instance()->AddModelPaths(modelDir + "..");
+
+  auto model = sdfFile->Root()->GetElement("model");
+  _report.name = model->Get<std::string>("name");
+
+  std::ostringstream overlay;
+  overlay << "<?xml version=\"1.0\" ?>" << std::endl
+          << "<sdf version=\"1.6\">" << std::endl
+          << "  <model name=\"" << _report.name << "\">" << std::endl;
+
+  auto link = model->HasElement("link") ? model->GetElement("link") :
+      nullptr;
+  while (link)
+  {
+    auto linkName = link->Get<std::string>("name");
+
+    // Current cost
+    size_t linkCostBefore{0};
+    if (link->HasElement("collision"))
+    {
+      auto collision = link->GetElement("collision");
+      while (collision)
+      {
+        auto geometry = collision->GetElement("geometry");
+        if (geometry->HasElement("mesh"))
+        {
+          auto mesh = geometry->GetElement("mesh");
+          AddMesh(mesh->Get<std::string>("uri"),
+              mesh->Get<ignition::math::Vector3d>("scale"),
+              collision->Get<ignition::math::Pose3d>("pose"), nullptr,
+              linkCostBefore);
+        }
+        else
+        {
+          linkCostBefore++;
+        }
+        collision = collision->GetNextElement("collision");
+      }
+    }
+    _report.costBefore += linkCostBefore;
+
+    // Fit to the visual meshes, which have the true shape
+    CollisionFitter fitter;
+    size_t triangles{0};
+    if (link->HasElement("visual"))
+    {
+      auto visual = link->GetElement("visual");
+      while (visual)
+      {
+        auto geometry = visual->GetElement("geometry");
+        if (geometry->HasElement("mesh"))
+        {
+          auto mesh = geometry->GetElement("mesh");
+          AddMesh(mesh->Get<std::string>("uri"),
+              mesh->Get<ignition::math::Vector3d>("scale"),
+              visual->Get<ignition::math::Pose3d>("pose"), &fitter,
+              triangles);
+        }
+        visual = visual->GetNextElement("visual");
+      }
+    }
+
+    // Links without visual meshes keep their collisions
+    if (triangles == 0)
+    {
+      _report.costAfter += linkCostBefore;
+      link = link->GetNextElement("link");
+      continue;
+    }
+
+    auto fit = fitter.Compute(_tolerance, _maxBoxes);
+    _report.costAfter += fit.pairCost;
+    _report.shapes += fit.shapes.size();
+    _report.withinTolerance = _report.withinTolerance && fit.withinTolerance;
+    if (fit.hullVolume > 0)
+    {
+      _report.maxExcess = std::max(_report.maxExcess,
+          fit.volume / fit.hullVolume - 1.0);
+    }
+
+    std::cout << "<!-- " << _report.name << "::" << linkName << " -->"
+              << std::endl;
+    overlay << "    <link name=\"" << linkName << "\">" << std::endl;
+    for (size_t i = 0; i < fit.shapes.size(); ++i)
+    {
+      const auto &shape = fit.shapes[i];
+      auto name = "collision_" + std::to_string(i);
+
+      std::string hullUri;
+      if (shape.type == FittedShape::HULL)
+      {
+        auto hullFile = linkName + "_" + name + "_hull.obj";
+        hullUri = "model://" + _report.name + "/meshes/" + hullFile;
+        if (_overlay && !WriteHull(shape, modelDir + "meshes/" + hullFile))
+        {
+          std::cerr << "Failed to write [" << modelDir << "meshes/"
+                    << hullFile << "]" << std::endl;
+        }
+      }
+
+      auto block = CollisionSdf(shape, name, hullUri, "      ");
+      std::cout << block;
+      overlay << block;
+    }
+    overlay << "    </link>" << std::endl;
+
+    link = link->GetNextElement("link");
+  }
+
+  overlay << "  </model>" << std::endl << "</sdf>" << std::endl;
+
+  if (_overlay)
+  {
+    std::ofstream file(modelDir + "model.collision.sdf");
+    file << overlay.str();
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+int main(int _argc, char **_argv)
+{
+  double tolerance{0.25};
+  unsigned int maxBoxes{4};
+  bool overlay{false};
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < _argc; ++i)
+  {
+    std::string arg(_argv[i]);
+    if (arg == "--tolerance" && i + 1 < _argc)
+      tolerance = std::atof(_argv[++i]);
+    else if (arg == "--max-boxes" && i + 1 < _argc)
+      maxBoxes = std::max(1, std::atoi(_argv[++i]));
+    else if (arg == "--overlay")
+      overlay = true;
+    else
+      paths.push_back(arg);
+  }
+
+  if (paths.empty())
+  {
+    std::cerr << "Usage: " << _argv[0] << " [--tolerance <fraction>] "
+              << "[--max-boxes <count>] [--overlay] <model.sdf>..."
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<ModelReport> reports;
+  for (const auto &path : paths)
+  {
+    ModelReport report;
+    if (FitModel(path, tolerance, maxBoxes, overlay, report))
+      reports.push_back(report);
+  }
+
+  std::cerr << std::fixed << std::setprecision(1);
+  std::cerr << std::setw(24) << std::left << "model" << std::right
+            << std::setw(12) << "cost before" << std::setw(12)
+            << "cost after" << std::setw(11) << "reduction" << std::setw(8)
+            << "shapes" << std::setw(9) << "excess" << std::endl;
+  for (const auto &report : reports)
+  {
+    auto reduction = report.costBefore == 0 ? 0.0 :
+        100.0 * (1.0 - static_cast<double>(report.costAfter) /
+        report.costBefore);
+
+    std::cerr << std::setw(24) << std::left << report.name << std::right
+              << std::setw(12) << report.costBefore
+              << std::setw(12) << report.costAfter
+              << std::setw(10) << reduction << "%"
+              << std::setw(8) << report.shapes
+              << std::setw(8) << report.maxExcess * 100.0 << "%"
+              << (report.withinTolerance ? "" : "  over tolerance")
+              << std::endl;
+  }
+
+  return reports.size() == paths.size() ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Runs the competition of a servicesim world on a 2D map, without Gazebo,
+// so tasks can be run and scored many times faster than real time.
+//
+// Usage: servicesim_2d [options] <world file>
+//   --seed <seed>              Seed for random streams, defaults to the
+//                              world's
+//   --step <seconds>           Step size, defaults to 0.01
+//   --real-time-factor <rtf>   Target real time factor, 0 to run as fast
+//                              as possible, which is the default
+//   --max-time <seconds>       Sim time to stop at, 0 to only stop once
+//                              the task is complete, which is the default
+//   --verbose                  Print checkpoint progress and other messages
+//
+// The world's models and media are found through GAZEBO_MODEL_PATH and
+// GAZEBO_RESOURCE_PATH. Sim time is published on /clock, so ROS nodes
+// should run with use_sim_time. The final score is printed on exit, and the
+// exit code is 0 if the task was complete and 2 if time ran out first.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <gazebo/common/Console.hh>
+#include <ros/ros.h>
+
+#include "Simulator2d.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+int main(int _argc, char **_argv)
+{
+  ros::init(_argc, _argv, "servicesim_2d");
+
+  uint32_t seed{0};
+  double step{0.01};
+  double realTimeFactor{0.0};
+  double maxTime{0.0};
+  bool verbose{false};
+  std::string path;
+
+  for (int i = 1; i < _argc; ++i)
+  {
+    std::string arg(_argv[i]);
+    if (arg == "--seed" && i + 1 < _argc)
+      seed = static_cast<uint32_t>(std::strtoul(_argv[++i], nullptr, 10));
+    else if (arg == "--step" && i + 1 < _argc)
+      step = std::atof(_argv[++i]);
+    else if (arg == "--real-time-factor" && i + 1 < _argc)
+      realTimeFactor = std::max(0.0, std::atof(_argv[++i]));
+    else if (arg == "--max-time" && i + 1 < _argc)
+      maxTime = std::atof(_argv[++i]);
+    else if (arg == "--verbose")
+      verbose = true;
+    else
+      path = arg;
+  }
+
+  if (path.empty() || step <= 0)
+  {
+    std::cerr << "Usage: " << _argv[0] << " [--seed <seed>] "
+              << "[--step <seconds>] [--real-time-factor <rtf>] "
+              << "[--max-time <seconds>] [--verbose] <world file>"
+              << std::endl;
+    return 1;
+  }
+
+  gazebo::common::Console::SetQuiet(!verbose);
+
+  Simulator2d sim;
+  if (!sim.Load(path, seed))
+    return 1;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  while (ros::ok() && !sim.Complete() &&
+      (maxTime <= 0 || sim.SimTime() < maxTime))
+  {
+    sim.Step(step);
+    ros::spinOnce();
+
+    if (realTimeFactor > 0)
+    {
+      std::this_thread::sleep_until(wallStart +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(sim.SimTime() / realTimeFactor)));
+    }
+  }
+
+  auto wall = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - wallStart).count();
+
+  std::cout << std::fixed << std::setprecision(3)
+            << "Sim time: " << sim.SimTime() << " s" << std::endl
+            << "Wall time: " << wall << " s" << std::endl
+            << "Real time factor: "
+            << (wall > 0 ? sim.SimTime() / wall : 0.0) << std::endl
+            << "Complete: " << (sim.Complete() ? "yes" : "no") << std::endl
+            << "Score: " << sim.Score() << std::endl;
+
+  return sim.Complete() ? 0 : 2;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include "../src/CollisionFilter.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+/// \brief Whether the physics engine checks a pair of categories, which
+/// happens if either side's category is in the other's collide bits.
+bool Collide(const unsigned int _a, const unsigned int _b)
+{
+  auto a = CollisionFilter::Masks(_a);
+  auto b = CollisionFilter::Masks(_b);
+  return (a.first & b.second) || (b.first & a.second);
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionFilterTest, FixedPairsFiltered)
+{
+  for (auto a : {CollisionFilter::kStatic, CollisionFilter::kGround})
+  {
+    for (auto b : {CollisionFilter::kStatic, CollisionFilter::kGround})
+    {
+      EXPECT_EQ(0u, CollisionFilter::Masks(a).first &
+          CollisionFilter::Masks(b).second) << a << " " << b;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionFilterTest, HumansOnlyCollideWithRobot)
+{
+  EXPECT_TRUE(Collide(CollisionFilter::kHuman, CollisionFilter::kRobot));
+
+  for (auto other : {CollisionFilter::kHuman, CollisionFilter::kStatic,
+      CollisionFilter::kGround, CollisionFilter::kOther})
+  {
+    EXPECT_FALSE(Collide(CollisionFilter::kHuman, other)) << other;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(CollisionFilterTest, MovingModelsCollide)
+{
+  for (auto moving : {CollisionFilter::kRobot, CollisionFilter::kOther})
+  {
+    for (auto other : {CollisionFilter::kRobot, CollisionFilter::kStatic,
+        CollisionFilter::kGround, CollisionFilter::kOther})
+    {
+      EXPECT_TRUE(Collide(moving, other)) << moving << " " << other;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
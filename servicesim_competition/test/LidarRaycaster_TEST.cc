@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <ignition/math/Helpers.hh>
+
+#include "../src/LidarRaycaster.hh"
+#include "../src/WorkerPool.hh"
+
+using namespace servicesim;
+
+/////////////////////////////////////////////////
+/// \brief A square room 4 m wide centered on the origin, with a doorway
+/// on the +X wall.
+/// \param[out] _raycaster Raycaster to fill.
+void Room(LidarRaycaster &_raycaster)
+{
+  _raycaster.AddStaticSegment(-2, -2, 2, -2, 0, 2);
+  _raycaster.AddStaticSegment(2, -2, 2, -0.5, 0, 2);
+  _raycaster.AddStaticSegment(2, 0.5, 2, 2, 0, 2);
+  _raycaster.AddStaticSegment(2, 2, -2, 2, 0, 2);
+  _raycaster.AddStaticSegment(-2, 2, -2, -2, 0, 2);
+
+  // Lintel above the doorway
+  _raycaster.AddStaticSegment(2, -0.5, 2, 0.5, 2, 2.2);
+  _raycaster.BuildStatic(0.5);
+}
+
+/////////////////////////////////////////////////
+TEST(LidarRaycasterTest, Cast)
+{
+  LidarRaycaster raycaster;
+  Room(raycaster);
+
+  EXPECT_NEAR(2.0, raycaster.Cast(0, 0, 1, IGN_PI_2, 0, 10), 1e-9);
+  EXPECT_NEAR(2.0, raycaster.Cast(0, 0, 1, -IGN_PI_2, 0, 10), 1e-9);
+  EXPECT_NEAR(3.0, raycaster.Cast(1, 0, 1, IGN_PI, 0, 10), 1e-9);
+
+  // Through the doorway, under the lintel
+  EXPECT_DOUBLE_EQ(10.0, raycaster.Cast(0, 0, 1, 0, 0, 10));
+  EXPECT_NEAR(2.0, raycaster.Cast(0, 0, 2.1, 0, 0, 10), 1e-9);
+
+  // Dynamic circle in the doorway
+  raycaster.AddDynamicCircle(3, 0, 0.5, 0, 2);
+  EXPECT_NEAR(2.5, raycaster.Cast(0, 0, 1, 0, 0, 10), 1e-9);
+  raycaster.ClearDynamic();
+  EXPECT_DOUBLE_EQ(10.0, raycaster.Cast(0, 0, 1, 0, 0, 10));
+}
+
+/////////////////////////////////////////////////
+TEST(LidarRaycasterTest, ScanThreads)
+{
+  LidarRaycaster raycaster;
+  Room(raycaster);
+
+  const unsigned int count{721};
+  std::vector<float> single(count);
+  raycaster.Scan(0.3, -0.2, 1, 0.1, -IGN_PI, 2 * IGN_PI / count, 0.05, 10,
+      1, single);
+
+  // The same threads are used for consecutive scans, and for different
+  // thread counts
+  for (unsigned int threads : {4u, 4u, 3u, 8u, 1u})
+  {
+    std::vector<float> ranges(count);
+    raycaster.Scan(0.3, -0.2, 1, 0.1, -IGN_PI, 2 * IGN_PI / count, 0.05,
+        10, threads, ranges);
+    for (unsigned int i = 0; i < count; ++i)
+      EXPECT_EQ(single[i], ranges[i]) << threads << " " << i;
+  }
+
+  // Some rays leave through the doorway
+  unsigned int misses{0};
+  for (auto range : single)
+    misses += std::isinf(range) ? 1 : 0;
+  EXPECT_GT(misses, 0u);
+  EXPECT_LT(misses, count);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkerPoolTest, Run)
+{
+  WorkerPool pool(3);
+  EXPECT_EQ(3u, pool.ThreadCount());
+
+  for (unsigned int job = 0; job < 100; ++job)
+  {
+    std::vector<unsigned int> done(job, 0);
+    pool.Run(job, [&](const unsigned int _chunk) { done[_chunk]++; });
+    for (auto d : done)
+      EXPECT_EQ(1u, d);
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
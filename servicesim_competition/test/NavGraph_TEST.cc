@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <gazebo/common/SystemPaths.hh>
+
+#include "../src/LidarRaycaster.hh"
+#include "../src/NavGraph.hh"
+#include "../src/StaticGeometry.hh"
+
+using namespace servicesim;
+
+/// \brief A wall along X with a door frame, as generated by room.erb, with
+/// the doorway centered on the origin.
+static const std::string kDoorWallWorld =
+    "<sdf version='1.6'>"
+    "  <world name='default'>"
+    "    <model name='room'>"
+    "      <static>true</static>"
+    "      <link name='door_frame'>"
+    "        <pose>0 0 0 0 0 3.14159265</pose>"
+    "        <collision name='collision'>"
+    "          <geometry>"
+    "            <mesh>"
+    "              <uri>model://door/meshes/door_frame.obj</uri>"
+    "              <scale>0.01 0.01 0.01</scale>"
+    "            </mesh>"
+    "          </geometry>"
+    "        </collision>"
+    "      </link>"
+    "      <link name='wall_left'>"
+    "        <pose>-2 -0.06 1 0 0 0</pose>"
+    "        <collision name='collision'>"
+    "          <geometry>"
+    "            <box><size>3 0.1 2</size></box>"
+    "          </geometry>"
+    "        </collision>"
+    "      </link>"
+    "      <link name='wall_right'>"
+    "        <pose>2 -0.06 1 0 0 0</pose>"
+    "        <collision name='collision'>"
+    "          <geometry>"
+    "            <box><size>3 0.1 2</size></box>"
+    "          </geometry>"
+    "        </collision>"
+    "      </link>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+/////////////////////////////////////////////////
+TEST(NavGraphTest, Build)
+{
+  NavGraph graph;
+  auto a = graph.AddNode(ignition::math::Vector3d(0, 0, 0), "a");
+  auto b = graph.AddNode(ignition::math::Vector3d(1, 0, 0));
+  auto c = graph.AddNode(ignition::math::Vector3d(1, 1, 0), "c");
+  EXPECT_TRUE(graph.AddEdge(a, b));
+  EXPECT_TRUE(graph.AddEdge(b, c));
+  EXPECT_FALSE(graph.AddEdge(b, a));
+  EXPECT_FALSE(graph.AddEdge(a, a));
+  EXPECT_FALSE(graph.HasEdge(a, c));
+
+  ASSERT_TRUE(graph.Build());
+  EXPECT_EQ(b, graph.NextHop(a, c));
+  EXPECT_EQ(c, graph.NextHop(b, c));
+  EXPECT_NEAR(2.0, graph.Distance(a, c), 1e-6);
+}
+
+/////////////////////////////////////////////////
+TEST(NavGraphTest, ConnectThroughDoorway)
+{
+  gazebo::common::SystemPaths::Instance()->AddModelPaths(
+      SERVICESIM_MODELS_PATH);
+
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  ASSERT_TRUE(sdf::readString(kDoorWallWorld, sdfParsed));
+  auto world = sdfParsed->Root()->GetElement("world");
+
+  LidarRaycaster raycaster;
+  flattenFootprints(staticFootprints(world, ""), raycaster);
+
+  // Same defaults as the TrajectoryLibraryPlugin
+  const double clearance{0.25};
+  const double height{0.5};
+  const double linkDistance{3.0};
+
+  // One node on each side of the doorway, one on each side of the wall
+  NavGraph graph;
+  auto doorNorth = graph.AddNode(ignition::math::Vector3d(0, 1, 0));
+  auto doorSouth = graph.AddNode(ignition::math::Vector3d(0, -1, 0));
+  auto wallNorth = graph.AddNode(ignition::math::Vector3d(2, 1, 0));
+  auto wallSouth = graph.AddNode(ignition::math::Vector3d(2, -1, 0));
+
+  auto added = graph.ConnectNearby(linkDistance,
+      [&](const ignition::math::Vector3d &_a,
+      const ignition::math::Vector3d &_b)
+      {
+        return raycaster.WayClear(_a.X(), _a.Y(), _b.X(), _b.Y(), height,
+            clearance);
+      });
+
+  // Through the doorway and along each side, but not through the wall
+  EXPECT_TRUE(graph.HasEdge(doorNorth, doorSouth));
+  EXPECT_TRUE(graph.HasEdge(doorNorth, wallNorth));
+  EXPECT_TRUE(graph.HasEdge(doorSouth, wallSouth));
+  EXPECT_FALSE(graph.HasEdge(wallNorth, wallSouth));
+  EXPECT_FALSE(graph.HasEdge(doorNorth, wallSouth));
+  EXPECT_FALSE(graph.HasEdge(doorSouth, wallNorth));
+  EXPECT_EQ(3u, added);
+
+  // Rooms are routed through the doorway
+  ASSERT_TRUE(graph.Build());
+  EXPECT_EQ(doorNorth, graph.NextHop(wallNorth, wallSouth));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gazebo/common/SystemPaths.hh>
+
+#include "../src/OccupancyRasterizer.hh"
+#include "../src/StaticGeometry.hh"
+
+using namespace servicesim;
+
+/// \brief A world with a door frame, as generated by room.erb, with the
+/// doorway centered on the origin along X.
+static const std::string kDoorWorld =
+    "<sdf version='1.6'>"
+    "  <world name='default'>"
+    "    <model name='room'>"
+    "      <static>true</static>"
+    "      <link name='door_frame'>"
+    "        <pose>0 0 0 0 0 3.14159265</pose>"
+    "        <collision name='collision'>"
+    "          <geometry>"
+    "            <mesh>"
+    "              <uri>model://door/meshes/door_frame.obj</uri>"
+    "              <scale>0.01 0.01 0.01</scale>"
+    "            </mesh>"
+    "          </geometry>"
+    "        </collision>"
+    "      </link>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+/////////////////////////////////////////////////
+/// \brief Rasterize a world's footprints within the OccupancyMapPlugin's
+/// default height band, on a grid centered on the origin.
+/// \param[in] _world The <world> element.
+/// \param[in] _resolution Cell size.
+/// \param[in] _size Number of cells along each side.
+/// \return The cells.
+std::vector<int8_t> Rasterize(const sdf::ElementPtr &_world,
+    const double _resolution, const unsigned int _size)
+{
+  OccupancyRasterizer rasterizer;
+  for (const auto &footprint : staticFootprints(_world, ""))
+  {
+    if (footprint.zMax < 0.1 || footprint.zMin > 1.5)
+      continue;
+    rasterizer.AddPolygon(footprint.corners);
+  }
+
+  auto half = _resolution * _size * 0.5;
+  std::vector<int8_t> cells;
+  rasterizer.Rasterize(ignition::math::Vector2d(-half, -half), _resolution,
+      _size, _size, 1, cells);
+  return cells;
+}
+
+/////////////////////////////////////////////////
+TEST(StaticGeometryTest, DoorwayFree)
+{
+  gazebo::common::SystemPaths::Instance()->AddModelPaths(
+      SERVICESIM_MODELS_PATH);
+
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  ASSERT_TRUE(sdf::readString(kDoorWorld, sdfParsed));
+  auto world = sdfParsed->Root()->GetElement("world");
+
+  // Mesh triangles, not a single box
+  auto footprints = staticFootprints(world, "");
+  EXPECT_GT(footprints.size(), 1u);
+
+  const double resolution{0.05};
+  const unsigned int size{40};
+  auto cells = Rasterize(world, resolution, size);
+  ASSERT_EQ(size * size, cells.size());
+
+  auto cell = [&](const double _x, const double _y) -> int8_t
+  {
+    auto col = static_cast<unsigned int>(
+        std::floor(_x / resolution + size * 0.5));
+    auto row = static_cast<unsigned int>(
+        std::floor(_y / resolution + size * 0.5));
+    return cells[row * size + col];
+  };
+
+  // The doorway is free across its width, the posts on each side aren't
+  for (double x = -0.35; x <= 0.35; x += resolution)
+    EXPECT_EQ(OccupancyRasterizer::kFree, cell(x, -0.06)) << x;
+
+  EXPECT_EQ(OccupancyRasterizer::kOccupied, cell(-0.49, -0.06));
+  EXPECT_EQ(OccupancyRasterizer::kOccupied, cell(0.49, -0.06));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2018 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+#include <ignition/math/Pose3.hh>
+#include <servicesim_competition/DropOffGuest.h>
+#include <servicesim_competition/SeekCheckpoint.h>
+#include <servicesim_competition/TaskInfo.h>
+
+namespace servicesim_test
+{
+  class ServicesimSeekTest
+  {
+    public:
+
+      /// \brief Method to seek to a checkpoint and return the status
+      bool seek(uint8_t checkpoint, bool place_robot,
+                const ignition::math::Pose3d &robot_pose, bool place_guest,
+                const ignition::math::Pose3d &guest_pose);
+
+      /// \brief Method to drop_off the guest and return the status
+      bool dropoff_guest();
+
+      /// \brief Creating a ROS NodeHandle
+      ros::NodeHandle n;
+
+      /// \brief Parameters for the task
+      std::string guest_name = "human_20843";
+      std::string robot_name = "servicebot";
+
+      /// \brief Robot start pose
+      ignition::math::Pose3d start_pose{11.67, 3.75, 0, 0, 0, 3.14};
+
+      /// \brief Robot pose in the drop-off location
+      ignition::math::Pose3d drop_off_pose{-20.5, 10.2, 0, 0, 0, 3.14};
+
+      /// \brief Guest pose in the drop-off location, close enough to the
+      /// robot to follow it
+      ignition::math::Pose3d drop_off_guest_pose{-19.6, 9.7, 1, 1.57, 0,
+                                                 -1.805};
+  };
+}
+
+using namespace servicesim_test;
+
+//////////////////////////////////////////////////
+// Test seeking straight to the drop-off checkpoint
+TEST(ServicesimSeekTest, drop_off_guest)
+{
+  // Creating the test object
+  servicesim_test::ServicesimSeekTest test_obj;
+
+  // There are only 4 checkpoints
+  EXPECT_FALSE(test_obj.seek(5, false, ignition::math::Pose3d::Zero,
+                             false, ignition::math::Pose3d::Zero));
+
+  // Jump to the drop-off with the guest following the robot, without going
+  // through the go to pick-up and pick-up checkpoints
+  EXPECT_TRUE(test_obj.seek(3, true, test_obj.drop_off_pose,
+                            true, test_obj.drop_off_guest_pose));
+
+  // The competition has been started by seeking
+  ros::ServiceClient task_info_client =
+      test_obj.n.serviceClient<servicesim_competition::TaskInfo>(
+      "servicesim/task_info");
+  servicesim_competition::TaskInfo task_info_srv;
+  EXPECT_TRUE(task_info_client.call(task_info_srv));
+  EXPECT_EQ(task_info_srv.response.guest_name, test_obj.guest_name);
+
+  // Give the competition time to see the guest in the drop-off area
+  ros::Duration(0.7).sleep();
+
+  // Start drop_off service
+  EXPECT_TRUE(test_obj.dropoff_guest());
+
+  // Completed checkpoints can't be undone
+  EXPECT_FALSE(test_obj.seek(2, false, ignition::math::Pose3d::Zero,
+                             false, ignition::math::Pose3d::Zero));
+}
+
+//////////////////////////////////////////////////
+// Test seeking to the last checkpoint
+TEST(ServicesimSeekTest, return_to_start)
+{
+  // Creating the test object
+  servicesim_test::ServicesimSeekTest test_obj;
+
+  // Jump to the last checkpoint with the robot back at the start
+  EXPECT_TRUE(test_obj.seek(4, true, test_obj.start_pose,
+                            false, ignition::math::Pose3d::Zero));
+}
+
+//////////////////////////////////////////////////
+bool ServicesimSeekTest::seek(uint8_t checkpoint, bool place_robot,
+    const ignition::math::Pose3d &robot_pose, bool place_guest,
+    const ignition::math::Pose3d &guest_pose)
+{
+  // Start seek_checkpoint service
+  ros::ServiceClient seek_client =
+      this->n.serviceClient<servicesim_competition::SeekCheckpoint>(
+      "servicesim/seek_checkpoint");
+  servicesim_competition::SeekCheckpoint seek_srv;
+
+  // Waiting for the service to be avaialable
+  EXPECT_TRUE(ros::service::waitForService("servicesim/seek_checkpoint",
+      100000));
+
+  // Updating the service with requests
+  seek_srv.request.checkpoint = checkpoint;
+  seek_srv.request.robot_name = this->robot_name;
+  seek_srv.request.place_robot = place_robot;
+  seek_srv.request.place_guest = place_guest;
+
+  seek_srv.request.robot_pose.position.x = robot_pose.Pos().X();
+  seek_srv.request.robot_pose.position.y = robot_pose.Pos().Y();
+  seek_srv.request.robot_pose.position.z = robot_pose.Pos().Z();
+  seek_srv.request.robot_pose.orientation.x = robot_pose.Rot().X();
+  seek_srv.request.robot_pose.orientation.y = robot_pose.Rot().Y();
+  seek_srv.request.robot_pose.orientation.z = robot_pose.Rot().Z();
+  seek_srv.request.robot_pose.orientation.w = robot_pose.Rot().W();
+
+  seek_srv.request.guest_pose.position.x = guest_pose.Pos().X();
+  seek_srv.request.guest_pose.position.y = guest_pose.Pos().Y();
+  seek_srv.request.guest_pose.position.z = guest_pose.Pos().Z();
+  seek_srv.request.guest_pose.orientation.x = guest_pose.Rot().X();
+  seek_srv.request.guest_pose.orientation.y = guest_pose.Rot().Y();
+  seek_srv.request.guest_pose.orientation.z = guest_pose.Rot().Z();
+  seek_srv.request.guest_pose.orientation.w = guest_pose.Rot().W();
+
+  // Call the seek service
+  EXPECT_TRUE(seek_client.call(seek_srv));
+
+  // Return the status of the seek
+  return seek_srv.response.success;
+}
+
+//////////////////////////////////////////////////
+bool ServicesimSeekTest::dropoff_guest()
+{
+  // Start dropoff_guest service
+  ros::ServiceClient dropoff_client =
+      this->n.serviceClient<servicesim_competition::DropOffGuest>(
+      "servicesim/dropoff_guest");
+  servicesim_competition::DropOffGuest dropoff_srv;
+
+  // Waiting for the service to be avaialable
+  EXPECT_TRUE(ros::service::waitForService("servicesim/dropoff_guest", 10000));
+
+  // Updating the service with requests
+  dropoff_srv.request.guest_name = this->guest_name;
+
+  // Call the dropoff service
+  EXPECT_TRUE(dropoff_client.call(dropoff_srv));
+
+  // Return the status of the drop off
+  return dropoff_srv.response.success;
+}
+
+//////////////////////////////////////////////////
+int main(int _argc, char **_argv)
+{
+  testing::InitGoogleTest(&_argc, _argv);
+
+  ros::init(_argc, _argv, "servicesim_seek-test");
+
+  ros::Time::init();
+
+  return RUN_ALL_TESTS();
+}